@@ -0,0 +1,93 @@
+#ifndef BATCHRUNNER_H
+#define BATCHRUNNER_H
+
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "CostModel.h"
+#include "KnowledgeBase.h"
+#include "LemmaLibrary.h"
+#include "ProofSolver.h"
+
+struct BatchOptions {
+    double slack = 4.0;             // budget = slack x predicted time, clamped below
+    unsigned minBudgetMs = 100;
+    unsigned maxBudgetMs = 10000;
+    double rejectOverMs = 60000.0;  // predicted longer than this: not run at all
+};
+
+enum class JobOutcome {
+    Proved,
+    NotProved,   // the search ran out of strategies
+    OverBudget,  // stopped at its budget, also on the retry
+    Rejected     // admission control turned it away
+};
+
+struct BatchJob {
+    size_t index;           // position in the input
+    std::string premises;
+    std::string conclusion;
+    ProblemFeatures features;
+    double predictedMs;
+    unsigned budgetMs;
+};
+
+struct BatchResult {
+    size_t index;
+    JobOutcome outcome;
+    double predictedMs;
+    double elapsedMs;
+    unsigned budgetMs;      // the last budget it ran under
+};
+
+// Runs many problems under the cost model. Jobs are admitted on their
+// predicted cost and run shortest-first, each under a time budget scaled
+// from its prediction, so a few expensive problems cannot hold up the cheap
+// ones. A job that exceeds its budget is queued again behind everything else
+// with the maximum budget; one predicted over rejectOverMs is not run.
+// Every finished solve is fed back to the model.
+class BatchRunner {
+
+public:
+
+    BatchRunner(CostModel& model, BatchOptions options = {});
+
+    // Every job is solved with these, as ProofSolver's methods of the same
+    // names set them up
+    void useLemmas(std::shared_ptr<const LemmaLibrary> library);
+    void useKnowledgeBase(std::shared_ptr<const KnowledgeBase> kb, size_t limit = ProofSolver::DefaultImportLimit);
+
+    // "premises |- conclusion" (or ⊢); false if either side does not parse
+    bool add(const std::string& line);
+    // One problem per line; blank lines and # comments are skipped.
+    // Returns the number of lines that failed to parse.
+    size_t addAll(std::istream& in);
+    // addAll over a memory-mapped ProblemCorpus (text or JSONL lines)
+    size_t addFile(const std::string& path);
+
+    // Admitted jobs in run order, and the indices of rejected ones
+    std::vector<BatchJob> schedule(std::vector<size_t>* rejected = nullptr) const;
+
+    // Runs the schedule; results are in completion order
+    std::vector<BatchResult> run(bool verbose = true);
+
+private:
+
+    void addJob(std::string premises, std::string conclusion, const std::vector<FormulaId>& parsed, FormulaId goal);
+
+    CostModel& model;
+    BatchOptions options;
+    std::shared_ptr<const LemmaLibrary> lemmas;
+    std::shared_ptr<const KnowledgeBase> knowledgeBase;
+    size_t knowledgeLimit = ProofSolver::DefaultImportLimit;
+    FormulaStore store; // problems share their subformulas while their features are read
+    std::vector<BatchJob> jobs;
+    size_t lines = 0;
+
+};
+
+const char* toString(JobOutcome outcome);
+
+#endif // BATCHRUNNER_H
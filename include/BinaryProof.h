@@ -0,0 +1,97 @@
+#ifndef BINARYPROOF_H
+#define BINARYPROOF_H
+
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Formula.h"
+#include "ProofStore.h"
+
+// Writes a proof found modulo AC out in Carnap's binary steps, as
+// CarnapRules.h states them. The solver matches ^/v as flat operand sets, so
+// one of its lines may split or join several operands at once, in any
+// grouping, and may cite a line whose grouping differs from the one its rule
+// names. Here every line gets a layout: premises and Show lines keep the tree
+// they were given in, and other lines reuse subtrees of the lines they cite
+// or of earlier lines. Then
+//   S     walks down the cited conjunction one binary S at a time;
+//   ADJ   joins the two cited lines;
+//   MTP   drops a disjunct that is a child of the cited disjunction, and
+//         otherwise proves the result by ID: each remaining disjunct is
+//         refuted by ADD up to the negated result, then the disjunction is
+//         taken apart by binary MTP steps;
+//   DNE, DNI and the D- equivalences rewrite one subformula per line;
+// and any other rule cites its lines regrouped to one instance of its
+// schema. A line is regrouped by conform(), which proves the same formula in
+// the wanted layout: ^ by S and ADJ, v, ~ and -> by short ID and CD
+// subproofs.
+class BinaryProofWriter {
+
+public:
+
+    explicit BinaryProofWriter(FormulaStore& formulas) : formulas(formulas) {}
+
+    ProofStore write(const ProofStore& proof);
+
+private:
+
+    int emit(LayoutId layout, const std::string& rule, std::vector<int> refs, int indent);
+    int open(LayoutId show, int indent); // a Show line
+    void close();                        // the innermost subproof, before its QED or result line
+    LayoutId layoutOf(int line) const { return out.layout(static_cast<size_t>(line - 1)); }
+    FormulaId formulaOf(LayoutId layout) const { return formulas.layout(layout).formula; }
+    LayoutId negation(LayoutId layout);
+
+    // Visible lines laid out as l, or holding f in any layout
+    std::optional<int> lineWith(LayoutId l) const;
+    std::optional<int> lineHolding(FormulaId f) const;
+
+    // f laid out from subtrees of pieces, then of the open Show lines, then
+    // of the lines written so far
+    LayoutId compose(FormulaId f, std::vector<LayoutId> pieces);
+    LayoutId build(FormulaId f, const std::vector<LayoutId>& pieces);
+    LayoutId findSubtree(LayoutId root, FormulaId f) const;
+    LayoutId assumed(FormulaId f);      // an AS line's layout under the innermost Show line
+    LayoutId wanted(FormulaId f) const; // the layout a line closing the innermost subproof needs
+
+    int step(FormulaId f, const std::string& rule, const std::vector<int>& refs, int indent);
+    int simplify(int line, FormulaId f, int indent);
+    int adjoin(const std::vector<int>& refs, FormulaId f, int indent);
+    int eliminate(const std::vector<int>& refs, FormulaId f, int indent);
+    int detach(const std::vector<int>& refs, FormulaId f, int indent);
+    std::optional<int> rewrite(int line, const std::string& rule, FormulaId f, int indent);
+    int instance(const std::string& rule, const std::vector<int>& refs, FormulaId f, int indent);
+    std::vector<int> closing(const std::string& rule, std::vector<int> refs);
+
+    // The formula on line, laid out as target
+    int conform(int line, LayoutId target, int indent);
+    // S steps down through ^ nodes of line's layout to target, or to a
+    // subtree holding f when target is NoLayout; a step already on a
+    // visible line is cited instead
+    std::optional<int> descend(int line, LayoutId target, FormulaId f, int indent, std::vector<int>& lines);
+    // A line laid out as target, from lines by S and ADJ
+    std::optional<int> assemble(LayoutId target, std::vector<int>& lines, int indent);
+
+    using Negations = std::unordered_map<FormulaId, int>; // formula -> line holding its negation
+    int disjunctionAs(int line, LayoutId target, Negations negations, int indent);
+    std::optional<int> refute(int disjunction, int negation, FormulaId dropped, FormulaId f, int indent);
+    int negationOf(LayoutId l, Negations& negations, int indent);
+    std::pair<int, int> takeApart(int disjunction, Negations& negations, int indent);
+
+    FormulaStore& formulas;
+    ProofStore out;
+    std::vector<int> shows;     // open Show lines of the proof being written
+    std::vector<int> visible;   // lines citable at the current point
+    std::vector<size_t> frames; // visible.size() when each open Show line was written
+
+    // Visible lines by layout and by formula, latest last, and the first
+    // layout each formula was written in
+    std::unordered_map<LayoutId, std::vector<int>> byLayout;
+    std::unordered_map<FormulaId, std::vector<int>> byFormula;
+    std::unordered_map<FormulaId, LayoutId> seen;
+
+};
+
+#endif // BINARYPROOF_H
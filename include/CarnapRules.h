@@ -0,0 +1,30 @@
+#ifndef CARNAPRULES_H
+#define CARNAPRULES_H
+
+#include <optional>
+#include <string>
+#include <vector>
+#include "Formula.h"
+
+// Carnap's sentential rules as binary schemata over layouts. The solver's
+// rules (Rules.h) match modulo AC; these match the trees as written, so one
+// step takes apart or builds exactly the nodes its schema names: (P^Q)^R
+// gives P^Q and R by S, but not P. Every schema atom (φ, ψ, χ) is a
+// metavariable.
+
+// Cited lines the rule takes, or nullopt when it is not one of these rules
+std::optional<size_t> carnapArity(const std::string& rule);
+
+// Whether result follows from the cited lines, in any order, by one instance
+// of rule. The equivalence rules (DNE, DNI, D-DMO, D-DMT, D-SDMO, D-SDMT,
+// D-NC) may instead rewrite a single subformula, and a D- equivalence may
+// restate an instance of its own biconditional.
+bool carnapStep(const FormulaStore& fs, const std::string& rule,
+                const std::vector<LayoutId>& cited, LayoutId result);
+
+// Appends each layout one rewrite by rule's equivalence away from `from`,
+// at any position
+void carnapRewrites(FormulaStore& fs, const std::string& rule, LayoutId from,
+                    std::vector<LayoutId>& out);
+
+#endif // CARNAPRULES_H
@@ -0,0 +1,62 @@
+#ifndef COSTMODEL_H
+#define COSTMODEL_H
+
+#include <array>
+#include <string>
+#include <vector>
+#include "Formula.h"
+
+// Static shape of a problem, read off its parsed formulas before any search
+struct ProblemFeatures {
+    int premises = 0;
+    int atoms = 0;            // distinct sentence letters and predicate symbols
+    int negations = 0;
+    int junctions = 0;        // ^ and v nodes
+    int implications = 0;
+    int biconditionals = 0;
+    int quantifiers = 0;
+    int implicationDepth = 0; // deepest -> nested inside another ->
+    bool threePremiseRules = false; // a disjunction and two conditionals, so D-PBC can match
+    bool conditionalGoal = false;
+};
+
+// Counts over every premise and the goal (subformulas counted once per occurrence)
+ProblemFeatures extractFeatures(const FormulaStore& store, const std::vector<FormulaId>& premises, FormulaId goal);
+
+// Predicts solve time from ProblemFeatures with a linear model of
+// log(1 + milliseconds). The built-in weights were fitted to sample solves;
+// observe() adds measured solves, and the weights are refitted by ridge
+// regression that pulls toward the built-in ones, so a few samples adjust
+// the model without overturning it. No weight goes negative: every feature
+// counts as work, so a problem never looks cheaper for having more of one.
+// Samples persist across runs like the rule statistics.
+class CostModel {
+
+public:
+
+    static constexpr size_t FeatureCount = 11;
+
+    CostModel();
+
+    double predictMs(const ProblemFeatures& features) const;
+    void observe(const ProblemFeatures& features, double ms);
+    size_t samples() const { return sampleCount; }
+
+    bool load(const std::string& path);
+    bool save(const std::string& path) const;
+
+private:
+
+    using Vector = std::array<double, FeatureCount>;
+
+    static Vector vectorize(const ProblemFeatures& features);
+    void refit();
+
+    Vector weights;
+    std::array<Vector, FeatureCount> gram{}; // sum of x x^T over samples
+    Vector moments{};                        // sum of x y over samples
+    size_t sampleCount = 0;
+
+};
+
+#endif // COSTMODEL_H
@@ -0,0 +1,119 @@
+#ifndef EGRAPH_H
+#define EGRAPH_H
+
+#include <cstdint>
+#include <vector>
+#include "Formula.h"
+
+// E-graph over formulas under double negation, De Morgan and the negated
+// conditional. Every formula added is split into e-nodes whose operands are
+// e-classes; saturation merges a class with each rewrite of its nodes, so one
+// class stands for all forms of a formula under the laws without writing any
+// of them out as formulas or proof lines. Rewrites only push negation inward
+// (plus re-flattening ^/v), which keeps the graph finite: two formulas share
+// a class exactly when they have the same negation normal form. Saturation is
+// incremental: only new nodes and the parents of classes that grew are
+// revisited, so adding one formula to a large graph stays cheap.
+//
+// Storage is flat, so the graph allocates only as its arrays grow: node
+// operands share one pool, the hashcons is an open-addressing table of node
+// indices, and a class's nodes, member formulas and parent nodes are linked
+// lists through shared arrays, which a merge splices in O(1).
+//
+// The graph only grows: formulas of lines a solver rolls back stay in it.
+// When it reaches NodeBudget it stops growing, and the owner rebuilds it
+// from the formulas still in use with clear() and add().
+class EGraph {
+
+public:
+
+    using ClassId = uint32_t;
+
+    // Adds f and its subformulas; returns f's class
+    ClassId add(const FormulaStore& store, FormulaId f);
+
+    // Applies the laws until no class changes or this call's step budget is spent
+    void saturate();
+
+    bool full() const { return nodes.size() >= NodeBudget; }
+    void clear();
+
+    ClassId find(ClassId c) const;
+
+    // Formulas added so far that are equivalent to f (f included); saturates
+    // first. Valid until the graph next changes or the next call.
+    const std::vector<FormulaId>& equivalents(const FormulaStore& store, FormulaId f);
+    bool equivalent(const FormulaStore& store, FormulaId a, FormulaId b);
+
+    size_t nodeCount() const { return nodes.size(); }
+
+private:
+
+    static constexpr uint32_t None = UINT32_MAX;
+
+    struct Node {
+        Connective op;
+        int symbol;        // the formula for atoms/predicates, the variable for quantifiers
+        uint32_t children; // offset in childPool
+        uint32_t arity;
+    };
+
+    // A singly linked list through one of the entry arrays below
+    struct List {
+        uint32_t head = None, tail = None;
+    };
+
+    size_t hash(Connective op, int symbol, const ClassId* children, size_t arity) const;
+    bool same(uint32_t node, Connective op, int symbol, const ClassId* children, size_t arity) const;
+    uint32_t lookup(Connective op, int symbol, const ClassId* children, size_t arity) const; // node or None
+    void insert(uint32_t node);
+    void erase(uint32_t node);
+    void rehash(size_t slots);
+
+    void canonicalize(ClassId* children, size_t arity, Connective op) const;
+    ClassId addNode(Connective op, int symbol, const ClassId* children, size_t arity);
+    ClassId negation(ClassId c);
+    bool merge(ClassId a, ClassId b);
+    void rebuild();
+    void rewrite(uint32_t node);
+    void classNodesOf(ClassId c, std::vector<uint32_t>& out) const;
+
+    static void append(List& list, std::vector<uint32_t>& next, uint32_t entry);
+    static void splice(List& into, List& from, std::vector<uint32_t>& next);
+
+    static constexpr size_t NodeBudget = 100000;
+    static constexpr size_t StepBudget = 20000; // node lookups per saturate()
+
+    std::vector<Node> nodes;
+    std::vector<ClassId> childPool;
+    std::vector<ClassId> nodeClass;   // node -> class it was created in
+    std::vector<ClassId> parent;      // union-find over classes
+
+    // Per root class: its nodes, the formulas added in it, and the nodes
+    // using it as an operand. Node lists link through nextNode (one entry per
+    // node); member and parent lists through entries of their own.
+    std::vector<List> classNodes, members, parents;
+    std::vector<uint32_t> classSize;  // nodes per root, for union by size
+    std::vector<uint32_t> nextNode;
+    std::vector<FormulaId> memberFormula;
+    std::vector<uint32_t> nextMember;
+    std::vector<uint32_t> parentNode;
+    std::vector<uint32_t> nextParent;
+
+    std::vector<uint32_t> table;      // hashcons: node indices, or Empty/Erased
+    size_t tableUsed = 0;             // slots not Empty
+    std::vector<uint32_t> spareTable; // the other table rehash() swaps in
+
+    std::vector<ClassId> formulaClass; // by formula id, None if not added
+    std::vector<uint32_t> pending;     // nodes to rewrite
+    std::vector<ClassId> repair;       // merged classes whose parents need re-canonicalizing
+    size_t work = 0;                   // node lookups in the current saturate()
+
+    // Reused so that a graph which stops growing stops allocating
+    std::vector<ClassId> key, operands, built;
+    std::vector<uint32_t> batch, users, nodesOf;
+    std::vector<FormulaId> found;
+
+};
+
+#endif // EGRAPH_H
@@ -0,0 +1,78 @@
+#ifndef ENTAILMENTORACLE_H
+#define ENTAILMENTORACLE_H
+
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+#include "Formula.h"
+
+// Propositional entailment decided on truth tables. A formula's table is a
+// bit vector over every assignment to the oracle's atoms, built once per
+// interned id from its operands' tables with word-wide AND, OR and NOT, so a
+// check costs a few passes over memoized words and no search.
+//
+// Atoms (sentence letters and ground predicates) are given variables as they
+// are met, up to the capacity set by reset(). A formula with a quantifier, or
+// with an atom beyond capacity, has no table, and no verdict is given on a
+// question involving it.
+class EntailmentOracle {
+
+public:
+
+    static constexpr size_t MaxAtoms = 14; // 256 words per table
+
+    // Forgets all tables; tables then cover atoms variables, at most MaxAtoms
+    void reset(size_t atoms);
+
+    // Whether the premises entail target, or nullopt if some formula has no table
+    std::optional<bool> entails(const FormulaStore& store, const std::vector<FormulaId>& premises, FormulaId target);
+
+    // The accessible lines as standing premises, kept in step as
+    // ImplicationIndex is: a line is added as it is written, and closing a
+    // scope or rolling back truncates them. Their conjunction is folded in
+    // as entailed() asks for it and saved where each scope opens, so
+    // truncating into a scope refolds only the lines written in it. reset()
+    // keeps the premises and refolds them.
+    void addPremise(FormulaId premise);
+    void openScope(); // the premises added next are in a new scope
+    void truncatePremises(size_t count); // forgets the premises at or past position count
+    size_t premiseCount() const { return premises.size(); }
+
+    // Whether the standing premises entail target, or nullopt if some formula has no table
+    std::optional<bool> entailed(const FormulaStore& store, FormulaId target);
+
+    // Distinct atoms occurring in the formulas
+    static size_t countAtoms(const FormulaStore& store, const std::vector<FormulaId>& formulas);
+
+private:
+
+    static constexpr int NoTable = -1;
+
+    // Offset of f's table in words, or NoTable
+    int table(const FormulaStore& store, FormulaId f);
+    int variable(); // a new atom's table, or NoTable past capacity
+    int allocate();
+    void fold(const FormulaStore& store); // the standing premises not yet in conjunction
+    void saveScope();                     // conjunction as the next unsaved scope opens
+    void restoreScope();                  // conjunction as the innermost saved scope opened
+    bool entailedBy(const uint64_t* premises, int goal) const;
+
+    size_t variables = 6;
+    size_t width = 1;                          // words per table
+    std::vector<uint64_t> words;               // all tables, width words each
+    std::unordered_map<FormulaId, int> offsetOf; // memo, NoTable included
+    size_t assigned = 0;                       // atoms given a variable
+    std::vector<uint64_t> scratch;             // conjunction of the premises
+
+    std::vector<FormulaId> premises;  // standing premises
+    std::vector<size_t> scopeStarts;  // premises.size() as each scope opened
+    std::vector<uint64_t> saved;      // conjunction as each of the first savedScopes opened, width words each
+    size_t savedScopes = 0;
+    std::vector<uint64_t> conjunction; // of the first folded premises
+    size_t folded = 0;
+    size_t untabled = SIZE_MAX;        // first folded premise with no table
+
+};
+
+#endif // ENTAILMENTORACLE_H
@@ -0,0 +1,175 @@
+#ifndef FORMULA_H
+#define FORMULA_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <optional>
+#include <unordered_map>
+#include "Term.h"
+
+// Interned formula handle; -1 means "no formula" (Show:/QED lines)
+using FormulaId = int;
+constexpr FormulaId NoFormula = -1;
+
+enum class Connective {
+    Atom,
+    Not,
+    And,      // n-ary, flattened, operands sorted by id
+    Or,       // n-ary, flattened, operands sorted by id
+    Implies,
+    Iff,
+    Predicate, // F(t1, ..., tn)
+    ForAll,    // ∀x φ
+    Exists     // ∃x φ
+};
+
+// Binary layout of a formula, the tree as written: a ^/v node has exactly two
+// operands, kept in order. Proof lines render through their layout, so a
+// premise prints the way it was given, while the formula id stays AC-normal
+// for matching and deduplication.
+using LayoutId = int;
+constexpr LayoutId NoLayout = -1;
+
+struct Layout {
+    FormulaId formula;
+    std::vector<LayoutId> operands; // none for atoms and predicates
+};
+
+// A set of connectives, one bit each, e.g. those heading accessible lines
+using ShapeMask = uint32_t;
+constexpr ShapeMask AnyShape = ~ShapeMask{0};
+constexpr ShapeMask shapeBit(Connective op) { return ShapeMask{1} << static_cast<int>(op); }
+
+struct Formula {
+    Connective op;
+    std::vector<FormulaId> operands;
+    std::string name;          // atoms and predicates
+    std::vector<TermId> terms; // predicate arguments, or a quantifier's variable
+};
+
+// Hash-consed store of formulas. Conjunction and disjunction are kept in
+// associativity/commutativity-normal form, so P^Q, Q^P, (P^Q)^R and P^(Q^R)
+// intern to the same id as their AC-equivalents and equality is an int compare.
+// First-order formulas use predicates over terms from the store's TermStore;
+// a term name is a variable where a quantifier binds it and a constant elsewhere.
+//
+// Constructing a formula that already exists does not allocate: the lookup
+// hashes the node's fields in place and ^/v operands are gathered in reused
+// buffers. Only a new node allocates (its operand list), so rules can probe
+// freely in the solver's inner loop.
+class FormulaStore {
+
+public:
+
+    FormulaId atom(std::string_view name);
+    FormulaId negate(FormulaId f);
+    FormulaId conjoin(const std::vector<FormulaId>& operands);
+    FormulaId disjoin(const std::vector<FormulaId>& operands);
+    FormulaId conjoin(FormulaId a, FormulaId b);
+    FormulaId disjoin(FormulaId a, FormulaId b);
+    FormulaId implies(FormulaId antecedent, FormulaId consequent);
+    FormulaId iff(FormulaId lhs, FormulaId rhs);
+    FormulaId predicate(std::string_view name, std::vector<TermId> args);
+    FormulaId forAll(TermId var, FormulaId body);
+    FormulaId exists(TermId var, FormulaId body);
+
+    std::optional<FormulaId> parse(std::string_view text);
+
+    // Carnap-style binary rendering; n-ary ^/v print right-nested
+    std::string render(FormulaId f) const;
+
+    // Layouts are interned like formulas. defaultLayout(f) nests n-ary ^/v
+    // to the right, as render(f) prints them; arrange() puts f's connective
+    // over the given operand layouts, and join() builds a binary ^, v, -> or
+    // <-> node.
+    std::optional<LayoutId> parseLayout(std::string_view text);
+    LayoutId defaultLayout(FormulaId f);
+    LayoutId arrange(FormulaId f, const std::vector<LayoutId>& operands);
+    LayoutId join(Connective op, LayoutId lhs, LayoutId rhs);
+    const Layout& layout(LayoutId l) const { return layouts[l]; }
+    std::string renderLayout(LayoutId l) const;
+
+    const Formula& get(FormulaId f) const { return nodes[f]; }
+    bool is(FormulaId f, Connective op) const { return f >= 0 && nodes[f].op == op; }
+    size_t size() const { return nodes.size(); }
+
+    // Operands of an ^/v node, or {f} itself for anything else
+    std::vector<FormulaId> flatten(FormulaId f, Connective op) const;
+
+    // f with operand i dropped (^/v only) or replaced by r
+    FormulaId withoutOperand(FormulaId f, size_t i);
+    FormulaId withOperand(FormulaId f, size_t i, FormulaId r);
+
+    // The op node over the negations of f's operands
+    FormulaId negatedOperands(Connective op, FormulaId f);
+
+    // Room for n formulas without rehashing or growing the node table
+    void reserve(size_t n);
+
+    // While a Probe is alive the constructors only look formulas up, and
+    // return NoFormula for one not in the store, so a matcher can test a
+    // candidate without adding it
+    class Probe {
+    public:
+        explicit Probe(FormulaStore& store) : store(store), was(store.probing) { store.probing = true; }
+        ~Probe() { store.probing = was; }
+        Probe(const Probe&) = delete;
+        Probe& operator=(const Probe&) = delete;
+    private:
+        FormulaStore& store;
+        bool was;
+    };
+
+    TermStore& termStore() { return terms; }
+    const TermStore& termStore() const { return terms; }
+
+    // f with the free occurrences of var replaced by term
+    FormulaId substitute(FormulaId f, TermId var, TermId term);
+
+    // Appends the predicate atoms, and the ground terms, occurring in f
+    void collectPredicates(FormulaId f, std::vector<FormulaId>& out) const;
+    void collectGroundTerms(FormulaId f, std::vector<TermId>& out) const;
+
+    // Term t such that body[t/var] == f, or NoTerm when var is not free in
+    // body and body == f; nullopt if f is not an instance
+    std::optional<TermId> instanceTerm(FormulaId body, TermId var, FormulaId f);
+
+private:
+
+    // A node's fields without owning them, for lookups
+    struct Key {
+        Connective op;
+        const FormulaId* operands;
+        size_t operandCount;
+        std::string_view name;
+        const TermId* terms;
+        size_t termCount;
+    };
+
+    static size_t hash(const Key& key);
+    static Key keyOf(const Formula& node);
+    bool matches(FormulaId f, const Key& key) const;
+    FormulaId intern(const Key& key);
+    void rehash(size_t slots);
+    FormulaId makeAC(Connective op); // over the operands in gathered
+    std::string renderOperand(FormulaId f) const;
+    std::string renderLayoutOperand(LayoutId l) const;
+
+    struct LayoutKeyHash {
+        size_t operator()(const std::vector<int>& key) const;
+    };
+
+    std::vector<Formula> nodes;
+    std::vector<FormulaId> table;  // open addressing by hash, NoFormula marks a free slot
+    std::vector<FormulaId> gathered; // ^/v operands being assembled
+    std::vector<FormulaId> flat;     // gathered, flattened and sorted
+    bool probing = false;
+    TermStore terms;
+    std::vector<Layout> layouts;
+    std::unordered_map<std::vector<int>, LayoutId, LayoutKeyHash> layoutIndex; // {formula, operands...}
+
+};
+
+#endif // FORMULA_H
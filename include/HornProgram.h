@@ -0,0 +1,58 @@
+#ifndef HORNPROGRAM_H
+#define HORNPROGRAM_H
+
+#include <optional>
+#include <unordered_map>
+#include <vector>
+#include "Formula.h"
+
+// Definite Horn clauses over interned atoms (sentence letters and ground
+// predicates), decided by Dowling-Gallier forward propagation: each clause
+// counts its body atoms not yet known and fires when the count reaches
+// zero, so deciding a goal is linear in the size of the clauses.
+//
+// A premise is Horn when it is an atom, a conjunction of atoms (a clause
+// with an empty body), or an implication between those.
+class HornProgram {
+
+public:
+
+    struct Clause {
+        size_t line;                 // proof line of the premise
+        FormulaId antecedent;        // NoFormula for a fact
+        FormulaId consequent;        // the fact itself, or the implication's consequent
+        std::vector<int> body;       // distinct atom indices
+        std::vector<int> heads;
+    };
+
+    // One clause the proof uses, with the atoms it must yield, in order
+    struct Step {
+        size_t clause;
+        std::vector<FormulaId> atoms;
+    };
+
+    // An atom, or a conjunction of distinct atoms (ADJ never joins a formula with itself)
+    static bool conjunctionOfAtoms(const FormulaStore& store, FormulaId f);
+
+    // false, leaving the program unchanged, if premise is not Horn
+    bool add(const FormulaStore& store, FormulaId premise, size_t line);
+
+    // The steps deriving every conjunct of goal, in an order where each
+    // step's body atoms come from earlier steps; nullopt if goal does not follow
+    std::optional<std::vector<Step>> derive(const FormulaStore& store, FormulaId goal) const;
+
+    const Clause& clause(size_t i) const { return clauses[i]; }
+    size_t size() const { return clauses.size(); }
+
+private:
+
+    int atomIndex(FormulaId atom);
+
+    std::vector<Clause> clauses;
+    std::vector<FormulaId> atoms;                // index -> formula
+    std::vector<std::vector<size_t>> watchers;   // atom index -> clauses with it in their body
+    std::unordered_map<FormulaId, int> indexOf;  // formula -> index
+
+};
+
+#endif // HORNPROGRAM_H
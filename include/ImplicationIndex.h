@@ -0,0 +1,50 @@
+#ifndef IMPLICATIONINDEX_H
+#define IMPLICATIONINDEX_H
+
+#include <cstddef>
+#include <vector>
+#include "Formula.h"
+
+// The accessible lines by position, with the antecedent and consequent ids
+// of the implications among them in contiguous arrays, so MP and MT match
+// one fact against every implication (or one implication against every
+// fact) in a single sweep instead of one premise pair at a time. The sweeps
+// compare four ids per SSE2 instruction where it is available.
+//
+// The solver keeps it in step with the accessible lines: a line is added as
+// it is written, and closing a scope or rolling back truncates it.
+class ImplicationIndex {
+
+public:
+
+    void clear();
+    void add(const FormulaStore& fs, FormulaId line);
+    void truncate(size_t lines); // forgets the lines at or past position lines
+
+    size_t lines() const { return facts.size(); }
+    FormulaId fact(size_t position) const { return facts[position]; }
+
+    size_t size() const { return positions.size(); }
+    int position(size_t i) const { return positions[i]; }
+    FormulaId antecedent(size_t i) const { return antecedents[i]; }
+    FormulaId consequent(size_t i) const { return consequents[i]; }
+    size_t firstAt(size_t position) const; // the first implication at or past position
+
+    // Append the indices of the implications whose antecedent (consequent) is f
+    void withAntecedent(FormulaId f, std::vector<size_t>& hits) const { sweep(antecedents.data(), size(), f, hits); }
+    void withConsequent(FormulaId f, std::vector<size_t>& hits) const { sweep(consequents.data(), size(), f, hits); }
+    // Append the positions before count of the lines holding f
+    void withFact(FormulaId f, size_t count, std::vector<size_t>& hits) const { sweep(facts.data(), count, f, hits); }
+
+private:
+
+    static void sweep(const FormulaId* ids, size_t n, FormulaId f, std::vector<size_t>& hits);
+
+    std::vector<FormulaId> facts;
+    std::vector<int> positions;
+    std::vector<FormulaId> antecedents;
+    std::vector<FormulaId> consequents;
+
+};
+
+#endif // IMPLICATIONINDEX_H
@@ -0,0 +1,77 @@
+#ifndef KNOWLEDGEBASE_H
+#define KNOWLEDGEBASE_H
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Formula.h"
+#include "MappedFile.h"
+
+// Read-only premise set compiled by compile() and opened via mmap. The file
+// holds the parsed formula and term tables, the premise list, and a sorted
+// symbol table with each atom or predicate symbol's premise postings. Opening
+// only validates the header, and a query imports just the premises reachable
+// from its own symbols, so cold-start cost does not grow with the number of
+// premises. An opened knowledge base is immutable and can be shared between
+// threads.
+//
+// Source format: one premise per line, '#' starts a comment line.
+class KnowledgeBase {
+
+public:
+
+    static std::shared_ptr<const KnowledgeBase> open(const std::string& path);
+
+    // Parses every premise and writes the indexed binary file
+    static bool compile(const std::string& sourcePath, const std::string& outPath);
+
+    size_t size() const { return premiseCount; }
+
+    // Premises sharing symbols with the seeds, nearest first: those with a
+    // seed symbol, then those with a symbol of an earlier pick, and so on.
+    // Within each of these tiers, premises with a symbol no other premise
+    // or seed has come last, as they cannot chain towards the query.
+    std::vector<uint32_t> relevant(const std::vector<std::string>& seeds, size_t limit) const;
+
+    // Interns premise index into store and returns its id there, or
+    // NoFormula if its records are malformed
+    FormulaId import(uint32_t index, FormulaStore& store) const;
+
+    // Atom names and predicate name/arity symbols occurring in f
+    static void symbolsOf(const FormulaStore& store, FormulaId f, std::vector<std::string>& out);
+
+private:
+
+    explicit KnowledgeBase(const std::string& path) : file(path) {}
+
+    struct FormulaRecord;
+    struct TermRecord;
+    struct PremiseRecord;
+    struct SymbolRecord;
+
+    template <typename Record> Record record(uint32_t offset, uint32_t index) const;
+    uint32_t pooled(uint32_t index) const;
+    bool inPool(uint32_t first, uint32_t count) const;
+    std::string_view text(uint32_t offset, uint32_t length) const;
+    std::optional<uint32_t> findSymbol(std::string_view name) const;
+    FormulaId importFormula(uint32_t id, FormulaStore& store) const;
+    TermId importTerm(uint32_t id, FormulaStore& store) const;
+
+    MappedFile file;
+    uint32_t formulaCount = 0;
+    uint32_t formulasOffset = 0;
+    uint32_t termCount = 0;
+    uint32_t termsOffset = 0;
+    uint32_t premiseCount = 0;
+    uint32_t premisesOffset = 0;
+    uint32_t symbolCount = 0;
+    uint32_t symbolsOffset = 0;
+    uint32_t poolOffset = 0;
+    uint32_t poolCount = 0;
+
+};
+
+#endif // KNOWLEDGEBASE_H
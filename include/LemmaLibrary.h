@@ -0,0 +1,82 @@
+#ifndef LEMMALIBRARY_H
+#define LEMMALIBRARY_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Formula.h"
+#include "MappedFile.h"
+
+// A proven schematic theorem. Every atom of the schema is a metavariable.
+struct Lemma {
+    std::string name;
+    FormulaStore schema;
+    std::vector<FormulaId> premises;
+    FormulaId conclusion = NoFormula;
+};
+
+// Schema atom -> formula it stands for
+using Bindings = std::unordered_map<FormulaId, FormulaId>;
+
+// Calls onMatch with bindings extended by each way pattern (in schema)
+// matches f (in store), until it returns true. Bindings then hold the
+// accepted match; otherwise they are left unchanged. ^/v match modulo AC,
+// and each operand of a schema ^/v may take several of f's: φ^ψ matches
+// A^B^C with ψ standing for B^C, whose formula is added to store.
+bool forEachMatch(const FormulaStore& schema, FormulaId pattern, FormulaStore& store, FormulaId f,
+                  Bindings& bindings, const std::function<bool(const Bindings&)>& onMatch);
+
+// Read-only library of lemmas compiled by compile() and opened via mmap.
+// Opening only validates the header, so startup cost does not depend on the
+// number of lemmas; a lemma's text is parsed only when lemma() is called.
+// An opened library is immutable and can be shared between threads.
+//
+// Source format (one block per lemma, '#' starts a comment line):
+//   lemma NAME
+//   premises: φ->ψ, ψ->χ
+//   conclusion: φ->χ
+//   proof:
+//   1. Show: φ->χ
+//   ...            (displayProof format, checked by ProofChecker)
+//   end
+class LemmaLibrary {
+
+public:
+
+    static std::shared_ptr<const LemmaLibrary> open(const std::string& path);
+
+    // Checks every stored proof and writes the indexed binary library
+    static bool compile(const std::string& sourcePath, const std::string& outPath);
+
+    size_t size() const { return count; }
+
+    // Entry range [first, last) whose conclusion has the given main connective
+    std::pair<uint32_t, uint32_t> byConclusion(Connective op) const;
+    std::optional<uint32_t> find(std::string_view name) const;
+
+    std::string_view name(uint32_t index) const;
+    std::string_view proofText(uint32_t index) const;
+    std::optional<Lemma> lemma(uint32_t index) const;
+
+private:
+
+    explicit LemmaLibrary(const std::string& path) : file(path) {}
+
+    struct Entry;
+    Entry entry(uint32_t index) const;
+    std::string_view text(uint32_t offset, uint32_t length) const;
+
+    MappedFile file;
+    uint32_t count = 0;
+    uint32_t entriesOffset = 0;
+    uint32_t byNameOffset = 0;
+
+};
+
+#endif // LEMMALIBRARY_H
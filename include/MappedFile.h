@@ -0,0 +1,34 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <string>
+#include <vector>
+
+// Read-only view of a whole file. Uses mmap where available so opening is
+// O(1) in file size and the pages are shared between threads and processes;
+// elsewhere the file is read into memory once.
+class MappedFile {
+
+public:
+
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool valid() const { return ok; }
+    const char* data() const { return bytes; }
+    size_t size() const { return length; }
+
+private:
+
+    const char* bytes = nullptr;
+    size_t length = 0;
+    bool ok = false;
+    bool mapped = false;
+    std::vector<char> buffer; // fallback when mmap is unavailable
+
+};
+
+#endif // MAPPEDFILE_H
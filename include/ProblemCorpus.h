@@ -0,0 +1,55 @@
+#ifndef PROBLEMCORPUS_H
+#define PROBLEMCORPUS_H
+
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Formula.h"
+#include "MappedFile.h"
+
+// One problem of a corpus. The views point into the mapped file (or, for a
+// JSON string with escapes, into a decoded copy) and stay valid only for the
+// duration of the visit.
+struct CorpusRecord {
+    size_t line;                             // 1-based
+    std::vector<std::string_view> premises;
+    std::string_view conclusion;
+};
+
+// A file of problems, one per line, read in place from a memory mapping:
+//
+//   P->Q, Q->R |- P->R                 (also ⊢ or ; between the sides)
+//   {"premises": ["P->Q", "Q->R"], "conclusion": "P->R"}
+//
+// JSON premises may also be one comma-separated string. Blank lines and #
+// comments are skipped. Line and premise boundaries are found with a
+// vectorized byte scan, and records are split into views without copying.
+class ProblemCorpus {
+
+public:
+
+    explicit ProblemCorpus(const std::string& path);
+
+    bool valid() const { return file.valid(); }
+    size_t bytes() const { return file.size(); }
+    // Physical lines, blank, comment and malformed ones included
+    size_t lineCount() const;
+
+    // Visits every well-formed record in file order. Returns the number of
+    // malformed lines, each reported on cerr.
+    size_t forEach(const std::function<void(const CorpusRecord&)>& visit) const;
+
+    // forEach, parsing each record into store straight from the mapped text;
+    // a record with a formula that does not parse counts as malformed
+    size_t parseAll(FormulaStore& store,
+                    const std::function<void(const CorpusRecord&, const std::vector<FormulaId>&, FormulaId)>& visit) const;
+
+private:
+
+    std::string path;
+    MappedFile file;
+
+};
+
+#endif // PROBLEMCORPUS_H
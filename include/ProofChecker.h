@@ -0,0 +1,57 @@
+#ifndef PROOFCHECKER_H
+#define PROOFCHECKER_H
+
+#include <string>
+#include <vector>
+#include <istream>
+#include <unordered_map>
+#include "Formula.h"
+#include "ProofStore.h"
+#include "ProofSolver.h"
+#include "LemmaLibrary.h"
+
+struct CheckResult {
+    bool valid = true;
+    int line = 0;        // first offending line number, 0 if none
+    std::string message;
+};
+
+// Independent linear-time proof checker. Works from the printed expression
+// text of each Statement, so it can verify cached proofs and proofs produced
+// by other tools without trusting the solver that made them. Lines are
+// compared as written: each rule is one instance of its binary Carnap schema
+// (CarnapRules.h), not the solver's AC-normal rules.
+//
+// Structure accepted (Carnap-style, indentation-scoped):
+//   Show: φ        opens a subproof at its own indent (line 1 at indent 0)
+//   ψ :AS          only directly after a Show line
+//   ψ :RULE refs   refs must be earlier lines in open subproofs; RULE may
+//                  name a library lemma, with refs in premise order; the
+//                  equivalence rules may also replace one subformula
+//   :DD|CD|ID refs  (no expression) closes the innermost subproof
+//   χ :CD|ID refs   one level out closes the innermost subproof and states χ
+class ProofChecker {
+
+public:
+
+    explicit ProofChecker(const LemmaLibrary* lemmas = nullptr);
+
+    // Premises are optional; when given, every PR line must be one of them
+    CheckResult check(const std::vector<Statement>& lines,
+                      const std::vector<std::string>& premises = {},
+                      const std::string& conclusion = "");
+
+    // Reads the plain (non --pretty) displayProof() format
+    static std::vector<Statement> parseProofText(std::istream& in);
+
+private:
+
+    const Lemma* findLemma(const std::string& name);
+
+    const LemmaLibrary* lemmas;
+    std::unordered_map<std::string, std::optional<Lemma>> lemmaCache;
+    FormulaStore formulas;
+
+};
+
+#endif // PROOFCHECKER_H
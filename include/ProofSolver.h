@@ -3,25 +3,56 @@
 
 #include <string>
 #include <vector>
+#include <deque>
 #include <functional>
 #include <optional>
 #include <unordered_set>
 #include <unordered_map>
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include "Formula.h"
+#include "ProofStore.h"
+#include "RuleScheduler.h"
+#include "LemmaLibrary.h"
+#include "KnowledgeBase.h"
+#include "TermIndex.h"
+#include "EGraph.h"
+#include "ImplicationIndex.h"
+#include "EntailmentOracle.h"
+#include "ScopedFormulaSet.h"
+#include "ScopeTree.h"
 
-// Represents a single proof line
-struct Statement {
-    int lineNumber;
-    std::string expression;
-    std::string justification;
-    std::vector<int> references;
-    int indentLevel = 0;  // 0 = top-level, increases for subproofs
-};
+// Conclusions of one rule application. Callers keep one and clear it between
+// applications, so emitting allocates nothing once its capacity has grown.
+using Conclusions = std::vector<FormulaId>;
 
-// Represents a logical inference rule
+// Represents a logical inference rule. apply appends every conclusion of the
+// premise tuple (all orientations, all sides) to the sink.
+//
+// The signature lets the solver skip work that cannot match: a rule needs a
+// line headed by each connective in needs, takes as premises only lines
+// headed by one in accepts, and its conclusions are headed by one in yields.
+// Eliminations may expose any subformula, so they yield AnyShape.
+//
+// A rule with a kernel is matched by the solver's sweep over the
+// ImplicationIndex in place of pair enumeration; apply still defines it.
 struct Rule {
+    static constexpr int MaxPremises = 3; // D-PBC
+
+    enum class Kernel {
+        None,
+        ModusPonens,  // fact a, line a->b
+        ModusTollens  // fact ~b, line a->b
+    };
+
     std::string name;
     int numPremises;
-    std::function<std::optional<std::string>(const std::vector<std::string>&)> apply;
+    std::function<void(FormulaStore&, const std::vector<FormulaId>&, Conclusions&)> apply;
+    ShapeMask needs = 0;
+    ShapeMask accepts = AnyShape;
+    ShapeMask yields = AnyShape;
+    Kernel kernel = Kernel::None;
 };
 
 class ProofSolver {
@@ -33,26 +64,275 @@ public:
     void solve(); // Solver logic (forward chaining)
 
     void displayProof() const;
+    void writeProof(std::ostream& out) const; // displayProof() format
+    bool checkProof() const; // re-verifies the proof with an independent ProofChecker
     void enableBeautify(bool enable);
+    void enableParallelSubproofs(bool enable); // race subproof strategies on threads
+    void enableDiagnostics(bool enable);       // [DEBUG]/[INFO] progress output, on by default
+    // Races whole-proof strategy configurations on up to one thread per core.
+    // Configurations beyond the cores queue and start as earlier ones fail, so
+    // on one core they run in turn until one derives the conclusion.
+    void enablePortfolio(bool enable);
+
+    // Portfolio configuration whose proof was kept by the last solve(), "" outside portfolio mode
+    const std::string& winningStrategy() const { return winner; }
+
+    bool wasConclusionDerived() const;
+    std::vector<Statement> getProofLines() const;
+
+    // Work done by the last solve(), for profiling and the fuzzing harness
+    struct SolveStats {
+        size_t combinations = 0; // premise tuples a rule was applied to
+        size_t rounds = 0;       // rule rounds, at any depth
+        int maxCdDepth = 0;
+        size_t rulesSkipped = 0; // rule runs pruned by their signature
+        size_t targetsPruned = 0; // goals and subproofs the entailment oracle ruled out
+        bool aborted = false;    // gave up at the iteration, line or CD-depth cap
+        bool lineCapped = false; // an attempt stopped at the line cap
+
+        void merge(const SolveStats& other); // adds other's work, as a fork's
+    };
+    const SolveStats& solveStats() const { return stats; }
+
+    // Persisted per-rule hit statistics, used as the scheduler's prior
+    bool loadRuleStats(const std::string& path);
+    bool saveRuleStats(const std::string& path) const;
+
+    // Lemmas are applied as single cited steps; the library may be shared
+    void useLemmas(std::shared_ptr<const LemmaLibrary> library);
+
+    // solve() adds the knowledge-base premises relevant to the problem as PR
+    // lines, most relevant first and at most limit of them, and keeps those
+    // the proof cites. Imports never take more than half the line limit, so
+    // a large closure cannot use up the search's budget. When the import is
+    // cut short, a goal the imported premises miss is left open, never
+    // reported as not following. The knowledge base may be shared.
+    static constexpr size_t DefaultImportLimit = 256;
+    static constexpr size_t NoImportLimit = SIZE_MAX;
+    void useKnowledgeBase(std::shared_ptr<const KnowledgeBase> kb, size_t limit = DefaultImportLimit);
+
+    // Called with each proof line as it is appended (see SolveStream)
+    void setLineObserver(std::function<void(const Statement&)> observer);
+    // Called with the first line number withdrawn when lines reported to the
+    // line observer are taken back: a failed attempt is rolled back, or
+    // solve() restates the finished proof after dropping uncited imports and
+    // writing it out in binary steps. The lines reported next replace them.
+    void setRetractObserver(std::function<void(int from)> observer);
+    // Called as each rule round starts (false) and ends (true) with the
+    // proof's line count then, for profiling
+    void setRoundObserver(std::function<void(bool ended, size_t lines)> observer);
+    // Attempts that would take the proof past this many lines are abandoned,
+    // as they are past the built-in cap, which stays the most allowed
+    void setLineLimit(size_t lines);
+    // solve() winds down soon after *flag becomes true
+    void setStopFlag(const std::atomic<bool>* flag);
     void setInput(const std::string& premisesStr, const std::string& conclusionStr);
 
 private:
 
-    void startSubproof(const std::string& formula); // inserts Show: and AS
+    // inserts Show: formula and the assumption line (formula itself unless given)
+    void startSubproof(FormulaId formula, FormulaId assumption = NoFormula);
+    void startShow(FormulaId formula); // Show line only, for UD
+    // Also records the line in derived; layout is the tree given for a premise or the goal
+    int appendLine(FormulaId formula, RuleId rule, const std::vector<int>& refs, int indent,
+                   LayoutId layout = NoLayout);
     void endSubproof(const std::string& rule, const std::vector<int>& refs); // inserts QED
+    void closeSubproof(FormulaId result, const std::string& rule, const std::vector<int>& refs); // inserts result line
+    Statement statement(size_t i) const; // line i as printed, premises as given
 
-    bool tryConditionalDerivation(const std::string& implicationStr, std::unordered_set<std::string>& attempted);
-    bool tryDirectDerivation(const std::string& goal);
+    // Where a subproof attempt started. A failed attempt is rolled back to
+    // it: its lines are cut from the proof and every index forgets them, in
+    // time proportional to what the attempt added.
+    // Accessible lines MP and MT have matched every pair among; a round
+    // sweeps only the pairs with a line past them. Lines derived in a
+    // subproof go when it closes, so closing returns them to what they were
+    // when it opened.
+    struct Swept {
+        size_t ponens = 0;
+        size_t tollens = 0;
+    };
 
-    bool wasConclusionDerived() const;
-    const std::vector<Statement>& getProofLines() const;
+    struct Checkpoint {
+        size_t lines;
+        ScopedFormulaSet::Mark derived;
+        ScopeTree::Mark scopes;
+        TermIndex::Mark terms;
+        size_t indexedLines;
+        size_t showDepth;
+        int indent;
+        Swept swept;
+    };
+    Checkpoint checkpoint() const;
+    void rollback(const Checkpoint& to);
+
+    // Top-level proof strategies, ordered per goal shape by strategiesFor()
+    enum class Strategy {
+        Conditional,  // CD: assume antecedent, derive consequent
+        Direct,       // DD: goal on an accessible line or one rule step away
+        Forward,      // saturate at the top level
+        Indirect,     // ID: assume the negated goal, derive a contradiction
+        Universal,    // UD: derive an instance for a fresh constant
+        Split         // ADJ/CB: establish each conjunct or conditional, then combine
+    };
+
+    enum class RoundResult {
+        Stalled,   // no rule produced a new formula
+        Progress,  // new formulas were added
+        Stopped,   // the callback asked to stop
+        Cancelled, // a speculative sibling won
+        Exhausted  // the proof reached the line limit
+    };
+
+    // Checked after every appended line, so no round can run past them
+    static constexpr size_t MaxLines = 5000;
+    static constexpr size_t MinRoundGrowth = 64; // a round adds at most max(this, lines so far)
+    bool outOfLines(); // past the line limit: marks the solve aborted
+
+    // Whole-proof configurations raced by portfolio mode
+    enum class StrategyOrder {
+        GoalShape,     // strategiesFor() as is: CD first for implications
+        ForwardFirst,  // saturate right after the direct attempt
+        IndirectFirst  // refute the negated goal right after the direct attempt
+    };
+
+    void search(); // solve() for one configuration, before the proof is written in binary steps
+    void solvePortfolio();
+    std::vector<Strategy> strategiesFor(FormulaId target) const;
+    bool establish(FormulaId target, std::unordered_set<FormulaId>& attempted);
+    bool trySplit(FormulaId target, std::unordered_set<FormulaId>& attempted);
+    void adjoin(FormulaId conjunction); // ADJ lines from conjuncts already on lines
+    template <typename Visit>
+    static bool forEachCombo(size_t n, size_t k, std::vector<int>& combo, Visit&& visit);
+    RoundResult applyRulesRound(const std::function<bool(size_t)>& onDerived);
+    // Accessible lines the rule accepts as premises: the whole view, or those
+    // collected in buffer
+    const std::vector<int>& premiseLines(const Rule& rule, std::vector<int>& buffer) const;
+    bool coversNeeds(const Rule& rule, const std::vector<FormulaId>& premises) const; // one tuple
+
+    // MP and MT over the accessible lines by sweeps of the implication
+    // index; a match is a premise pair by positions lo < hi
+    struct ImplicationMatch {
+        int lo;
+        int hi;
+        bool loIsImplication; // else hi; the order apply tries them in
+        FormulaId source;     // MP: the consequent; MT: the antecedent, negated
+    };
+    void matchImplications(const Rule& rule, size_t from, std::vector<ImplicationMatch>& matches);
+    std::optional<ImplicationMatch> matchTarget(const Rule& rule, FormulaId target);
+    FormulaId conclusionOf(const Rule& rule, const ImplicationMatch& match);
+    size_t& sweptBy(const Rule& rule);
+
+    // Buffers of one applyRulesRound, reused from round to round; a round
+    // that onDerived starts inside another gets the next one
+    struct RoundBuffers {
+        std::vector<size_t> order;     // rules, as planned
+        std::vector<FormulaId> wanted; // bridgeEquivalences' targets
+        std::vector<TermId> instances; // instantiateQuantifiers' terms
+        Conclusions results;
+        std::vector<FormulaId> exprs;
+        std::vector<int> refs;
+        std::vector<int> indices;
+        std::vector<int> matching;
+        std::vector<ImplicationMatch> matches;
+    };
+    bool saturate(FormulaId target);
+    bool tryOneStep(FormulaId target);
+    bool restateGiven(FormulaId target);
+    void importKnowledge();
+    void dropUncitedImports();
+    void restate(const std::vector<Statement>& reported);
+    bool tryLemmaStep(FormulaId target);
+    bool citeLemmaPremises(const Lemma& lemma, size_t k, Bindings& bindings, std::vector<int>& refs);
+    const Lemma* cachedLemma(uint32_t index);
+    bool tryIndirectDerivation(FormulaId target);
+
+    // False only when the truth tables show the accessible lines do not
+    // entail target, so no search for it can succeed
+    bool mayFollow(FormulaId target);
+
+    // Pure Horn problems skip the search: unit propagation decides them and
+    // the derivation is written out as MP, S and ADJ lines. True when the
+    // problem was Horn, whether or not the goal follows.
+    bool decideHorn(FormulaId target);
+    void hornLine(FormulaId atom, FormulaId from); // S steps from a conjunction line down to atom
+
+    // Replacement of equivalents, decided on the e-graph and written out as
+    // explicit rewrite lines only when used
+    bool tryReplacement(FormulaId target);
+    RoundResult bridgeEquivalences(const std::function<bool(size_t)>& onDerived, std::vector<FormulaId>& wanted);
+
+    // First-order steps: UI and ED forward, EG and UD toward a target
+    RoundResult instantiateQuantifiers(const std::function<bool(size_t)>& onDerived, std::vector<TermId>& instances);
+    void instantiationTerms(FormulaId body, TermId var, std::vector<TermId>& out);
+    bool tryGeneralization(FormulaId target);
+    bool tryUniversalDerivation(FormulaId target, std::unordered_set<FormulaId>& attempted);
+    TermId freshConstant();
+    void indexNewLines();
+
+    // Alternative ways to attempt a conditional subproof in parallel mode
+    enum class SubproofStrategy {
+        NestedCD,      // saturate, recursing into CD on implication consequents
+        Saturate,      // saturate only, no nested CD
+        ReversedRules  // nested CD with the rule list tried in reverse order
+    };
+
+    bool tryConditionalDerivation(FormulaId implication, std::unordered_set<FormulaId>& attempted);
+    ProofSolver fork() const; // a solver to race an attempt on from where we stand
+    bool raceConditionalDerivation(FormulaId implication, std::unordered_set<FormulaId>& attempted);
+    bool cancelled() const;
+    bool tryDirectDerivation(FormulaId goal);
 
     bool beautify = false; // connective beautifier flag
+    bool diagnostics = true;
+    bool parallelSubproofs = false;
+    bool allowNestedCD = true;
+    bool portfolio = false;
+    StrategyOrder order = StrategyOrder::GoalShape;
+    bool reversedRules = false;
+    std::string winner;
+    const std::atomic<bool>* cancelFlag = nullptr; // set on speculative forks
+    const std::atomic<bool>* stopFlag = nullptr;   // set by the caller
+    std::function<void(const Statement&)> lineObserver;
+    std::function<void(int)> retractObserver;
+    std::function<void(bool, size_t)> roundObserver;
+    int cdDepth = 0;
+    size_t lineLimit = MaxLines;
+    SolveStats stats;
 
-    std::vector<Statement> proofLines;
+    ProofStore proof;
+    ScopedFormulaSet derived;     // formulas on accessible lines, scoped per subproof
+    ScopeTree scopes;             // accessible lines that rules may combine
     std::vector<std::string> premises;
+    std::unordered_map<LayoutId, std::string> premiseText; // parsed premises, echoed on their PR lines
     std::string conclusion;
+    FormulaId goal = NoFormula; // interned conclusion, set by solve()
     std::vector<Rule> rules;
+    Conclusions conclusions;      // reused by every rule application
+    ImplicationIndex implications; // the accessible lines, in step with scopes
+    std::vector<size_t> hits;      // sweep results, reused
+    std::vector<size_t> factHits;
+    Swept swept;
+    std::vector<Swept> sweptAtOpen; // per open subproof, as showStack
+    std::deque<RoundBuffers> roundBuffers; // by nesting depth; a deque keeps them in place
+    size_t roundDepth = 0;
+    RoundBuffers stepBuffers;              // tryOneStep's and restateGiven's, which never nest
+    RuleScheduler scheduler;
+    std::shared_ptr<const LemmaLibrary> lemmas;
+    std::unordered_map<uint32_t, std::optional<Lemma>> lemmaCache; // parsed on first use
+    std::shared_ptr<const KnowledgeBase> knowledgeBase;
+    size_t knowledgeLimit = DefaultImportLimit;
+    bool importTruncated = false;              // knowledgeLimit left relevant premises out
+    size_t importedFrom = 0;                   // line of the first imported premise
+    std::vector<std::string> importedPremises; // knowledge-base premises on PR lines
+    FormulaStore formulas;
+    TermIndex termIndex;          // ground atoms of all lines, for UI/EG candidates
+    size_t indexedLines = 0;
+    std::unordered_map<FormulaId, FormulaId> instantiated; // ∀/∃ formula -> its fresh-constant instance
+    EGraph equivalences;          // formulas of all usable lines, by equivalence class
+    // (source << 32 | target) pairs the graph equates but no replacement
+    // chain connects; formulas never change, so neither does the answer
+    std::unordered_set<uint64_t> unchained;
+    EntailmentOracle oracle;      // truth tables by formula id, kept across attempts
 
     std::vector<int> showStack; // tracks active subproofs (stores indent levels)
     int currentIndent = 0;      // current depth level
@@ -0,0 +1,93 @@
+#ifndef PROOFSTORE_H
+#define PROOFSTORE_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "Formula.h"
+
+// Represents a single proof line
+struct Statement {
+    int lineNumber;
+    std::string expression;
+    std::string justification;
+    std::vector<int> references;
+    int indentLevel = 0;  // 0 = top-level, increases for subproofs
+    FormulaId formula = NoFormula; // interned expression (none for QED)
+};
+
+// Interned justification name; ShowRule marks "Show:" lines
+using RuleId = int;
+constexpr RuleId ShowRule = 0;
+
+// Struct-of-arrays proof line storage. Each column is contiguous so scans
+// over formulas or indents stream through dense memory; references for all
+// lines share one flat pool addressed by offset/length.
+//
+// A store may extend another, base, which must outlive it and stay unchanged
+// meanwhile: base's lines are read through, and only lines appended past
+// them are stored here. A speculative fork of the solver writes its attempt
+// this way, and the winner's lines are then absorbed by base.
+class ProofStore {
+
+public:
+
+    ProofStore();
+
+    RuleId internRule(const std::string& name);
+    const std::string& ruleName(RuleId rule) const { return ruleNames[rule]; }
+
+    // Appends a line and returns its line number. A line without a layout
+    // renders its formula as render() does.
+    int append(FormulaId formula, RuleId rule, const std::vector<int>& refs, int indent,
+               LayoutId layout = NoLayout);
+    void truncate(size_t n); // drops lines n.. and their references; never base's
+    // Drops the lines flagged in dropped, which no kept line may cite, and
+    // renumbers the rest and their references. Not on an extension.
+    void erase(const std::vector<bool>& dropped);
+    void clear();
+
+    // Empties this store into an extension of base, sharing its rule names
+    void extend(const ProofStore& base);
+    // Appends the lines of extension, which extends this store as it is
+    void absorb(ProofStore&& extension);
+
+    size_t size() const { return first + formulas.size(); }
+    bool empty() const { return size() == 0; }
+
+    FormulaId formula(size_t i) const { return i < first ? base->formula(i) : formulas[i - first]; }
+    RuleId rule(size_t i) const { return i < first ? base->rule(i) : rules[i - first]; }
+    int indent(size_t i) const { return i < first ? base->indent(i) : indents[i - first]; }
+    int lineNumber(size_t i) const { return i < first ? base->lineNumber(i) : lineNumbers[i - first]; }
+    LayoutId layout(size_t i) const { return i < first ? base->layout(i) : layouts[i - first]; }
+    const int* refs(size_t i) const {
+        return i < first ? base->refs(i) : refPool.data() + refOffsets[i - first];
+    }
+    int refCount(size_t i) const { return i < first ? base->refCount(i) : refCounts[i - first]; }
+
+    // Line holds a formula that rules may cite (not Show:, not QED)
+    bool usable(size_t i) const { return formula(i) != NoFormula && rule(i) != ShowRule; }
+
+    // Materializes the row view used for display and external callers
+    Statement statement(size_t i, const FormulaStore& store) const;
+
+private:
+
+    const ProofStore* base = nullptr;
+    size_t first = 0; // base's lines; the columns hold lines first..
+
+    std::vector<FormulaId> formulas;
+    std::vector<RuleId> rules;
+    std::vector<int> indents;
+    std::vector<int> lineNumbers;
+    std::vector<LayoutId> layouts;
+    std::vector<int> refOffsets;
+    std::vector<int> refCounts;
+    std::vector<int> refPool;
+
+    std::vector<std::string> ruleNames;
+    std::unordered_map<std::string, RuleId> ruleIndex;
+
+};
+
+#endif // PROOFSTORE_H
@@ -0,0 +1,67 @@
+#ifndef RULESCHEDULER_H
+#define RULESCHEDULER_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+struct Rule;
+
+// Per-rule firing statistics, counted in saturation rounds
+struct RuleStats {
+    long roundsRun = 0;
+    long roundsFired = 0; // rounds in which the rule added a new formula
+};
+
+// Orders rules for each saturation round by observed hit rate and throttles
+// rules that rarely fire. Live statistics from the current solve are blended
+// with optional statistics persisted from earlier runs, which act as a prior.
+class RuleScheduler {
+
+public:
+
+    void reset(const std::vector<Rule>& rules);
+    // Follows the rules into a new order, keeping each rule's counts
+    void reorder(const std::vector<Rule>& rules);
+    // Takes the counts of fork, a copy of this scheduler that counted on,
+    // perhaps over the rules in another order
+    void absorb(const RuleScheduler& fork);
+
+    // Fills order with the rule indices to run in the next round, best
+    // first. Unless full is set, rules with a low hit rate only run every few
+    // rounds. After cutOff(), the rules ranked behind the cut one go first.
+    void plan(bool full, std::vector<size_t>& order);
+    bool lastPlanThrottled() const { return throttled; }
+
+    // Whether a run of rule over candidates premise lines would try more
+    // combinations than one run may. Such runs are skipped whatever the
+    // rule's hit rate: a rule that always fires is the one that costs most.
+    bool overBudget(size_t rule, size_t candidates) const;
+
+    // Fills order with all rules by hit rate, without counting a round
+    void ranking(std::vector<size_t>& order) const;
+
+    void record(size_t rule, bool fired);
+
+    // A round ended inside rule on its growth budget; the rules behind it
+    // did not run and open the next plan
+    void cutOff(size_t rule) { resumeAfter = static_cast<long>(rule); }
+
+    bool load(const std::string& path);
+    bool save(const std::string& path) const;
+
+private:
+
+    double hitRate(size_t rule) const;
+
+    std::vector<std::string> names;
+    std::vector<int> arity;
+    std::vector<RuleStats> live;
+    std::unordered_map<std::string, RuleStats> persisted;
+    int round = 0;
+    bool throttled = false;
+    long resumeAfter = -1;
+
+};
+
+#endif // RULESCHEDULER_H
@@ -6,4 +6,14 @@
 // Function to return all propositional, predicate, and derived rules
 std::vector<Rule> getAllRules();
 
+// Replacement of equivalents: DNE/DNI and the De Morgan and negated
+// conditional laws (D-DMO, D-DMT, D-SDMO, D-SDMT, D-NC) may also rewrite a
+// single subformula. True when `to` is `from` with one such rewrite.
+bool isReplacementStep(FormulaStore& fs, const std::string& rule, FormulaId from, FormulaId to);
+
+// Replacement steps leading from `from` to `to` as (formula, rule) lines, or
+// nullopt if the laws do not connect them
+std::optional<std::vector<std::pair<FormulaId, std::string>>>
+replacementChain(FormulaStore& fs, FormulaId from, FormulaId to);
+
 #endif // RULES_H
@@ -0,0 +1,87 @@
+#ifndef SCOPETREE_H
+#define SCOPETREE_H
+
+#include <array>
+#include <cstddef>
+#include <vector>
+#include "Formula.h"
+
+// Tree of subproof scopes over proof lines, maintained as subproofs open and
+// close. A line is accessible while the scope it was written in is open; the
+// accessible lines of all open scopes form a stack, so closing a scope just
+// truncates it.
+//
+// The tree also counts the connectives heading the accessible lines, so the
+// solver can tell which rules could match anything in the current scope.
+//
+// A tree may extend another, base, as a ProofStore extends its base. It
+// copies only the accessible lines, which rules scan as one array; the
+// scopes base opened and the scopes of its lines are read through, and
+// marks count them too. An extension never closes a scope it inherited.
+class ScopeTree {
+
+public:
+
+    // Sizes to return to when an attempt is abandoned
+    struct Mark {
+        size_t scopes;
+        size_t open;
+        size_t lines;
+        size_t indexed;
+    };
+
+    ScopeTree();
+
+    void open(int showLine); // enters a subproof opened by showLine (an index)
+    void close();            // leaves the innermost subproof; no-op at top level
+    void add(int line, Connective head); // a citable line written in the innermost scope
+
+    Mark mark() const {
+        return {first.scopes + scopes.size(), stack.size(), lines.size(), first.indexed + scopeOf.size()};
+    }
+    void rollback(const Mark& mark); // forgets scopes and lines added since mark
+
+    // Makes this tree an extension of base
+    void extend(const ScopeTree& base);
+    // Takes the scopes and lines of extension, which extends this tree as it is
+    void absorb(ScopeTree&& extension);
+
+    // Indices of citable lines in open scopes, ascending
+    const std::vector<int>& accessible() const { return lines; }
+    bool isAccessible(int line) const;
+
+    Connective head(size_t pos) const { return headOf[pos]; } // of accessible()[pos]
+
+    // Connectives heading at least one accessible line
+    ShapeMask heads() const;
+    bool covers(ShapeMask needs) const { return (heads() & needs) == needs; }
+
+    int depth() const { return static_cast<int>(stack.size()) - 1; }
+
+private:
+
+    struct Scope {
+        int parent;
+        int showLine;   // -1 for the top level
+        size_t mark;    // lines.size() when the scope opened
+        bool open;
+    };
+
+    void truncate(size_t size); // drops accessible lines past size
+    const Scope& scope(int id) const {
+        return static_cast<size_t>(id) < first.scopes ? base->scope(id) : scopes[id - first.scopes];
+    }
+
+    const ScopeTree* base = nullptr;
+    Mark first{0, 0, 0, 0}; // base's mark when extended
+
+    std::vector<Scope> scopes; // scopes first.scopes..
+    std::vector<int> stack;     // open scopes, innermost last
+    std::vector<int> lines;
+    std::vector<Connective> headOf; // parallel to lines
+    std::array<size_t, static_cast<int>(Connective::Exists) + 1> headCount{}; // accessible lines per connective
+    std::vector<int> scopeOf;   // line index - first.indexed -> scope, -1 if never added
+
+};
+
+#endif // SCOPETREE_H
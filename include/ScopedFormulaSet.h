@@ -0,0 +1,66 @@
+#ifndef SCOPEDFORMULASET_H
+#define SCOPEDFORMULASET_H
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+#include "Formula.h"
+
+// Formulas held on currently accessible proof lines, keyed to the first such
+// line. Subproofs push a scope; every insertion is logged, so popping a scope
+// undoes exactly the insertions made inside it, in O(changes) rather than by
+// rebuilding the set from the proof. The same log lets a mark() taken
+// before a failed attempt be restored, however many scopes it left open.
+//
+// A set may extend another, base, as a ProofStore extends its base: base's
+// formulas count as present, and only insertions made here are held. Marks
+// count base's insertions and scopes too, so an extension's marks compare
+// with base's; it never pops a scope or rolls back past what it inherited.
+//
+// Lines are held densely by formula id, so an insertion allocates only when
+// the id range or the log grows.
+class ScopedFormulaSet {
+
+public:
+
+    struct Mark {
+        size_t insertions;
+        size_t scopes;
+    };
+
+    // Returns false if f is already present
+    bool insert(FormulaId f, size_t line);
+    bool contains(FormulaId f) const { return held(f) || (base && base->contains(f)); }
+    std::optional<size_t> line(FormulaId f) const;
+
+    void pushScope() { marks.push_back(inherited.insertions + undo.size()); }
+    void popScope(); // no-op at the outermost scope
+
+    Mark mark() const { return {inherited.insertions + undo.size(), inherited.scopes + marks.size()}; }
+    void rollback(const Mark& mark); // undoes every insertion and scope since mark
+    void clear();
+
+    // Empties this set into an extension of base
+    void extend(const ScopedFormulaSet& base);
+    // Takes the insertions and scopes of extension, which extends this set as it is
+    void absorb(ScopedFormulaSet&& extension);
+
+    size_t size() const { return undo.size() + (base ? base->size() : 0); }
+
+private:
+
+    static constexpr size_t NoLine = SIZE_MAX;
+
+    bool held(FormulaId f) const { return static_cast<size_t>(f) < lines.size() && lines[f] != NoLine; }
+    void unset(size_t from); // drops the insertions logged from position from on
+
+    const ScopedFormulaSet* base = nullptr;
+    Mark inherited{0, 0}; // base's mark when extended
+
+    std::vector<size_t> lines;    // by formula id, NoLine if not inserted here
+    std::vector<FormulaId> undo;  // insertion log
+    std::vector<size_t> marks;    // mark().insertions at each pushScope()
+
+};
+
+#endif // SCOPEDFORMULASET_H
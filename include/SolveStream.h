@@ -0,0 +1,84 @@
+#ifndef SOLVESTREAM_H
+#define SOLVESTREAM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+#include "ProofSolver.h"
+
+// What a stream yields: a line appended to the proof, or the withdrawal of
+// every line numbered from `from` on
+struct StreamEvent {
+    enum class Kind { Line, Retract };
+    Kind kind = Kind::Line;
+    Statement line; // Kind::Line
+    int from = 0;   // Kind::Retract
+};
+
+// Resumable solve that yields proof lines as they are derived. The search
+// runs as a generator: it advances only inside next()/resume() and is parked
+// at the event it just yielded in between, so a caller can interleave many
+// streams on one thread, stop giving one budget, or drop it at any point.
+//
+// A yielded line is not final. When a failed subproof attempt is rolled
+// back, a Retract event names the first line it withdraws, and the lines
+// that follow reuse those numbers. Once the search is over, solve() drops
+// the imported premises no line cites and writes the proof out in Carnap's
+// binary steps; the stream then retracts from the first line that changed
+// and yields the final proof from there, so applying every event leaves
+// exactly getProofLines().
+//
+// The strategies recurse (CD inside a saturation round, UD into CD, ...), so
+// the suspended search keeps its own stack on a worker thread: each stream
+// holds one OS thread, with its full stack reserved, from the first next()
+// until the search finishes or is dropped. Control is handed back and forth
+// and only one side ever runs at a time, but interleaving thousands of
+// streams means thousands of parked threads.
+class SolveStream {
+
+public:
+
+    // solver must already have its input set; it is borrowed for the stream's lifetime
+    explicit SolveStream(ProofSolver& solver);
+    ~SolveStream(); // drops the search if it has not finished
+
+    SolveStream(const SolveStream&) = delete;
+    SolveStream& operator=(const SolveStream&) = delete;
+
+    // Runs until the next line is appended or lines are withdrawn; nullopt
+    // once the search is over
+    std::optional<StreamEvent> next();
+
+    // Applies up to budget further events to out, which holds the lines
+    // streamed so far; returns how many were applied
+    size_t resume(size_t budget, std::vector<Statement>& out);
+
+    // Stops the search; events not yet yielded are discarded
+    void drop();
+
+    bool finished() const;
+
+private:
+
+    enum class State {
+        Idle,     // not started, or parked after yielding an event
+        Running,  // the search is advancing
+        Finished  // solve() returned or the stream was dropped
+    };
+
+    void publish(StreamEvent event); // on the worker
+
+    ProofSolver& solver;
+    std::thread worker;
+    mutable std::mutex mutex;
+    std::condition_variable handoff;
+    State state = State::Idle;
+    std::optional<StreamEvent> pending;
+    std::atomic<bool> stop{false};
+
+};
+
+#endif // SOLVESTREAM_H
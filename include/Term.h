@@ -0,0 +1,65 @@
+#ifndef TERM_H
+#define TERM_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+
+// Interned term handle; -1 means "no term"
+using TermId = int;
+constexpr TermId NoTerm = -1;
+
+enum class TermKind {
+    Variable,  // bound by an enclosing quantifier
+    Constant,
+    Function   // f(t1, ..., tn)
+};
+
+struct Term {
+    TermKind kind;
+    std::string name;
+    std::vector<TermId> args; // functions only
+};
+
+// Variable -> term it is bound to
+using Substitution = std::unordered_map<TermId, TermId>;
+
+// Hash-consed store of first-order terms, so term equality is an int compare
+class TermStore {
+
+public:
+
+    TermId variable(std::string_view name);
+    TermId constant(std::string_view name);
+    TermId function(std::string_view name, std::vector<TermId> args);
+
+    // Existing variable or constant with this name, or NoTerm
+    TermId find(TermKind kind, const std::string& name) const;
+
+    const Term& get(TermId t) const { return terms[t]; }
+    size_t size() const { return terms.size(); }
+    bool ground(TermId t) const;
+    bool occurs(TermId var, TermId t) const;
+    std::string render(TermId t) const;
+
+    // t with every occurrence of var replaced by replacement
+    TermId substitute(TermId t, TermId var, TermId replacement);
+
+    // Most general unifier of a and b extending s (with occurs check); on
+    // failure s is left unchanged
+    bool unify(TermId a, TermId b, Substitution& s) const;
+
+private:
+
+    TermId intern(Term term);
+    TermId resolve(TermId t, const Substitution& s) const;
+    bool unifyInto(TermId a, TermId b, Substitution& s) const;
+    bool occursUnder(TermId var, TermId t, const Substitution& s) const;
+
+    std::vector<Term> terms;
+    std::unordered_map<std::string, TermId> index;
+
+};
+
+#endif // TERM_H
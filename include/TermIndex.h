@@ -0,0 +1,57 @@
+#ifndef TERMINDEX_H
+#define TERMINDEX_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include "Formula.h"
+
+// Discrimination tree over ground predicate atoms. Each atom is stored along
+// the preorder sequence of its symbols (predicate, then each argument term),
+// so a lookup with a pattern whose variables act as wildcards only visits
+// atoms that agree with the pattern's fixed symbols. Candidates still have to
+// be unified with the pattern to obtain the substitution.
+class TermIndex {
+
+public:
+
+    struct Mark {
+        size_t atoms;
+        size_t nodes;
+    };
+
+    // Ignores non-ground atoms and atoms already present
+    void insert(FormulaId atom, const FormulaStore& store);
+
+    // Ground atoms that may unify with the predicate pattern
+    std::vector<FormulaId> candidates(FormulaId pattern, const FormulaStore& store) const;
+
+    size_t size() const { return inserted.size(); }
+
+    // Removes the atoms inserted since mark, and the nodes only they used
+    Mark mark() const { return {order.size(), nodes.size()}; }
+    void rollback(const Mark& mark);
+
+private:
+
+    struct Node {
+        std::unordered_map<std::string, int> children; // symbol -> node
+        std::vector<FormulaId> atoms;                 // atoms ending here
+        int parent = -1;
+        std::string edge;                             // symbol leading here from parent
+    };
+
+    static std::string symbol(const Term& term);
+    static int arity(const std::string& symbol);
+    void flatten(TermId t, const TermStore& terms, std::vector<std::string>& out) const;
+    void retrieve(int node, const std::vector<std::string>& keys, size_t i, std::vector<FormulaId>& out) const;
+    void skip(int node, int pending, std::vector<int>& out) const;
+
+    std::vector<Node> nodes = std::vector<Node>(1);
+    std::unordered_set<FormulaId> inserted;
+    std::vector<std::pair<FormulaId, int>> order; // atom and its node, in insertion order
+
+};
+
+#endif // TERMINDEX_H
@@ -4,6 +4,7 @@
 #include <string>
 #include <algorithm>
 #include <cctype>
+#include <vector>
 
 // Trim helper
 inline std::string trim(const std::string& str) {
@@ -12,6 +13,25 @@ inline std::string trim(const std::string& str) {
     return (first == std::string::npos) ? "" : str.substr(first, last - first + 1);
 }
 
+// Splits on commas outside parentheses, so "F(a,b),G(a)" gives two premises
+inline std::vector<std::string> splitPremiseList(const std::string& text) {
+    std::vector<std::string> out;
+    std::string item;
+    int depth = 0;
+    for (char c : text) {
+        if (c == '(') depth++;
+        if (c == ')') depth--;
+        if (c == ',' && depth == 0) {
+            out.push_back(item);
+            item.clear();
+        } else {
+            item += c;
+        }
+    }
+    if (!item.empty()) out.push_back(item);
+    return out;
+}
+
 // Normalize logical connectives to canonical forms
 inline std::string normalizeConnectives(const std::string& raw) {
     std::string s = trim(raw);
@@ -0,0 +1,90 @@
+#ifndef SYLLOGISM_H
+#define SYLLOGISM_H
+
+/*
+ * Stable C interface to libsyllogism.
+ *
+ * A syl_solver holds one problem: set the input, optionally set limits and a
+ * lemma library, call syl_solve(), then read the proof lines back. Strings are
+ * copied into caller-owned buffers snprintf-style: the return value is the
+ * full length (without the terminating NUL), so a call with size 0 measures.
+ * Handles are not thread-safe; use one per thread.
+ */
+
+#include <stddef.h>
+
+#if defined(_WIN32)
+#  define SYL_API
+#elif defined(__GNUC__)
+#  define SYL_API __attribute__((visibility("default")))
+#else
+#  define SYL_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SYL_API_VERSION 1
+
+typedef struct syl_solver syl_solver;
+
+typedef enum syl_status {
+    SYL_OK = 0,
+    SYL_PROVED = 1,          /* syl_solve() only */
+    SYL_NOT_PROVED = 2,
+    SYL_LIMIT_REACHED = 3,   /* stopped by syl_set_limits(); lines so far are kept */
+    SYL_INVALID_INPUT = 4,   /* a premise or the conclusion does not parse */
+    SYL_INVALID_ARGUMENT = 5,
+    SYL_ERROR = 6
+} syl_status;
+
+typedef struct syl_line {
+    int number;             /* 1-based */
+    int indent;             /* 0 = top level */
+    size_t reference_count;
+} syl_line;
+
+SYL_API unsigned syl_api_version(void);
+
+SYL_API syl_solver* syl_create(void);
+SYL_API void syl_destroy(syl_solver* solver);
+
+/* Premises are comma separated; connectives as accepted by the CLI */
+SYL_API syl_status syl_set_input(syl_solver* solver, const char* premises, const char* conclusion);
+
+/* 0 means unlimited. The search abandons attempts that would pass max_lines,
+   in portfolio mode too, and a proof written out longer than that is cut to
+   its first max_lines lines with SYL_LIMIT_REACHED. */
+SYL_API syl_status syl_set_limits(syl_solver* solver, size_t max_lines, unsigned time_limit_ms);
+
+/* Opens a library built with --compile-lemmas; NULL path clears it */
+SYL_API syl_status syl_set_lemmas(syl_solver* solver, const char* path);
+
+/* Opens a knowledge base built with --compile-kb; relevant premises are
+   added to each solve. NULL path clears it */
+SYL_API syl_status syl_set_knowledge_base(syl_solver* solver, const char* path);
+
+/* Nonzero races several strategy configurations on threads (see syl_get_strategy) */
+SYL_API syl_status syl_set_portfolio(syl_solver* solver, int enable);
+
+SYL_API syl_status syl_solve(syl_solver* solver);
+
+SYL_API size_t syl_line_count(const syl_solver* solver);
+SYL_API syl_status syl_get_line(const syl_solver* solver, size_t index, syl_line* out);
+SYL_API size_t syl_get_expression(const syl_solver* solver, size_t index, char* buffer, size_t size);
+SYL_API size_t syl_get_rule(const syl_solver* solver, size_t index, char* buffer, size_t size);
+/* Copies up to capacity references; returns the total count */
+SYL_API size_t syl_get_references(const syl_solver* solver, size_t index, int* buffer, size_t capacity);
+
+/* Portfolio configuration that found the last proof; empty otherwise */
+SYL_API size_t syl_get_strategy(const syl_solver* solver, char* buffer, size_t size);
+
+/* The whole proof in the CLI's plain output format */
+SYL_API size_t syl_get_proof_text(const syl_solver* solver, char* buffer, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SYLLOGISM_H */
@@ -0,0 +1,221 @@
+#include "BatchRunner.h"
+#include "ProblemCorpus.h"
+#include "ProofSolver.h"
+#include "Utils.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+struct Timed {
+    bool proved;
+    bool stopped;
+    double elapsedMs;
+};
+
+// Solves under a watchdog that raises the stop flag after budgetMs
+Timed solveWithin(ProofSolver& solver, unsigned budgetMs) {
+    std::atomic<bool> stop{false};
+    solver.setStopFlag(&stop);
+
+    std::mutex mutex;
+    std::condition_variable done;
+    bool finished = false;
+    std::thread watchdog([&, limit = std::chrono::milliseconds(budgetMs)] {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (!done.wait_for(lock, limit, [&] { return finished; })) stop = true;
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    solver.solve();
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        finished = true;
+    }
+    done.notify_one();
+    watchdog.join();
+
+    bool proved = solver.wasConclusionDerived();
+    return {proved, !proved && stop.load(), elapsed.count()};
+}
+
+} // namespace
+
+const char* toString(JobOutcome outcome) {
+    switch (outcome) {
+        case JobOutcome::Proved: return "PROVED";
+        case JobOutcome::NotProved: return "NOT_PROVED";
+        case JobOutcome::OverBudget: return "OVER_BUDGET";
+        case JobOutcome::Rejected: return "REJECTED";
+    }
+    return "";
+}
+
+BatchRunner::BatchRunner(CostModel& model, BatchOptions options)
+    : model(model), options(options) {}
+
+void BatchRunner::useLemmas(std::shared_ptr<const LemmaLibrary> library) {
+    lemmas = std::move(library);
+}
+
+void BatchRunner::useKnowledgeBase(std::shared_ptr<const KnowledgeBase> kb, size_t limit) {
+    knowledgeBase = std::move(kb);
+    knowledgeLimit = limit;
+}
+
+bool BatchRunner::add(const std::string& line) {
+    size_t index = lines++;
+
+    // Split first: the parser would read the | of |- as v
+    size_t turnstile = line.find("|-");
+    size_t width = 2;
+    if (turnstile == std::string::npos) {
+        turnstile = line.find("⊢");
+        width = std::string("⊢").size();
+    }
+    if (turnstile == std::string::npos) {
+        std::cerr << "[BATCH] Line " << index + 1 << ": expected premises |- conclusion\n";
+        return false;
+    }
+
+    std::string premiseText = trim(line.substr(0, turnstile));
+    std::string conclusion = trim(line.substr(turnstile + width));
+
+    std::vector<FormulaId> premises;
+    for (const auto& item : splitPremiseList(premiseText)) {
+        auto p = store.parse(trim(item));
+        if (!p) {
+            std::cerr << "[BATCH] Line " << index + 1 << ": cannot parse premise " << trim(item) << "\n";
+            return false;
+        }
+        premises.push_back(*p);
+    }
+    auto goal = store.parse(conclusion);
+    if (!goal) {
+        std::cerr << "[BATCH] Line " << index + 1 << ": cannot parse conclusion " << conclusion << "\n";
+        return false;
+    }
+
+    addJob(std::move(premiseText), std::move(conclusion), premises, *goal);
+    return true;
+}
+
+void BatchRunner::addJob(std::string premises, std::string conclusion, const std::vector<FormulaId>& parsed, FormulaId goal) {
+    jobs.push_back({lines - 1, std::move(premises), std::move(conclusion), extractFeatures(store, parsed, goal), 0.0, 0});
+}
+
+size_t BatchRunner::addAll(std::istream& in) {
+    size_t failed = 0;
+    std::string line;
+    while (std::getline(in, line)) {
+        std::string text = trim(line);
+        if (text.empty() || text[0] == '#') {
+            lines++;
+            continue;
+        }
+        if (!add(text)) failed++;
+    }
+    return failed;
+}
+
+size_t BatchRunner::addFile(const std::string& path) {
+    ProblemCorpus corpus(path);
+    if (!corpus.valid()) return 1;
+
+    // Indices continue from earlier input, counting skipped lines, the
+    // file's trailing ones included
+    size_t base = lines;
+    size_t failed = corpus.parseAll(store, [&](const CorpusRecord& record, const std::vector<FormulaId>& premises, FormulaId goal) {
+        std::string list;
+        for (std::string_view p : record.premises) {
+            if (!list.empty()) list += ",";
+            list += p;
+        }
+        lines = base + record.line;
+        addJob(std::move(list), std::string(record.conclusion), premises, goal);
+    });
+    lines = base + corpus.lineCount();
+    return failed;
+}
+
+std::vector<BatchJob> BatchRunner::schedule(std::vector<size_t>* rejected) const {
+    std::vector<BatchJob> admitted;
+    for (BatchJob job : jobs) {
+        job.predictedMs = model.predictMs(job.features);
+        if (job.predictedMs > options.rejectOverMs) {
+            if (rejected) rejected->push_back(job.index);
+            continue;
+        }
+        double budget = std::clamp(job.predictedMs * options.slack,
+                                   static_cast<double>(options.minBudgetMs),
+                                   static_cast<double>(options.maxBudgetMs));
+        job.budgetMs = static_cast<unsigned>(budget);
+        admitted.push_back(std::move(job));
+    }
+
+    // Shortest predicted first; ties keep input order
+    std::stable_sort(admitted.begin(), admitted.end(), [](const BatchJob& a, const BatchJob& b) {
+        return a.predictedMs < b.predictedMs;
+    });
+    return admitted;
+}
+
+std::vector<BatchResult> BatchRunner::run(bool verbose) {
+    std::vector<size_t> rejected;
+    std::deque<BatchJob> queue;
+    for (BatchJob& job : schedule(&rejected)) queue.push_back(std::move(job));
+
+    std::vector<BatchResult> results;
+    for (size_t index : rejected) {
+        auto it = std::find_if(jobs.begin(), jobs.end(), [&](const BatchJob& j) { return j.index == index; });
+        results.push_back({index, JobOutcome::Rejected, model.predictMs(it->features), 0.0, 0});
+    }
+
+    std::vector<bool> retried(lines, false);
+    while (!queue.empty()) {
+        BatchJob job = std::move(queue.front());
+        queue.pop_front();
+
+        ProofSolver solver;
+        solver.enableDiagnostics(false);
+        solver.setInput(job.premises, job.conclusion);
+        if (lemmas) solver.useLemmas(lemmas);
+        if (knowledgeBase) solver.useKnowledgeBase(knowledgeBase, knowledgeLimit);
+
+        Timed timed = solveWithin(solver, job.budgetMs);
+        if (timed.stopped && !retried[job.index] && job.budgetMs < options.maxBudgetMs) {
+            // Deferred behind the rest of the batch with the largest budget
+            if (verbose)
+                std::cout << "[BATCH] #" << job.index + 1 << " exceeded " << job.budgetMs << " ms, requeued\n";
+            retried[job.index] = true;
+            job.budgetMs = options.maxBudgetMs;
+            queue.push_back(std::move(job));
+            continue;
+        }
+
+        JobOutcome outcome = timed.proved ? JobOutcome::Proved
+                           : timed.stopped ? JobOutcome::OverBudget
+                           : JobOutcome::NotProved;
+        // A stopped solve only bounds its cost from below, so it is not a sample
+        if (!timed.stopped) model.observe(job.features, timed.elapsedMs);
+        results.push_back({job.index, outcome, job.predictedMs, timed.elapsedMs, job.budgetMs});
+    }
+
+    if (verbose) {
+        for (const BatchResult& r : results) {
+            std::cout << "[BATCH] #" << r.index + 1 << " " << toString(r.outcome)
+                      << " predicted " << static_cast<long>(r.predictedMs) << " ms";
+            if (r.outcome != JobOutcome::Rejected)
+                std::cout << ", took " << static_cast<long>(r.elapsedMs) << " of " << r.budgetMs << " ms";
+            std::cout << "\n";
+        }
+    }
+    return results;
+}
@@ -0,0 +1,536 @@
+#include "BinaryProof.h"
+#include "CarnapRules.h"
+#include <algorithm>
+#include <unordered_set>
+
+namespace {
+
+// Or-leaves of a layout with their Or ancestors, root first
+void disjuncts(const FormulaStore& fs, LayoutId l, std::vector<LayoutId>& path,
+               std::vector<std::pair<LayoutId, std::vector<LayoutId>>>& out) {
+    if (!fs.is(fs.layout(l).formula, Connective::Or)) {
+        out.emplace_back(l, path);
+        return;
+    }
+    path.push_back(l);
+    LayoutId left = fs.layout(l).operands[0], right = fs.layout(l).operands[1];
+    disjuncts(fs, left, path, out);
+    disjuncts(fs, right, path, out);
+    path.pop_back();
+}
+
+std::vector<int> ordered(int a, int b) {
+    return {std::min(a, b), std::max(a, b)};
+}
+
+bool isEquivalence(const std::string& rule) {
+    return rule == "DNE" || rule == "DNI" || rule == "D-DMO" || rule == "D-DMT" || rule == "D-SDMO" ||
+           rule == "D-SDMT" || rule == "D-NC";
+}
+
+} // namespace
+
+ProofStore BinaryProofWriter::write(const ProofStore& proof) {
+    out = ProofStore();
+    shows.clear();
+    visible.clear();
+    frames.clear();
+    byLayout.clear();
+    byFormula.clear();
+    seen.clear();
+    std::vector<int> moved(proof.size() + 1, 0); // old line number -> new
+
+    for (size_t i = 0; i < proof.size(); ++i) {
+        FormulaId f = proof.formula(i);
+        const std::string& rule = proof.ruleName(proof.rule(i));
+        int indent = proof.indent(i);
+        std::vector<int> refs;
+        for (int k = 0; k < proof.refCount(i); ++k) refs.push_back(moved[proof.refs(i)[k]]);
+
+        int line;
+        if (f == NoFormula) {
+            // QED: closes the innermost subproof in place
+            refs = closing(rule, refs);
+            close();
+            line = emit(NoLayout, rule, refs, indent);
+        } else if (proof.rule(i) == ShowRule) {
+            LayoutId given = proof.layout(i);
+            line = open(given != NoLayout ? given : compose(f, {}), indent);
+        } else if (!shows.empty() && indent == out.indent(static_cast<size_t>(shows.back() - 1)) - 1) {
+            // Result one level out: states the Show line's formula as shown
+            LayoutId shown = layoutOf(shows.back());
+            refs = closing(rule, refs);
+            close();
+            line = emit(shown, rule, refs, indent);
+        } else if (rule == "PR") {
+            LayoutId given = proof.layout(i);
+            line = emit(given != NoLayout ? given : formulas.defaultLayout(f), rule, refs, indent);
+        } else if (rule == "AS") {
+            line = emit(assumed(f), rule, refs, indent);
+        } else {
+            line = step(f, rule, refs, indent);
+        }
+        moved[proof.lineNumber(i)] = line;
+    }
+
+    // A goal reached modulo AC is restated as line 1 has it
+    if (shows.size() == 1) {
+        LayoutId goal = layoutOf(shows[0]);
+        if (auto held = lineHolding(formulaOf(goal)); held && !lineWith(goal))
+            conform(*held, goal, out.indent(static_cast<size_t>(*held - 1)));
+    }
+    return std::move(out);
+}
+
+int BinaryProofWriter::emit(LayoutId layout, const std::string& rule, std::vector<int> refs, int indent) {
+    FormulaId f = layout == NoLayout ? NoFormula : formulaOf(layout);
+    int line = out.append(f, out.internRule(rule), refs, indent, layout);
+    if (layout == NoLayout) return line;
+
+    visible.push_back(line);
+    byLayout[layout].push_back(line);
+    byFormula[f].push_back(line);
+    std::vector<LayoutId> subtrees = {layout};
+    while (!subtrees.empty()) {
+        LayoutId l = subtrees.back();
+        subtrees.pop_back();
+        seen.emplace(formulaOf(l), l);
+        const auto& operands = formulas.layout(l).operands;
+        subtrees.insert(subtrees.end(), operands.begin(), operands.end());
+    }
+    return line;
+}
+
+int BinaryProofWriter::open(LayoutId show, int indent) {
+    int line = out.append(formulaOf(show), ShowRule, {}, indent, show);
+    shows.push_back(line);
+    frames.push_back(visible.size());
+    return line;
+}
+
+void BinaryProofWriter::close() {
+    if (shows.empty()) return;
+    shows.pop_back();
+    for (size_t k = visible.size(); k-- > frames.back();) {
+        LayoutId l = layoutOf(visible[k]);
+        byLayout[l].pop_back();
+        byFormula[formulaOf(l)].pop_back();
+    }
+    visible.resize(frames.back());
+    frames.pop_back();
+}
+
+LayoutId BinaryProofWriter::negation(LayoutId layout) {
+    return formulas.arrange(formulas.negate(formulaOf(layout)), {layout});
+}
+
+std::optional<int> BinaryProofWriter::lineWith(LayoutId l) const {
+    auto it = byLayout.find(l);
+    if (it == byLayout.end() || it->second.empty()) return std::nullopt;
+    return it->second.back();
+}
+
+std::optional<int> BinaryProofWriter::lineHolding(FormulaId f) const {
+    auto it = byFormula.find(f);
+    if (it == byFormula.end() || it->second.empty()) return std::nullopt;
+    return it->second.back();
+}
+
+LayoutId BinaryProofWriter::compose(FormulaId f, std::vector<LayoutId> pieces) {
+    for (size_t k = shows.size(); k-- > 0;) pieces.push_back(layoutOf(shows[k]));
+    return build(f, pieces);
+}
+
+LayoutId BinaryProofWriter::findSubtree(LayoutId root, FormulaId f) const {
+    if (formulaOf(root) == f) return root;
+    for (LayoutId operand : formulas.layout(root).operands)
+        if (LayoutId found = findSubtree(operand, f); found != NoLayout) return found;
+    return NoLayout;
+}
+
+// A subtree of the pieces or of an earlier line where f has one; otherwise
+// f's own connective over composed operands. An n-ary ^/v takes the largest
+// subtree of the pieces that groups some of its operands, then the rest.
+LayoutId BinaryProofWriter::build(FormulaId f, const std::vector<LayoutId>& pieces) {
+    for (LayoutId piece : pieces)
+        if (LayoutId found = findSubtree(piece, f); found != NoLayout) return found;
+    if (auto it = seen.find(f); it != seen.end()) return it->second;
+
+    Connective op = formulas.get(f).op;
+    std::vector<FormulaId> ops = formulas.get(f).operands; // copied: interning may move nodes
+
+    if (op == Connective::And || op == Connective::Or) {
+        LayoutId best = NoLayout;
+        std::vector<FormulaId> grouped;
+        std::vector<LayoutId> stack(pieces.rbegin(), pieces.rend()); // preorder: ties go to the leftmost
+        while (!stack.empty()) {
+            LayoutId l = stack.back();
+            stack.pop_back();
+            const Layout& node = formulas.layout(l);
+            stack.insert(stack.end(), node.operands.rbegin(), node.operands.rend());
+
+            std::vector<FormulaId> group = {node.formula};
+            if (formulas.is(node.formula, op)) group = formulas.get(node.formula).operands;
+            std::sort(group.begin(), group.end());
+            if (group.size() >= ops.size() || group.size() <= grouped.size()) continue;
+            if (std::includes(ops.begin(), ops.end(), group.begin(), group.end())) {
+                best = l;
+                grouped = group;
+            }
+        }
+        if (best == NoLayout) {
+            best = build(ops[0], pieces);
+            grouped = {ops[0]};
+        }
+
+        std::vector<FormulaId> rest;
+        std::set_difference(ops.begin(), ops.end(), grouped.begin(), grouped.end(), std::back_inserter(rest));
+        FormulaId remainder = rest.size() == 1 ? rest[0]
+                            : op == Connective::And ? formulas.conjoin(rest) : formulas.disjoin(rest);
+        return formulas.join(op, best, build(remainder, pieces));
+    }
+
+    std::vector<LayoutId> operands;
+    for (FormulaId operand : ops) operands.push_back(build(operand, pieces));
+    return formulas.arrange(f, operands);
+}
+
+LayoutId BinaryProofWriter::assumed(FormulaId f) {
+    if (shows.empty()) return compose(f, {});
+    LayoutId show = layoutOf(shows.back());
+    FormulaId shown = formulaOf(show);
+    std::vector<LayoutId> parts = formulas.layout(show).operands; // copied: negation() interns
+
+    bool conditional = formulas.is(shown, Connective::Implies) || formulas.is(shown, Connective::Not);
+    if (conditional && formulaOf(parts[0]) == f) return parts[0]; // CD's antecedent, or ID on ~φ
+    if (f == formulas.negate(shown)) return negation(show);
+    return compose(f, {});
+}
+
+LayoutId BinaryProofWriter::wanted(FormulaId f) const {
+    if (shows.empty()) return NoLayout;
+    LayoutId show = layoutOf(shows.back());
+    if (formulaOf(show) == f) return show;
+    if (formulas.is(formulaOf(show), Connective::Implies) && formulaOf(formulas.layout(show).operands[1]) == f)
+        return formulas.layout(show).operands[1];
+    return NoLayout;
+}
+
+// DD, CD and ID cite their lines as the Show line has them
+std::vector<int> BinaryProofWriter::closing(const std::string& rule, std::vector<int> refs) {
+    if (shows.empty()) return refs;
+    LayoutId shown = layoutOf(shows.back());
+    int indent = out.indent(static_cast<size_t>(shows.back() - 1));
+
+    if (rule == "DD" && refs.size() == 1) {
+        refs[0] = conform(refs[0], shown, indent);
+    } else if (rule == "CD" && refs.size() == 1 && formulas.is(formulaOf(shown), Connective::Implies)) {
+        LayoutId consequent = formulas.layout(shown).operands[1];
+        refs[0] = conform(refs[0], consequent, indent);
+    } else if (rule == "ID" && refs.size() == 2) {
+        // The negation of the pair is regrouped to negate the other line
+        LayoutId a = layoutOf(refs[0]), b = layoutOf(refs[1]);
+        if (formulaOf(a) == formulas.negate(formulaOf(b))) refs[0] = conform(refs[0], negation(b), indent);
+        else refs[1] = conform(refs[1], negation(a), indent);
+    }
+    return refs;
+}
+
+int BinaryProofWriter::step(FormulaId f, const std::string& rule, const std::vector<int>& refs, int indent) {
+    // A conjunction that closes the subproof is built as its Show line has it
+    LayoutId target = wanted(f);
+    if (target != NoLayout && (rule == "S" || rule == "ADJ")) {
+        std::vector<int> lines = visible;
+        if (auto line = assemble(target, lines, indent)) return *line;
+    }
+
+    if (rule == "S" && refs.size() == 1) return simplify(refs[0], f, indent);
+    if (rule == "ADJ" && refs.size() == 2) return adjoin(refs, f, indent);
+    if (rule == "MTP" && refs.size() == 2) return eliminate(refs, f, indent);
+    if (rule == "MP" && refs.size() == 2) return detach(refs, f, indent);
+    if (isEquivalence(rule) && refs.size() == 1)
+        if (auto line = rewrite(refs[0], rule, f, indent)) return *line;
+    return instance(rule, refs, f, indent);
+}
+
+std::optional<int> BinaryProofWriter::descend(int line, LayoutId target, FormulaId f, int indent,
+                                              std::vector<int>& lines) {
+    // Path of ^ children from the line's layout down to the wanted subtree
+    std::vector<LayoutId> path;
+    auto search = [&](auto& self, LayoutId l) -> bool {
+        if (!formulas.is(formulaOf(l), Connective::And)) return false;
+        for (LayoutId child : formulas.layout(l).operands) {
+            path.push_back(child);
+            if (child == target || (target == NoLayout && formulaOf(child) == f) || self(self, child)) return true;
+            path.pop_back();
+        }
+        return false;
+    };
+    if (!search(search, layoutOf(line))) return std::nullopt;
+
+    for (LayoutId child : path) {
+        if (auto held = lineWith(child)) {
+            line = *held;
+            continue;
+        }
+        line = emit(child, "S", {line}, indent);
+        lines.push_back(line);
+    }
+    return line;
+}
+
+std::optional<int> BinaryProofWriter::assemble(LayoutId target, std::vector<int>& lines, int indent) {
+    if (auto held = lineWith(target)) return held;
+    for (size_t i = 0, n = lines.size(); i < n; ++i)
+        if (auto found = descend(lines[i], target, NoFormula, indent, lines)) return found;
+
+    FormulaId f = formulaOf(target);
+    if (!formulas.is(f, Connective::And)) {
+        // The same formula grouped otherwise
+        std::optional<int> held = lineHolding(f);
+        for (size_t i = 0, n = lines.size(); !held && i < n; ++i) held = descend(lines[i], NoLayout, f, indent, lines);
+        if (!held) return std::nullopt;
+        return conform(*held, target, indent);
+    }
+
+    LayoutId left = formulas.layout(target).operands[0], right = formulas.layout(target).operands[1];
+    auto a = assemble(left, lines, indent);
+    auto b = a ? assemble(right, lines, indent) : std::nullopt;
+    if (!b) return std::nullopt;
+    int line = emit(target, "ADJ", ordered(*a, *b), indent);
+    lines.push_back(line);
+    return line;
+}
+
+int BinaryProofWriter::conform(int line, LayoutId target, int indent) {
+    if (layoutOf(line) == target) return line;
+    if (auto held = lineWith(target)) return *held;
+
+    FormulaId f = formulaOf(target);
+    std::vector<LayoutId> had = formulas.layout(layoutOf(line)).operands; // copied: emit() interns
+    std::vector<LayoutId> wants = formulas.layout(target).operands;
+    int inner = indent + 1;
+
+    if (formulas.is(f, Connective::And)) {
+        std::vector<int> lines = {line};
+        return assemble(target, lines, indent).value_or(line);
+    }
+    if (formulas.is(f, Connective::Or)) return disjunctionAs(line, target, {}, indent);
+    if (formulas.is(f, Connective::Not)) {
+        // Show ~φ', φ' :AS, φ' regrouped as φ, ID against ~φ
+        open(target, inner);
+        int assumption = emit(wants[0], "AS", {}, inner);
+        int regrouped = conform(assumption, had[0], inner);
+        close();
+        return emit(target, "ID", ordered(regrouped, line), indent);
+    }
+    if (formulas.is(f, Connective::Implies)) {
+        // Show φ'->ψ', φ' :AS, regrouped as φ, MP, ψ regrouped as ψ', CD
+        open(target, inner);
+        int assumption = emit(wants[0], "AS", {}, inner);
+        int fact = conform(assumption, had[0], inner);
+        int detached = emit(had[1], "MP", ordered(fact, line), inner);
+        int result = conform(detached, wants[1], inner);
+        close();
+        return emit(target, "CD", {result}, indent);
+    }
+    return line; // a biconditional or quantifier regrouped inside: left as found
+}
+
+int BinaryProofWriter::simplify(int line, FormulaId f, int indent) {
+    std::vector<int> lines = {line};
+    if (auto found = descend(line, NoLayout, f, indent, lines)) return *found;
+    LayoutId target = compose(f, {layoutOf(line)});
+    if (auto found = assemble(target, lines, indent)) return *found;
+    return emit(target, "S", {line}, indent);
+}
+
+int BinaryProofWriter::adjoin(const std::vector<int>& refs, FormulaId f, int indent) {
+    LayoutId a = layoutOf(refs[0]), b = layoutOf(refs[1]);
+    LayoutId joined = formulas.join(Connective::And, a, b);
+    LayoutId swapped = formulas.join(Connective::And, b, a);
+    if (compose(f, {}) == swapped) joined = swapped; // as the Show lines or earlier lines have it
+    if (formulaOf(joined) != f) return instance("ADJ", refs, f, indent);
+    return emit(joined, "ADJ", refs, indent);
+}
+
+int BinaryProofWriter::eliminate(const std::vector<int>& refs, FormulaId f, int indent) {
+    for (int o = 0; o < 2; ++o) {
+        int disjunction = refs[o], negated = refs[1 - o];
+        FormulaId d = formulaOf(layoutOf(disjunction)), n = formulaOf(layoutOf(negated));
+        if (!formulas.is(d, Connective::Or) || !formulas.is(n, Connective::Not)) continue;
+
+        FormulaId dropped = formulas.get(n).operands[0];
+        std::vector<LayoutId> sides = formulas.layout(layoutOf(disjunction)).operands;
+        for (int side = 0; side < 2; ++side) {
+            LayoutId gone = sides[side], kept = sides[1 - side];
+            if (formulaOf(gone) != dropped || formulaOf(kept) != f) continue;
+            int denied = conform(negated, negation(gone), indent);
+            return emit(kept, "MTP", ordered(disjunction, denied), indent);
+        }
+        if (auto line = refute(disjunction, negated, dropped, f, indent)) return *line;
+    }
+    return instance("MTP", refs, f, indent);
+}
+
+int BinaryProofWriter::detach(const std::vector<int>& refs, FormulaId f, int indent) {
+    for (int o = 0; o < 2; ++o) {
+        int fact = refs[1 - o];
+        LayoutId implication = layoutOf(refs[o]);
+        if (!formulas.is(formulaOf(implication), Connective::Implies)) continue;
+        LayoutId antecedent = formulas.layout(implication).operands[0];
+        LayoutId consequent = formulas.layout(implication).operands[1];
+        if (formulaOf(antecedent) != formulaOf(layoutOf(fact)) || formulaOf(consequent) != f) continue;
+
+        fact = conform(fact, antecedent, indent);
+        return emit(consequent, "MP", ordered(fact, refs[o]), indent);
+    }
+    return instance("MP", refs, f, indent);
+}
+
+// An equivalence the solver applied modulo AC, or to several operands of an
+// n-ary ^/v at once, as the shortest chain of single rewrites
+std::optional<int> BinaryProofWriter::rewrite(int line, const std::string& rule, FormulaId f, int indent) {
+    constexpr int MaxSteps = 4;
+    constexpr size_t MaxLayouts = 4096;
+
+    LayoutId preferred = compose(f, {layoutOf(line)});
+    std::vector<std::pair<LayoutId, size_t>> reached = {{layoutOf(line), 0}}; // layout, index it came from
+    std::unordered_set<LayoutId> known = {layoutOf(line)};
+    std::vector<LayoutId> next;
+
+    size_t begin = 0;
+    for (int steps = 0; steps < MaxSteps && begin < reached.size() && reached.size() < MaxLayouts; ++steps) {
+        size_t end = reached.size();
+        std::optional<size_t> hit;
+        for (size_t k = begin; k < end && reached.size() < MaxLayouts; ++k) {
+            next.clear();
+            carnapRewrites(formulas, rule, reached[k].first, next);
+            for (LayoutId r : next) {
+                if (!known.insert(r).second) continue;
+                reached.emplace_back(r, k);
+                if (formulaOf(r) == f && (!hit || r == preferred)) hit = reached.size() - 1;
+            }
+        }
+        if (hit) {
+            std::vector<LayoutId> chain;
+            for (size_t k = *hit; k != 0; k = reached[k].second) chain.push_back(reached[k].first);
+            for (size_t k = chain.size(); k-- > 0;) line = emit(chain[k], rule, {line}, indent);
+            return line;
+        }
+        begin = end;
+    }
+
+    // Otherwise the cited line is regrouped as the result rewritten back
+    std::string inverse = rule == "DNE" ? "DNI" : rule == "DNI" ? "DNE" : rule;
+    next.clear();
+    carnapRewrites(formulas, inverse, preferred, next);
+    FormulaId cited = formulaOf(layoutOf(line));
+    for (LayoutId r : next) {
+        if (formulaOf(r) != cited) continue;
+        int regrouped = conform(line, r, indent);
+        if (layoutOf(regrouped) == r) return emit(preferred, rule, {regrouped}, indent);
+    }
+    return std::nullopt;
+}
+
+// A rule without a binary special case: its result composed from the cited
+// lines, which are regrouped after one of them when they disagree
+int BinaryProofWriter::instance(const std::string& rule, const std::vector<int>& refs, FormulaId f, int indent) {
+    std::vector<LayoutId> cited;
+    for (int ref : refs) cited.push_back(layoutOf(ref));
+    LayoutId result = compose(f, cited);
+    if (carnapStep(formulas, rule, cited, result)) return emit(result, rule, refs, indent);
+
+    for (size_t a = 0; a < refs.size(); ++a) {
+        std::vector<LayoutId> regrouped;
+        for (size_t j = 0; j < refs.size(); ++j)
+            regrouped.push_back(j == a ? cited[a] : compose(formulaOf(cited[j]), {cited[a]}));
+        LayoutId r = compose(f, regrouped);
+        if (!carnapStep(formulas, rule, regrouped, r)) continue;
+
+        std::vector<int> conformed = refs;
+        for (size_t j = 0; j < refs.size(); ++j) conformed[j] = conform(refs[j], regrouped[j], indent);
+        return emit(r, rule, conformed, indent);
+    }
+    return emit(result, rule, refs, indent);
+}
+
+// MTP with a disjunct nested below the cited disjunction's children
+std::optional<int> BinaryProofWriter::refute(int disjunction, int negation, FormulaId dropped, FormulaId f,
+                                             int indent) {
+    LayoutId result = compose(f, {layoutOf(disjunction)});
+
+    // Every disjunct of the cited line must be dropped or one of the result's
+    std::vector<std::pair<LayoutId, std::vector<LayoutId>>> cited, kept;
+    std::vector<LayoutId> path;
+    disjuncts(formulas, layoutOf(disjunction), path, cited);
+    disjuncts(formulas, result, path, kept);
+    for (const auto& [leaf, ancestors] : cited) {
+        FormulaId z = formulaOf(leaf);
+        bool covered = z == dropped || std::any_of(kept.begin(), kept.end(), [&](const auto& k) {
+            return formulaOf(k.first) == z;
+        });
+        if (!covered) return std::nullopt;
+    }
+    return disjunctionAs(disjunction, result, {{dropped, negation}}, indent);
+}
+
+// The disjunction on line, laid out as target, by ID:
+//   Show: target
+//   ~target :AS
+//   ... each disjunct Z of target refuted: Show ~Z, Z :AS, ADD up to target, ~Z :ID
+//   ... line taken apart by MTP down to a refuted disjunct
+//   target :ID
+int BinaryProofWriter::disjunctionAs(int line, LayoutId target, Negations negations, int indent) {
+    int inner = indent + 1;
+    open(target, inner);
+    int assumption = emit(negation(target), "AS", {}, inner);
+
+    std::vector<std::pair<LayoutId, std::vector<LayoutId>>> kept;
+    std::vector<LayoutId> path;
+    disjuncts(formulas, target, path, kept);
+    for (const auto& [leaf, ancestors] : kept) {
+        FormulaId z = formulaOf(leaf);
+        if (negations.count(z)) continue;
+        LayoutId negated = negation(leaf);
+        open(negated, inner + 1);
+        int added = emit(leaf, "AS", {}, inner + 1);
+        for (size_t k = ancestors.size(); k-- > 0;) added = emit(ancestors[k], "ADD", {added}, inner + 1);
+        close();
+        negations[z] = emit(negated, "ID", ordered(assumption, added), inner);
+    }
+
+    auto [a, b] = takeApart(line, negations, inner);
+    close();
+    return emit(target, "ID", ordered(a, b), indent);
+}
+
+// A line negating l exactly, from the one negations holds for its formula
+int BinaryProofWriter::negationOf(LayoutId l, Negations& negations, int indent) {
+    return conform(negations.at(formulaOf(l)), negation(l), indent);
+}
+
+// MTP down the disjunction on line until a disjunct meets its negation; a
+// side with no negation yet is refuted in a subproof of its own
+std::pair<int, int> BinaryProofWriter::takeApart(int line, Negations& negations, int indent) {
+    while (true) {
+        LayoutId l = layoutOf(line);
+        if (!formulas.is(formulaOf(l), Connective::Or)) return {line, negationOf(l, negations, indent)};
+
+        LayoutId left = formulas.layout(l).operands[0], right = formulas.layout(l).operands[1];
+        if (negations.count(formulaOf(right))) {
+            line = emit(left, "MTP", ordered(line, negationOf(right, negations, indent)), indent);
+        } else if (negations.count(formulaOf(left))) {
+            line = emit(right, "MTP", ordered(line, negationOf(left, negations, indent)), indent);
+        } else {
+            LayoutId negated = negation(right);
+            open(negated, indent + 1);
+            int assumption = emit(right, "AS", {}, indent + 1);
+            Negations scoped = negations; // lines found in the subproof close with it
+            auto [a, b] = takeApart(assumption, scoped, indent + 1);
+            close();
+            negations[formulaOf(right)] = emit(negated, "ID", ordered(a, b), indent);
+        }
+    }
+}
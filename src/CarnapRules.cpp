@@ -0,0 +1,217 @@
+#include "CarnapRules.h"
+#include <algorithm>
+#include <numeric>
+
+namespace {
+
+struct Schema {
+    std::string rule;
+    std::vector<LayoutId> premises;
+    LayoutId conclusion;
+};
+
+// An equivalence lhs <=> rhs, used left to right (forward), right to left
+// (backward) or both
+struct Law {
+    std::string rule;
+    LayoutId lhs;
+    LayoutId rhs;
+    bool forward;
+    bool backward;
+};
+
+struct Table {
+    FormulaStore schema;
+    std::vector<Schema> schemata;
+    std::vector<Law> laws;
+
+    Table() {
+        auto parse = [&](const char* text) { return *schema.parseLayout(text); };
+        auto rule = [&](const char* name, std::vector<const char*> premises, const char* conclusion) {
+            Schema s{name, {}, parse(conclusion)};
+            for (const char* p : premises) s.premises.push_back(parse(p));
+            schemata.push_back(std::move(s));
+        };
+        auto law = [&](const char* name, const char* lhs, const char* rhs, bool forward, bool backward) {
+            laws.push_back({name, parse(lhs), parse(rhs), forward, backward});
+        };
+
+        rule("MP", {"φ->ψ", "φ"}, "ψ");
+        rule("MT", {"φ->ψ", "~ψ"}, "~φ");
+        rule("S", {"φ^ψ"}, "φ");
+        rule("S", {"φ^ψ"}, "ψ");
+        rule("ADJ", {"φ", "ψ"}, "φ^ψ");
+        rule("MTP", {"φvψ", "~φ"}, "ψ");
+        rule("MTP", {"φvψ", "~ψ"}, "φ");
+        rule("ADD", {"φ"}, "φvψ");
+        rule("ADD", {"φ"}, "ψvφ");
+        rule("BC", {"φ<->ψ", "ψ->φ"}, "φ->ψ");
+        rule("BC", {"φ<->ψ", "φ->ψ"}, "ψ->φ");
+        rule("CB", {"φ->ψ", "ψ->φ"}, "φ<->ψ");
+
+        rule("D-HS", {"φ->ψ", "ψ->χ"}, "φ->χ");
+        rule("D-MCC", {"φ"}, "ψ->φ");
+        rule("D-MCNA", {"~φ"}, "φ->ψ");
+        rule("D-CPO", {"φ->ψ"}, "~ψ->~φ");
+        rule("D-CPT", {"~φ->~ψ"}, "ψ->φ");
+        rule("D-DIL", {"φ->ψ", "~φ->ψ"}, "ψ");
+        rule("D-CM", {"~φ->φ"}, "φ");
+        rule("D-EFQ", {"φ", "~φ"}, "ψ");
+        rule("D-PBC", {"φ->χ", "φvψ", "ψ->χ"}, "χ");
+
+        law("DNE", "~~φ", "φ", true, false);
+        law("DNI", "~~φ", "φ", false, true);
+        law("D-DMO", "~(φvψ)", "~φ^~ψ", true, true);
+        law("D-DMT", "~(φ^ψ)", "~φv~ψ", true, true);
+        law("D-SDMO", "φ^ψ", "~(~φv~ψ)", true, true);
+        law("D-SDMT", "φvψ", "~(~φ^~ψ)", true, true);
+        law("D-NC", "~(φ->ψ)", "φ^~ψ", true, true);
+    }
+};
+
+// Built once; read-only afterwards, so checkers on several threads share it
+const Table& table() {
+    static const Table t;
+    return t;
+}
+
+// Metavariable -> layout it stands for
+using Binds = std::vector<std::pair<FormulaId, LayoutId>>;
+
+// Matches pattern against l node for node, extending binds
+bool match(const FormulaStore& schema, LayoutId pattern, const FormulaStore& fs, LayoutId l, Binds& binds) {
+    const Layout& p = schema.layout(pattern);
+    if (schema.is(p.formula, Connective::Atom)) {
+        for (const auto& [var, bound] : binds)
+            if (var == p.formula) return bound == l;
+        binds.emplace_back(p.formula, l);
+        return true;
+    }
+
+    const Layout& node = fs.layout(l);
+    if (fs.get(node.formula).op != schema.get(p.formula).op || node.operands.size() != p.operands.size())
+        return false;
+    for (size_t i = 0; i < p.operands.size(); ++i)
+        if (!match(schema, p.operands[i], fs, node.operands[i], binds)) return false;
+    return true;
+}
+
+// Both sides of a law under the same binds
+bool matchBoth(const Law& law, bool forward, const FormulaStore& fs, LayoutId from, LayoutId to) {
+    const FormulaStore& schema = table().schema;
+    Binds binds;
+    return match(schema, forward ? law.lhs : law.rhs, fs, from, binds) &&
+           match(schema, forward ? law.rhs : law.lhs, fs, to, binds);
+}
+
+LayoutId instantiate(const FormulaStore& schema, LayoutId pattern, FormulaStore& fs, const Binds& binds) {
+    const Layout& p = schema.layout(pattern);
+    Connective op = schema.get(p.formula).op;
+    if (op == Connective::Atom) {
+        for (const auto& [var, bound] : binds)
+            if (var == p.formula) return bound;
+        return NoLayout;
+    }
+    if (op == Connective::Not) {
+        LayoutId inner = instantiate(schema, p.operands[0], fs, binds);
+        return fs.arrange(fs.negate(fs.layout(inner).formula), {inner});
+    }
+    LayoutId lhs = instantiate(schema, p.operands[0], fs, binds);
+    LayoutId rhs = instantiate(schema, p.operands[1], fs, binds);
+    return fs.join(op, lhs, rhs);
+}
+
+// l with operand i replaced
+LayoutId replaced(FormulaStore& fs, LayoutId l, size_t i, LayoutId operand) {
+    std::vector<LayoutId> operands = fs.layout(l).operands; // copied: interning may move layouts
+    FormulaId f = fs.layout(l).formula;
+    Connective op = fs.get(f).op;
+    operands[i] = operand;
+    if (op == Connective::And || op == Connective::Or || op == Connective::Implies || op == Connective::Iff)
+        return fs.join(op, operands[0], operands[1]);
+    return fs.arrange(fs.withOperand(f, i, fs.layout(operand).formula), operands);
+}
+
+// `to` is `from` with one subtree rewritten by law
+bool rewritesTo(const FormulaStore& fs, const Law& law, LayoutId from, LayoutId to) {
+    if (law.forward && matchBoth(law, true, fs, from, to)) return true;
+    if (law.backward && matchBoth(law, false, fs, from, to)) return true;
+
+    // Otherwise the same node on top, differing in exactly one operand
+    const Layout& a = fs.layout(from);
+    const Layout& b = fs.layout(to);
+    const Formula& fa = fs.get(a.formula);
+    const Formula& fb = fs.get(b.formula);
+    if (fa.op != fb.op || fa.terms != fb.terms || a.operands.size() != b.operands.size()) return false;
+
+    std::optional<size_t> differing;
+    for (size_t i = 0; i < a.operands.size(); ++i) {
+        if (a.operands[i] == b.operands[i]) continue;
+        if (differing) return false;
+        differing = i;
+    }
+    return differing && rewritesTo(fs, law, a.operands[*differing], b.operands[*differing]);
+}
+
+void rewrites(FormulaStore& fs, const Law& law, LayoutId from, std::vector<LayoutId>& out) {
+    const FormulaStore& schema = table().schema;
+    for (bool forward : {true, false}) {
+        Binds binds;
+        if ((forward ? law.forward : law.backward) && match(schema, forward ? law.lhs : law.rhs, fs, from, binds))
+            out.push_back(instantiate(schema, forward ? law.rhs : law.lhs, fs, binds));
+    }
+
+    size_t n = fs.layout(from).operands.size();
+    for (size_t i = 0; i < n; ++i) {
+        size_t first = out.size();
+        rewrites(fs, law, fs.layout(from).operands[i], out);
+        for (size_t k = first; k < out.size(); ++k) out[k] = replaced(fs, from, i, out[k]);
+    }
+}
+
+} // namespace
+
+std::optional<size_t> carnapArity(const std::string& rule) {
+    for (const Schema& s : table().schemata)
+        if (s.rule == rule) return s.premises.size();
+    for (const Law& law : table().laws)
+        if (law.rule == rule) return 1;
+    return std::nullopt;
+}
+
+bool carnapStep(const FormulaStore& fs, const std::string& rule,
+                const std::vector<LayoutId>& cited, LayoutId result) {
+    const Table& t = table();
+
+    std::vector<size_t> order(cited.size());
+    for (const Schema& s : t.schemata) {
+        if (s.rule != rule || s.premises.size() != cited.size()) continue;
+
+        std::iota(order.begin(), order.end(), 0);
+        do {
+            Binds binds;
+            bool matched = true;
+            for (size_t k = 0; matched && k < order.size(); ++k)
+                matched = match(t.schema, s.premises[k], fs, cited[order[k]], binds);
+            if (matched && match(t.schema, s.conclusion, fs, result, binds)) return true;
+        } while (std::next_permutation(order.begin(), order.end()));
+    }
+
+    if (cited.size() != 1) return false;
+    for (const Law& law : t.laws) {
+        if (law.rule != rule) continue;
+        if (rewritesTo(fs, law, cited[0], result)) return true;
+
+        // A two-way law may restate an instance of its own biconditional
+        if (!law.forward || !law.backward || cited[0] != result) continue;
+        if (!fs.is(fs.layout(result).formula, Connective::Iff)) continue;
+        LayoutId lhs = fs.layout(result).operands[0], rhs = fs.layout(result).operands[1];
+        if (matchBoth(law, true, fs, lhs, rhs) || matchBoth(law, true, fs, rhs, lhs)) return true;
+    }
+    return false;
+}
+
+void carnapRewrites(FormulaStore& fs, const std::string& rule, LayoutId from, std::vector<LayoutId>& out) {
+    for (const Law& law : table().laws)
+        if (law.rule == rule) rewrites(fs, law, from, out);
+}
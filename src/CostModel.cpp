@@ -0,0 +1,166 @@
+#include "CostModel.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <unordered_set>
+
+namespace {
+
+// Fitted without negative weights to the solve times of the test suite,
+// bench/pathological.txt and random problems, in log(1 + ms)
+constexpr std::array<double, CostModel::FeatureCount> BuiltInWeights = {
+    //  bias  premises  ln(1+atoms)  ~     ^/v   ->    <->   Q     depth  D-PBC  ->goal
+        0.00, 0.00,     0.82,        0.00, 0.06, 0.00, 0.20, 0.00, 0.64,  0.00,  0.00
+};
+
+constexpr double PriorStrength = 4.0; // the built-in weights count as this many samples
+constexpr double MaxLogMs = 20.0;     // clamp before exp(); e^20 ms is about 5.6 days
+constexpr int MaxSweeps = 1000;       // of refit()'s coordinate descent
+
+struct Walker {
+    const FormulaStore& store;
+    ProblemFeatures& features;
+    std::unordered_set<std::string> symbols;
+
+    // Returns the number of -> on the deepest path below f
+    int visit(FormulaId f) {
+        const Formula& node = store.get(f);
+        switch (node.op) {
+            case Connective::Atom: symbols.insert(node.name); break;
+            case Connective::Predicate: symbols.insert(node.name + "/" + std::to_string(node.terms.size())); break;
+            case Connective::Not: features.negations++; break;
+            case Connective::And:
+            case Connective::Or: features.junctions++; break;
+            case Connective::Implies: features.implications++; break;
+            case Connective::Iff: features.biconditionals++; break;
+            case Connective::ForAll:
+            case Connective::Exists: features.quantifiers++; break;
+        }
+
+        int depth = 0;
+        for (FormulaId operand : node.operands) depth = std::max(depth, visit(operand));
+        return depth + (node.op == Connective::Implies ? 1 : 0);
+    }
+};
+
+} // namespace
+
+ProblemFeatures extractFeatures(const FormulaStore& store, const std::vector<FormulaId>& premises, FormulaId goal) {
+    ProblemFeatures features;
+    features.premises = static_cast<int>(premises.size());
+    features.conditionalGoal = store.is(goal, Connective::Implies);
+
+    Walker walker{store, features, {}};
+    bool disjunction = false;
+    int conditionals = 0;
+    for (FormulaId p : premises) {
+        features.implicationDepth = std::max(features.implicationDepth, walker.visit(p));
+        disjunction = disjunction || store.is(p, Connective::Or);
+        conditionals += store.is(p, Connective::Implies) ? 1 : 0;
+    }
+    features.implicationDepth = std::max(features.implicationDepth, walker.visit(goal));
+
+    features.atoms = static_cast<int>(walker.symbols.size());
+    features.threePremiseRules = disjunction && conditionals >= 2;
+    return features;
+}
+
+CostModel::CostModel() {
+    std::copy(BuiltInWeights.begin(), BuiltInWeights.end(), weights.begin());
+}
+
+CostModel::Vector CostModel::vectorize(const ProblemFeatures& f) {
+    return {1.0,
+            static_cast<double>(f.premises),
+            std::log1p(f.atoms),
+            static_cast<double>(f.negations),
+            static_cast<double>(f.junctions),
+            static_cast<double>(f.implications),
+            static_cast<double>(f.biconditionals),
+            static_cast<double>(f.quantifiers),
+            static_cast<double>(f.implicationDepth),
+            f.threePremiseRules ? 1.0 : 0.0,
+            f.conditionalGoal ? 1.0 : 0.0};
+}
+
+double CostModel::predictMs(const ProblemFeatures& features) const {
+    Vector x = vectorize(features);
+    double y = 0.0;
+    for (size_t i = 0; i < FeatureCount; ++i) y += weights[i] * x[i];
+    return std::expm1(std::clamp(y, 0.0, MaxLogMs));
+}
+
+void CostModel::observe(const ProblemFeatures& features, double ms) {
+    Vector x = vectorize(features);
+    double y = std::log1p(std::max(0.0, ms));
+    for (size_t i = 0; i < FeatureCount; ++i) {
+        for (size_t j = 0; j < FeatureCount; ++j) gram[i][j] += x[i] * x[j];
+        moments[i] += x[i] * y;
+    }
+    sampleCount++;
+    refit();
+}
+
+// Solves (G + kI) w = m + k w0 for w >= 0 by projected Gauss-Seidel: each
+// weight in turn takes its best value given the others, clamped at zero.
+// The ridge term keeps the system positive definite, so the sweeps converge.
+void CostModel::refit() {
+    std::array<Vector, FeatureCount> a;
+    Vector b;
+    for (size_t i = 0; i < FeatureCount; ++i) {
+        for (size_t j = 0; j < FeatureCount; ++j) a[i][j] = gram[i][j] + (i == j ? PriorStrength : 0.0);
+        b[i] = moments[i] + PriorStrength * BuiltInWeights[i];
+    }
+
+    for (int sweep = 0; sweep < MaxSweeps; ++sweep) {
+        double change = 0.0;
+        for (size_t i = 0; i < FeatureCount; ++i) {
+            double sum = b[i];
+            for (size_t j = 0; j < FeatureCount; ++j)
+                if (j != i) sum -= a[i][j] * weights[j];
+            double w = std::max(0.0, sum / a[i][i]);
+            change = std::max(change, std::abs(w - weights[i]));
+            weights[i] = w;
+        }
+        if (change < 1e-12) break;
+    }
+}
+
+// Model file: "samples N", then one "x_i y_i g_i0 ... g_in" line per feature
+// holding the sums above, so later runs keep calibrating the same fit
+bool CostModel::load(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) return false;
+
+    std::string tag;
+    size_t count = 0;
+    if (!(in >> tag >> count) || tag != "samples") return false;
+
+    std::array<Vector, FeatureCount> g{};
+    Vector m{};
+    for (size_t i = 0; i < FeatureCount; ++i) {
+        if (!(in >> m[i])) return false;
+        for (size_t j = 0; j < FeatureCount; ++j)
+            if (!(in >> g[i][j])) return false;
+    }
+
+    gram = g;
+    moments = m;
+    sampleCount = count;
+    refit();
+    return true;
+}
+
+bool CostModel::save(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out) return false;
+
+    out.precision(17);
+    out << "samples " << sampleCount << "\n";
+    for (size_t i = 0; i < FeatureCount; ++i) {
+        out << moments[i];
+        for (size_t j = 0; j < FeatureCount; ++j) out << " " << gram[i][j];
+        out << "\n";
+    }
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,297 @@
+#include "EGraph.h"
+#include <algorithm>
+#include <cstddef>
+
+namespace {
+
+// Hashcons slots: a node index, or one of these
+constexpr uint32_t Empty = UINT32_MAX;
+constexpr uint32_t Erased = UINT32_MAX - 1;
+
+}
+
+size_t EGraph::hash(Connective op, int symbol, const ClassId* children, size_t arity) const {
+    size_t h = static_cast<size_t>(op) * 31 + static_cast<size_t>(symbol);
+    for (size_t k = 0; k < arity; ++k) h = h * 1000003 ^ children[k];
+    return h ^ (h >> 17);
+}
+
+bool EGraph::same(uint32_t node, Connective op, int symbol, const ClassId* children, size_t arity) const {
+    const Node& n = nodes[node];
+    return n.op == op && n.symbol == symbol && n.arity == arity &&
+           std::equal(children, children + arity, childPool.begin() + n.children);
+}
+
+uint32_t EGraph::lookup(Connective op, int symbol, const ClassId* children, size_t arity) const {
+    if (table.empty()) return None;
+    size_t mask = table.size() - 1;
+    for (size_t slot = hash(op, symbol, children, arity) & mask;; slot = (slot + 1) & mask) {
+        uint32_t node = table[slot];
+        if (node == Empty) return None;
+        if (node != Erased && same(node, op, symbol, children, arity)) return node;
+    }
+}
+
+// Places a node known not to be in the table, growing it past half full
+void EGraph::insert(uint32_t node) {
+    if ((tableUsed + 1) * 2 > table.size()) {
+        size_t live = 0;
+        for (uint32_t slot : table) live += slot != Empty && slot != Erased;
+        rehash(table.empty() ? 64 : (live + 1) * 4 > table.size() ? table.size() * 2 : table.size());
+    }
+    const Node& n = nodes[node];
+    size_t mask = table.size() - 1;
+    size_t slot = hash(n.op, n.symbol, childPool.data() + n.children, n.arity) & mask;
+    while (table[slot] != Empty && table[slot] != Erased) slot = (slot + 1) & mask;
+    if (table[slot] == Empty) ++tableUsed;
+    table[slot] = node;
+}
+
+// Drops a node under its stored operands; a node congruent to another was
+// never re-inserted, and is not found
+void EGraph::erase(uint32_t node) {
+    if (table.empty()) return;
+    const Node& n = nodes[node];
+    size_t mask = table.size() - 1;
+    for (size_t slot = hash(n.op, n.symbol, childPool.data() + n.children, n.arity) & mask;
+         table[slot] != Empty; slot = (slot + 1) & mask) {
+        if (table[slot] == node) {
+            table[slot] = Erased;
+            return;
+        }
+    }
+}
+
+void EGraph::rehash(size_t slots) {
+    spareTable.assign(slots, Empty);
+    size_t mask = slots - 1;
+    tableUsed = 0;
+    for (uint32_t node : table) {
+        if (node == Empty || node == Erased) continue;
+        const Node& n = nodes[node];
+        size_t slot = hash(n.op, n.symbol, childPool.data() + n.children, n.arity) & mask;
+        while (spareTable[slot] != Empty) slot = (slot + 1) & mask;
+        spareTable[slot] = node;
+        ++tableUsed;
+    }
+    table.swap(spareTable);
+}
+
+void EGraph::append(List& list, std::vector<uint32_t>& next, uint32_t entry) {
+    next[entry] = None;
+    if (list.tail == None) list.head = entry;
+    else next[list.tail] = entry;
+    list.tail = entry;
+}
+
+void EGraph::splice(List& into, List& from, std::vector<uint32_t>& next) {
+    if (from.head == None) return;
+    if (into.head == None) into.head = from.head;
+    else next[into.tail] = from.head;
+    into.tail = from.tail;
+    from = List();
+}
+
+EGraph::ClassId EGraph::find(ClassId c) const {
+    while (parent[c] != c) c = parent[c];
+    return c;
+}
+
+// Operands by their current class; ^/v operands in class order
+void EGraph::canonicalize(ClassId* children, size_t arity, Connective op) const {
+    for (size_t k = 0; k < arity; ++k) children[k] = find(children[k]);
+    if (op == Connective::And || op == Connective::Or) std::sort(children, children + arity);
+}
+
+EGraph::ClassId EGraph::addNode(Connective op, int symbol, const ClassId* children, size_t arity) {
+    ++work;
+    key.assign(children, children + arity);
+    canonicalize(key.data(), arity, op);
+    uint32_t known = lookup(op, symbol, key.data(), arity);
+    if (known != None) return find(nodeClass[known]);
+
+    ClassId c = static_cast<ClassId>(parent.size());
+    auto index = static_cast<uint32_t>(nodes.size());
+    nodes.push_back({op, symbol, static_cast<uint32_t>(childPool.size()), static_cast<uint32_t>(arity)});
+    childPool.insert(childPool.end(), key.begin(), key.end());
+    parent.push_back(c);
+    nodeClass.push_back(c);
+    classSize.push_back(1);
+    classNodes.emplace_back();
+    members.emplace_back();
+    parents.emplace_back();
+    nextNode.push_back(None);
+    append(classNodes[c], nextNode, index);
+    for (ClassId child : key) {
+        parentNode.push_back(index);
+        nextParent.push_back(None);
+        append(parents[child], nextParent, static_cast<uint32_t>(parentNode.size() - 1));
+    }
+    insert(index);
+    pending.push_back(index);
+    return c;
+}
+
+// Operand classes are pushed on a shared stack, so the recursion through
+// subformulas reuses one buffer
+EGraph::ClassId EGraph::add(const FormulaStore& store, FormulaId f) {
+    if (static_cast<size_t>(f) < formulaClass.size() && formulaClass[f] != None) return find(formulaClass[f]);
+
+    const Formula& formula = store.get(f);
+    int symbol = 0;
+    if (formula.op == Connective::Atom || formula.op == Connective::Predicate) symbol = f;
+    if (formula.op == Connective::ForAll || formula.op == Connective::Exists) symbol = formula.terms[0];
+    size_t base = operands.size();
+    for (FormulaId operand : formula.operands) {
+        ClassId child = add(store, operand);
+        operands.push_back(child);
+    }
+
+    ClassId c = addNode(formula.op, symbol, operands.data() + base, operands.size() - base);
+    operands.resize(base);
+    if (static_cast<size_t>(f) >= formulaClass.size()) formulaClass.resize(static_cast<size_t>(f) + 1, None);
+    formulaClass[f] = c;
+    memberFormula.push_back(f);
+    nextMember.push_back(None);
+    append(members[c], nextMember, static_cast<uint32_t>(memberFormula.size() - 1));
+    return c;
+}
+
+EGraph::ClassId EGraph::negation(ClassId c) {
+    return addNode(Connective::Not, 0, &c, 1);
+}
+
+// Union by node count; the smaller class's nodes, members and parents move
+// over. The merged class's parents may now match a law or be congruent to
+// another node, so they are queued for both.
+bool EGraph::merge(ClassId a, ClassId b) {
+    a = find(a);
+    b = find(b);
+    if (a == b) return false;
+    if (classSize[a] < classSize[b]) std::swap(a, b);
+
+    parent[b] = a;
+    classSize[a] += classSize[b];
+    splice(classNodes[a], classNodes[b], nextNode);
+    splice(members[a], members[b], nextMember);
+    splice(parents[a], parents[b], nextParent);
+
+    for (uint32_t e = parents[a].head; e != None; e = nextParent[e]) pending.push_back(parentNode[e]);
+    repair.push_back(a);
+    return true;
+}
+
+// Restores congruence: parents of merged classes are re-canonicalized, and
+// any that now coincide with another node join its class
+void EGraph::rebuild() {
+    while (!repair.empty()) {
+        ClassId c = find(repair.back());
+        repair.pop_back();
+
+        users.clear();
+        for (uint32_t e = parents[c].head; e != None; e = nextParent[e]) users.push_back(parentNode[e]);
+        std::sort(users.begin(), users.end());
+        users.erase(std::unique(users.begin(), users.end()), users.end());
+
+        // The deduplicated users take over the front of the list's entries
+        uint32_t e = parents[c].head;
+        for (size_t k = 0; k < users.size(); ++k) {
+            parentNode[e] = users[k];
+            parents[c].tail = e;
+            e = nextParent[e];
+        }
+        if (!users.empty()) nextParent[parents[c].tail] = None;
+
+        for (uint32_t p : users) {
+            erase(p);
+            Node& node = nodes[p];
+            canonicalize(childPool.data() + node.children, node.arity, node.op);
+            uint32_t known = lookup(node.op, node.symbol, childPool.data() + node.children, node.arity);
+            if (known == None) insert(p);
+            else merge(nodeClass[known], nodeClass[p]);
+        }
+    }
+}
+
+void EGraph::classNodesOf(ClassId c, std::vector<uint32_t>& out) const {
+    out.clear();
+    for (uint32_t n = classNodes[c].head; n != None; n = nextNode[n]) out.push_back(n);
+}
+
+// Merges node's class with the rewrite of node by each law that applies:
+//   ~~φ = φ,  ~(φvψ) = ~φ^~ψ,  ~(φ^ψ) = ~φv~ψ,  ~(φ->ψ) = φ^~ψ
+// and an ^/v node with the one that absorbs a same-connective operand.
+// Nodes are copied and operands read by offset: adding a node may move both.
+void EGraph::rewrite(uint32_t i) {
+    const Node node = nodes[i];
+
+    if (node.op == Connective::Not) {
+        classNodesOf(find(childPool[node.children]), nodesOf);
+        for (uint32_t j : nodesOf) {
+            const Node m = nodes[j];
+            if (m.op == Connective::Not) {
+                merge(nodeClass[i], childPool[m.children]);
+            } else if (m.op == Connective::Or || m.op == Connective::And) {
+                built.clear();
+                for (uint32_t k = 0; k < m.arity; ++k) built.push_back(negation(childPool[m.children + k]));
+                Connective dual = m.op == Connective::Or ? Connective::And : Connective::Or;
+                merge(nodeClass[i], addNode(dual, 0, built.data(), built.size()));
+            } else if (m.op == Connective::Implies) {
+                ClassId consequent = negation(childPool[m.children + 1]);
+                ClassId conj[2] = {childPool[m.children], consequent};
+                merge(nodeClass[i], addNode(Connective::And, 0, conj, 2));
+            }
+        }
+    } else if (node.op == Connective::And || node.op == Connective::Or) {
+        for (uint32_t k = 0; k < node.arity; ++k) {
+            classNodesOf(find(childPool[node.children + k]), nodesOf);
+            for (uint32_t j : nodesOf) {
+                const Node m = nodes[j];
+                if (m.op != node.op) continue;
+                built.clear();
+                for (uint32_t o = 0; o < node.arity; ++o)
+                    if (o != k) built.push_back(childPool[node.children + o]);
+                for (uint32_t o = 0; o < m.arity; ++o) built.push_back(childPool[m.children + o]);
+                merge(nodeClass[i], addNode(node.op, 0, built.data(), built.size()));
+            }
+        }
+    }
+}
+
+// Each call does at most StepBudget node lookups; rewrites not reached stay
+// queued for the next call, so a query never stalls the solver. Once the
+// graph is full it stops growing until clear().
+void EGraph::saturate() {
+    work = 0;
+    while (!pending.empty() && !full() && work < StepBudget) {
+        rebuild();
+        batch.clear();
+        batch.swap(pending);
+        std::sort(batch.begin(), batch.end());
+        batch.erase(std::unique(batch.begin(), batch.end()), batch.end());
+
+        size_t done = 0;
+        while (done < batch.size() && !full() && work < StepBudget) rewrite(batch[done++]);
+        pending.insert(pending.end(), batch.begin() + static_cast<std::ptrdiff_t>(done), batch.end());
+    }
+    rebuild();
+}
+
+void EGraph::clear() {
+    *this = EGraph();
+}
+
+const std::vector<FormulaId>& EGraph::equivalents(const FormulaStore& store, FormulaId f) {
+    ClassId c = add(store, f);
+    saturate();
+    found.clear();
+    for (uint32_t e = members[find(c)].head; e != None; e = nextMember[e]) found.push_back(memberFormula[e]);
+    return found;
+}
+
+bool EGraph::equivalent(const FormulaStore& store, FormulaId a, FormulaId b) {
+    ClassId ca = add(store, a);
+    ClassId cb = add(store, b);
+    saturate();
+    return find(ca) == find(cb);
+}
@@ -0,0 +1,193 @@
+#include "EntailmentOracle.h"
+#include <algorithm>
+#include <unordered_set>
+
+void EntailmentOracle::reset(size_t atoms) {
+    // At least one full word, so the six lowest variables need no masking
+    variables = std::clamp<size_t>(atoms, 6, MaxAtoms);
+    width = size_t{1} << (variables - 6);
+    words.clear();
+    offsetOf.clear();
+    assigned = 0;
+
+    savedScopes = 0;
+    folded = 0;
+    untabled = SIZE_MAX;
+    conjunction.assign(width, ~uint64_t{0});
+}
+
+int EntailmentOracle::allocate() {
+    int offset = static_cast<int>(words.size());
+    words.resize(words.size() + width);
+    return offset;
+}
+
+// Variable i is true in assignment a when bit i of a is set. Below six that
+// is a repeating pattern within each word; from six up whole words alternate.
+int EntailmentOracle::variable() {
+    if (assigned >= variables) return NoTable;
+    size_t i = assigned++;
+
+    static constexpr uint64_t Patterns[] = {
+        0xAAAAAAAAAAAAAAAAull, 0xCCCCCCCCCCCCCCCCull, 0xF0F0F0F0F0F0F0F0ull,
+        0xFF00FF00FF00FF00ull, 0xFFFF0000FFFF0000ull, 0xFFFFFFFF00000000ull
+    };
+    int offset = allocate();
+    for (size_t w = 0; w < width; ++w)
+        words[offset + w] = i < 6 ? Patterns[i] : ((w >> (i - 6)) & 1 ? ~uint64_t{0} : 0);
+    return offset;
+}
+
+int EntailmentOracle::table(const FormulaStore& store, FormulaId f) {
+    if (auto it = offsetOf.find(f); it != offsetOf.end()) return it->second;
+
+    const Formula& node = store.get(f);
+    int result = NoTable;
+    switch (node.op) {
+        case Connective::Atom:
+        case Connective::Predicate:
+            result = variable();
+            break;
+
+        case Connective::ForAll:
+        case Connective::Exists:
+            break;
+
+        default: {
+            // Operand tables first: building them may grow the arena
+            std::vector<int> operands;
+            for (FormulaId operand : node.operands) {
+                int t = table(store, operand);
+                if (t == NoTable) break;
+                operands.push_back(t);
+            }
+            if (operands.size() != node.operands.size()) break;
+
+            result = allocate();
+            uint64_t* out = &words[result];
+            const uint64_t* a = &words[operands[0]];
+            switch (node.op) {
+                case Connective::Not:
+                    for (size_t w = 0; w < width; ++w) out[w] = ~a[w];
+                    break;
+                case Connective::Implies: {
+                    const uint64_t* b = &words[operands[1]];
+                    for (size_t w = 0; w < width; ++w) out[w] = ~a[w] | b[w];
+                    break;
+                }
+                case Connective::Iff: {
+                    const uint64_t* b = &words[operands[1]];
+                    for (size_t w = 0; w < width; ++w) out[w] = ~(a[w] ^ b[w]);
+                    break;
+                }
+                default: { // n-ary ^ or v
+                    bool conjunction = node.op == Connective::And;
+                    std::copy(a, a + width, out);
+                    for (size_t k = 1; k < operands.size(); ++k) {
+                        const uint64_t* b = &words[operands[k]];
+                        for (size_t w = 0; w < width; ++w) out[w] = conjunction ? out[w] & b[w] : out[w] | b[w];
+                    }
+                    break;
+                }
+            }
+            break;
+        }
+    }
+
+    offsetOf.emplace(f, result);
+    return result;
+}
+
+// Entailed when no assignment satisfies every premise and falsifies target
+std::optional<bool> EntailmentOracle::entails(const FormulaStore& store, const std::vector<FormulaId>& premises,
+                                              FormulaId target) {
+    int goal = table(store, target);
+    if (goal == NoTable) return std::nullopt;
+
+    scratch.assign(width, ~uint64_t{0});
+    for (FormulaId premise : premises) {
+        int t = table(store, premise);
+        if (t == NoTable) return std::nullopt;
+        for (size_t w = 0; w < width; ++w) scratch[w] &= words[t + w];
+    }
+    return entailedBy(scratch.data(), goal);
+}
+
+bool EntailmentOracle::entailedBy(const uint64_t* premises, int goal) const {
+    for (size_t w = 0; w < width; ++w)
+        if (premises[w] & ~words[goal + w]) return false;
+    return true;
+}
+
+void EntailmentOracle::addPremise(FormulaId premise) {
+    premises.push_back(premise);
+}
+
+void EntailmentOracle::openScope() {
+    // Sibling scopes opened at the same point share one saved conjunction
+    if (scopeStarts.empty() || scopeStarts.back() != premises.size()) scopeStarts.push_back(premises.size());
+}
+
+void EntailmentOracle::truncatePremises(size_t count) {
+    if (count >= premises.size()) return;
+    premises.resize(count);
+    while (!scopeStarts.empty() && scopeStarts.back() > count) scopeStarts.pop_back();
+    savedScopes = std::min(savedScopes, scopeStarts.size());
+    if (folded > count) restoreScope();
+}
+
+void EntailmentOracle::saveScope() {
+    saved.resize((savedScopes + 1) * width);
+    std::copy(conjunction.begin(), conjunction.end(), saved.begin() + savedScopes * width);
+    savedScopes++;
+}
+
+void EntailmentOracle::restoreScope() {
+    if (savedScopes == 0) {
+        conjunction.assign(width, ~uint64_t{0});
+        folded = 0;
+    } else {
+        auto from = saved.begin() + (savedScopes - 1) * width;
+        std::copy(from, from + width, conjunction.begin());
+        folded = scopeStarts[savedScopes - 1];
+    }
+    if (untabled >= folded) untabled = SIZE_MAX;
+}
+
+void EntailmentOracle::fold(const FormulaStore& store) {
+    if (conjunction.empty()) conjunction.assign(width, ~uint64_t{0}); // never reset
+    for (;; ++folded) {
+        if (savedScopes < scopeStarts.size() && scopeStarts[savedScopes] == folded) saveScope();
+        if (folded == premises.size()) break;
+
+        int t = table(store, premises[folded]);
+        if (t == NoTable) untabled = std::min(untabled, folded);
+        else
+            for (size_t w = 0; w < width; ++w) conjunction[w] &= words[t + w];
+    }
+}
+
+std::optional<bool> EntailmentOracle::entailed(const FormulaStore& store, FormulaId target) {
+    int goal = table(store, target);
+    if (goal == NoTable) return std::nullopt;
+
+    fold(store);
+    if (untabled != SIZE_MAX) return std::nullopt;
+    return entailedBy(conjunction.data(), goal);
+}
+
+size_t EntailmentOracle::countAtoms(const FormulaStore& store, const std::vector<FormulaId>& formulas) {
+    std::unordered_set<FormulaId> atoms;
+    std::unordered_set<FormulaId> seen;
+    std::vector<FormulaId> pending(formulas.begin(), formulas.end());
+    while (!pending.empty()) {
+        FormulaId f = pending.back();
+        pending.pop_back();
+        if (!seen.insert(f).second) continue;
+
+        const Formula& node = store.get(f);
+        if (node.op == Connective::Atom || node.op == Connective::Predicate) atoms.insert(f);
+        pending.insert(pending.end(), node.operands.begin(), node.operands.end());
+    }
+    return atoms.size();
+}
@@ -0,0 +1,576 @@
+#include "Formula.h"
+#include <algorithm>
+
+size_t FormulaStore::hash(const Key& key) {
+    size_t h = static_cast<size_t>(key.op) * 31 + std::hash<std::string_view>()(key.name);
+    for (size_t i = 0; i < key.operandCount; ++i) h = h * 1000003 ^ static_cast<size_t>(key.operands[i]);
+    for (size_t i = 0; i < key.termCount; ++i) h = h * 1000003 ^ (static_cast<size_t>(key.terms[i]) + 0x9e3779b9);
+    return h;
+}
+
+FormulaStore::Key FormulaStore::keyOf(const Formula& node) {
+    return {node.op, node.operands.data(), node.operands.size(), node.name, node.terms.data(), node.terms.size()};
+}
+
+bool FormulaStore::matches(FormulaId f, const Key& key) const {
+    const Formula& node = nodes[f];
+    return node.op == key.op && node.name == key.name &&
+           node.operands.size() == key.operandCount && node.terms.size() == key.termCount &&
+           std::equal(node.operands.begin(), node.operands.end(), key.operands) &&
+           std::equal(node.terms.begin(), node.terms.end(), key.terms);
+}
+
+void FormulaStore::rehash(size_t slots) {
+    table.assign(slots, NoFormula);
+    for (size_t f = 0; f < nodes.size(); ++f) {
+        size_t i = hash(keyOf(nodes[f])) & (slots - 1);
+        while (table[i] != NoFormula) i = (i + 1) & (slots - 1);
+        table[i] = static_cast<FormulaId>(f);
+    }
+}
+
+void FormulaStore::reserve(size_t n) {
+    nodes.reserve(n);
+    gathered.reserve(16);
+    flat.reserve(16);
+    size_t slots = 16;
+    while (slots < 2 * n) slots *= 2;
+    if (slots > table.size()) rehash(slots);
+}
+
+// Linear probing over a power-of-two table kept at most half full. A hit
+// touches only the table and the candidate nodes; a miss copies the key into
+// a new node, or just reports NoFormula while probing.
+FormulaId FormulaStore::intern(const Key& key) {
+    if (table.empty()) rehash(16);
+
+    size_t mask = table.size() - 1;
+    size_t i = hash(key) & mask;
+    for (; table[i] != NoFormula; i = (i + 1) & mask)
+        if (matches(table[i], key)) return table[i];
+    if (probing) return NoFormula;
+
+    if (2 * (nodes.size() + 1) > table.size()) {
+        rehash(2 * table.size());
+        mask = table.size() - 1;
+        for (i = hash(key) & mask; table[i] != NoFormula; i = (i + 1) & mask) {}
+    }
+
+    FormulaId id = static_cast<FormulaId>(nodes.size());
+    nodes.push_back({key.op,
+                     std::vector<FormulaId>(key.operands, key.operands + key.operandCount),
+                     std::string(key.name),
+                     std::vector<TermId>(key.terms, key.terms + key.termCount)});
+    table[i] = id;
+    return id;
+}
+
+FormulaId FormulaStore::atom(std::string_view name) {
+    return intern({Connective::Atom, nullptr, 0, name, nullptr, 0});
+}
+
+FormulaId FormulaStore::negate(FormulaId f) {
+    return intern({Connective::Not, &f, 1, {}, nullptr, 0});
+}
+
+FormulaId FormulaStore::makeAC(Connective op) {
+    // Flatten nested nodes of the same connective, then sort by id
+    flat.clear();
+    for (FormulaId id : gathered) {
+        if (id == NoFormula) return NoFormula; // an operand missed while probing
+        if (nodes[id].op == op) {
+            const auto& inner = nodes[id].operands;
+            flat.insert(flat.end(), inner.begin(), inner.end());
+        } else {
+            flat.push_back(id);
+        }
+    }
+
+    if (flat.size() == 1) return flat[0];
+
+    std::sort(flat.begin(), flat.end());
+    return intern({op, flat.data(), flat.size(), {}, nullptr, 0});
+}
+
+FormulaId FormulaStore::conjoin(const std::vector<FormulaId>& operands) {
+    gathered.assign(operands.begin(), operands.end());
+    return makeAC(Connective::And);
+}
+
+FormulaId FormulaStore::disjoin(const std::vector<FormulaId>& operands) {
+    gathered.assign(operands.begin(), operands.end());
+    return makeAC(Connective::Or);
+}
+
+FormulaId FormulaStore::conjoin(FormulaId a, FormulaId b) {
+    gathered.assign({a, b});
+    return makeAC(Connective::And);
+}
+
+FormulaId FormulaStore::disjoin(FormulaId a, FormulaId b) {
+    gathered.assign({a, b});
+    return makeAC(Connective::Or);
+}
+
+FormulaId FormulaStore::implies(FormulaId antecedent, FormulaId consequent) {
+    FormulaId ops[] = {antecedent, consequent};
+    return intern({Connective::Implies, ops, 2, {}, nullptr, 0});
+}
+
+FormulaId FormulaStore::iff(FormulaId lhs, FormulaId rhs) {
+    FormulaId ops[] = {lhs, rhs};
+    return intern({Connective::Iff, ops, 2, {}, nullptr, 0});
+}
+
+FormulaId FormulaStore::predicate(std::string_view name, std::vector<TermId> args) {
+    return intern({Connective::Predicate, nullptr, 0, name, args.data(), args.size()});
+}
+
+FormulaId FormulaStore::forAll(TermId var, FormulaId body) {
+    return intern({Connective::ForAll, &body, 1, {}, &var, 1});
+}
+
+FormulaId FormulaStore::exists(TermId var, FormulaId body) {
+    return intern({Connective::Exists, &body, 1, {}, &var, 1});
+}
+
+FormulaId FormulaStore::withoutOperand(FormulaId f, size_t i) {
+    const auto& ops = nodes[f].operands;
+    gathered.clear();
+    for (size_t k = 0; k < ops.size(); ++k)
+        if (k != i) gathered.push_back(ops[k]);
+    return makeAC(nodes[f].op);
+}
+
+FormulaId FormulaStore::withOperand(FormulaId f, size_t i, FormulaId r) {
+    Connective op = nodes[f].op;
+    switch (op) {
+        case Connective::Not: return negate(r);
+        case Connective::And:
+        case Connective::Or:
+            gathered.assign(nodes[f].operands.begin(), nodes[f].operands.end());
+            gathered[i] = r;
+            return makeAC(op);
+        case Connective::Implies: return i == 0 ? implies(r, nodes[f].operands[1]) : implies(nodes[f].operands[0], r);
+        case Connective::Iff: return i == 0 ? iff(r, nodes[f].operands[1]) : iff(nodes[f].operands[0], r);
+        case Connective::ForAll: return forAll(nodes[f].terms[0], r);
+        case Connective::Exists: return exists(nodes[f].terms[0], r);
+        default: return f;
+    }
+}
+
+// Each negation may add a node, so operands are re-read by index rather than
+// through a reference into nodes
+FormulaId FormulaStore::negatedOperands(Connective op, FormulaId f) {
+    size_t n = nodes[f].operands.size();
+    gathered.clear();
+    for (size_t k = 0; k < n; ++k) {
+        FormulaId negation = negate(nodes[f].operands[k]);
+        gathered.push_back(negation);
+    }
+    return makeAC(op);
+}
+
+std::vector<FormulaId> FormulaStore::flatten(FormulaId f, Connective op) const {
+    if (is(f, op)) return nodes[f].operands;
+    return {f};
+}
+
+FormulaId FormulaStore::substitute(FormulaId f, TermId var, TermId term) {
+    Formula node = nodes[f];
+
+    switch (node.op) {
+        case Connective::Atom:
+            return f;
+        case Connective::Predicate: {
+            bool changed = false;
+            for (TermId& arg : node.terms) {
+                TermId next = terms.substitute(arg, var, term);
+                changed = changed || next != arg;
+                arg = next;
+            }
+            return changed ? predicate(node.name, std::move(node.terms)) : f;
+        }
+        case Connective::ForAll:
+        case Connective::Exists: {
+            if (node.terms[0] == var) return f; // var is rebound here
+            FormulaId body = substitute(node.operands[0], var, term);
+            if (body == node.operands[0]) return f;
+            return node.op == Connective::ForAll ? forAll(node.terms[0], body) : exists(node.terms[0], body);
+        }
+        default:
+            break;
+    }
+
+    bool changed = false;
+    for (FormulaId& op : node.operands) {
+        FormulaId next = substitute(op, var, term);
+        changed = changed || next != op;
+        op = next;
+    }
+    if (!changed) return f;
+
+    switch (node.op) {
+        case Connective::Not: return negate(node.operands[0]);
+        case Connective::And: return conjoin(node.operands);
+        case Connective::Or: return disjoin(node.operands);
+        case Connective::Implies: return implies(node.operands[0], node.operands[1]);
+        default: return iff(node.operands[0], node.operands[1]);
+    }
+}
+
+void FormulaStore::collectPredicates(FormulaId f, std::vector<FormulaId>& out) const {
+    if (nodes[f].op == Connective::Predicate) out.push_back(f);
+    for (FormulaId op : nodes[f].operands) collectPredicates(op, out);
+}
+
+void FormulaStore::collectGroundTerms(FormulaId f, std::vector<TermId>& out) const {
+    const Formula& node = nodes[f];
+    if (node.op == Connective::Predicate) {
+        std::vector<TermId> pending = node.terms;
+        while (!pending.empty()) {
+            TermId t = pending.back();
+            pending.pop_back();
+            if (terms.ground(t)) out.push_back(t);
+            const auto& args = terms.get(t).args;
+            pending.insert(pending.end(), args.begin(), args.end());
+        }
+    }
+    for (FormulaId op : node.operands) collectGroundTerms(op, out);
+}
+
+std::optional<TermId> FormulaStore::instanceTerm(FormulaId body, TermId var, FormulaId f) {
+    if (body == f) return NoTerm;
+
+    std::vector<TermId> candidates;
+    collectGroundTerms(f, candidates);
+    for (TermId t : candidates)
+        if (substitute(body, var, t) == f) return t;
+    return std::nullopt;
+}
+
+// Recursive-descent parser over the text in place: names are looked up as
+// views into it, so parsing copies only what a new formula stores.
+// Precedence (loosest first): <->, -> (right-assoc), v, ^, then the unary
+// ~, ∀x and ∃x. F(t1,...,tn) is a predicate; a bare name is a sentence letter.
+// The spellings normalizeConnectives() rewrites (<=>, =>, |, \/, or, &, /\,
+// and, not) are read as their connectives, so raw input needs no normalized copy.
+namespace {
+
+class Parser {
+public:
+    Parser(FormulaStore& store, std::string_view text) : store(store), s(text) {}
+
+    std::optional<LayoutId> run() {
+        auto f = parseIff();
+        skipSpace();
+        if (!f || pos != s.size()) return std::nullopt;
+        return f;
+    }
+
+private:
+    FormulaStore& store;
+    std::string_view s;
+    size_t pos = 0;
+    std::vector<std::string_view> bound; // variables of enclosing quantifiers
+
+    void skipSpace() {
+        while (pos < s.size() && (s[pos] == ' ' || s[pos] == '\t')) pos++;
+    }
+
+    bool accept(std::string_view tok) {
+        skipSpace();
+        if (s.substr(pos, tok.size()) == tok) {
+            pos += tok.size();
+            return true;
+        }
+        return false;
+    }
+
+    // A spelled-out connective, only where it is not the start of a longer name
+    bool acceptWord(std::string_view word) {
+        skipSpace();
+        size_t end = pos + word.size();
+        if (s.substr(pos, word.size()) != word || (end < s.size() && isAtomChar(s[end]))) return false;
+        pos = end;
+        return true;
+    }
+
+    bool acceptOr() { return accept("v") || accept("|") || accept("\\/") || acceptWord("or"); }
+    bool acceptAnd() { return accept("^") || accept("&") || accept("/\\") || acceptWord("and"); }
+    bool acceptNot() { return accept("~") || acceptWord("not"); }
+
+    static bool isAtomChar(char c) {
+        return !(c == ' ' || c == '\t' || c == '(' || c == ')' || c == '~' ||
+                 c == '^' || c == 'v' || c == '-' || c == '<' || c == '>' || c == ',' ||
+                 c == '|' || c == '&' || c == '=' || c == '/' || c == '\\');
+    }
+
+    static bool isVariableChar(char c) {
+        return (c >= 'a' && c <= 'z' && c != 'v') || (c >= '0' && c <= '9') || c == '_';
+    }
+
+    FormulaId formula(LayoutId l) const { return store.layout(l).formula; }
+
+    LayoutId binary(FormulaId f, LayoutId lhs, LayoutId rhs) { return store.arrange(f, {lhs, rhs}); }
+
+    std::optional<LayoutId> parseIff() {
+        auto lhs = parseImplies();
+        if (!lhs) return std::nullopt;
+        if (accept("<->") || accept("<=>")) {
+            auto rhs = parseIff();
+            if (!rhs) return std::nullopt;
+            return binary(store.iff(formula(*lhs), formula(*rhs)), *lhs, *rhs);
+        }
+        return lhs;
+    }
+
+    std::optional<LayoutId> parseImplies() {
+        auto lhs = parseOr();
+        if (!lhs) return std::nullopt;
+        size_t save = pos;
+        skipSpace();
+        if (s.substr(pos, 2) == "->" || s.substr(pos, 2) == "=>") {
+            pos += 2;
+            auto rhs = parseImplies();
+            if (!rhs) return std::nullopt;
+            return binary(store.implies(formula(*lhs), formula(*rhs)), *lhs, *rhs);
+        }
+        pos = save;
+        return lhs;
+    }
+
+    // An unparenthesized chain a^b^c is laid out a^(b^c), as render() prints it
+    LayoutId chain(Connective op, const std::vector<LayoutId>& ops) {
+        LayoutId rest = ops.back();
+        for (size_t i = ops.size() - 1; i-- > 0;) rest = store.join(op, ops[i], rest);
+        return rest;
+    }
+
+    std::optional<LayoutId> parseOr() {
+        auto first = parseAnd();
+        if (!first || !acceptOr()) return first;
+        std::vector<LayoutId> ops = {*first};
+        do {
+            auto next = parseAnd();
+            if (!next) return std::nullopt;
+            ops.push_back(*next);
+        } while (acceptOr());
+        return chain(Connective::Or, ops);
+    }
+
+    std::optional<LayoutId> parseAnd() {
+        auto first = parseUnary();
+        if (!first || !acceptAnd()) return first;
+        std::vector<LayoutId> ops = {*first};
+        do {
+            auto next = parseUnary();
+            if (!next) return std::nullopt;
+            ops.push_back(*next);
+        } while (acceptAnd());
+        return chain(Connective::And, ops);
+    }
+
+    std::optional<LayoutId> parseUnary() {
+        if (acceptNot()) {
+            auto inner = parseUnary();
+            if (!inner) return std::nullopt;
+            return store.arrange(store.negate(formula(*inner)), {*inner});
+        }
+        bool universal = accept("∀");
+        if (universal || accept("∃")) {
+            skipSpace();
+            size_t start = pos;
+            while (pos < s.size() && isVariableChar(s[pos])) pos++;
+            if (pos == start) return std::nullopt;
+
+            std::string_view name = s.substr(start, pos - start);
+            TermId var = store.termStore().variable(name);
+            bound.push_back(name);
+            auto body = parseUnary();
+            bound.pop_back();
+            if (!body) return std::nullopt;
+            FormulaId f = universal ? store.forAll(var, formula(*body)) : store.exists(var, formula(*body));
+            return store.arrange(f, {*body});
+        }
+        if (accept("(")) {
+            auto inner = parseIff();
+            if (!inner || !accept(")")) return std::nullopt;
+            return inner;
+        }
+
+        skipSpace();
+        size_t start = pos;
+        while (pos < s.size() && isAtomChar(s[pos])) pos++;
+        if (pos == start) return std::nullopt;
+
+        std::string_view name = s.substr(start, pos - start);
+        if (pos < s.size() && s[pos] == '(') {
+            auto args = parseTermList();
+            if (!args) return std::nullopt;
+            return store.arrange(store.predicate(name, std::move(*args)), {});
+        }
+        return store.arrange(store.atom(name), {});
+    }
+
+    // "(t1,...,tn)" directly after a predicate or function name
+    std::optional<std::vector<TermId>> parseTermList() {
+        pos++; // '('
+        std::vector<TermId> args;
+        do {
+            auto t = parseTerm();
+            if (!t) return std::nullopt;
+            args.push_back(*t);
+        } while (accept(","));
+        if (!accept(")")) return std::nullopt;
+        return args;
+    }
+
+    std::optional<TermId> parseTerm() {
+        skipSpace();
+        size_t start = pos;
+        while (pos < s.size() && isAtomChar(s[pos])) pos++;
+        if (pos == start) return std::nullopt;
+
+        std::string_view name = s.substr(start, pos - start);
+        TermStore& terms = store.termStore();
+        if (pos < s.size() && s[pos] == '(') {
+            auto args = parseTermList();
+            if (!args) return std::nullopt;
+            return terms.function(name, std::move(*args));
+        }
+        if (std::find(bound.begin(), bound.end(), name) != bound.end()) return terms.variable(name);
+        return terms.constant(name);
+    }
+};
+
+} // namespace
+
+std::optional<FormulaId> FormulaStore::parse(std::string_view text) {
+    auto parsed = parseLayout(text);
+    if (!parsed) return std::nullopt;
+    return layouts[*parsed].formula;
+}
+
+std::optional<LayoutId> FormulaStore::parseLayout(std::string_view text) {
+    return Parser(*this, text).run();
+}
+
+size_t FormulaStore::LayoutKeyHash::operator()(const std::vector<int>& key) const {
+    size_t h = key.size();
+    for (int k : key) h = h * 1000003 ^ static_cast<size_t>(k);
+    return h;
+}
+
+LayoutId FormulaStore::arrange(FormulaId f, const std::vector<LayoutId>& operands) {
+    std::vector<int> key = {f};
+    key.insert(key.end(), operands.begin(), operands.end());
+    auto [it, inserted] = layoutIndex.try_emplace(std::move(key), static_cast<LayoutId>(layouts.size()));
+    if (inserted) layouts.push_back({f, operands});
+    return it->second;
+}
+
+LayoutId FormulaStore::join(Connective op, LayoutId lhs, LayoutId rhs) {
+    FormulaId a = layouts[lhs].formula, b = layouts[rhs].formula;
+    FormulaId f = op == Connective::And ? conjoin(a, b)
+                : op == Connective::Or ? disjoin(a, b)
+                : op == Connective::Implies ? implies(a, b)
+                : iff(a, b);
+    return arrange(f, {lhs, rhs});
+}
+
+LayoutId FormulaStore::defaultLayout(FormulaId f) {
+    std::vector<FormulaId> ops = nodes[f].operands; // copied: interning may move nodes
+    Connective op = nodes[f].op;
+
+    if (op == Connective::And || op == Connective::Or) {
+        LayoutId rest = defaultLayout(ops.back());
+        for (size_t i = ops.size() - 1; i-- > 0;) rest = join(op, defaultLayout(ops[i]), rest);
+        return rest;
+    }
+    std::vector<LayoutId> operands;
+    for (FormulaId operand : ops) operands.push_back(defaultLayout(operand));
+    return arrange(f, operands);
+}
+
+std::string FormulaStore::renderOperand(FormulaId f) const {
+    Connective op = nodes[f].op;
+    if (op == Connective::Atom || op == Connective::Not || op == Connective::Predicate ||
+        op == Connective::ForAll || op == Connective::Exists)
+        return render(f);
+    return "(" + render(f) + ")";
+}
+
+std::string FormulaStore::renderLayoutOperand(LayoutId l) const {
+    Connective op = nodes[layouts[l].formula].op;
+    if (op == Connective::Atom || op == Connective::Not || op == Connective::Predicate ||
+        op == Connective::ForAll || op == Connective::Exists)
+        return renderLayout(l);
+    return "(" + renderLayout(l) + ")";
+}
+
+std::string FormulaStore::renderLayout(LayoutId l) const {
+    const Layout& shape = layouts[l];
+    const Formula& node = nodes[shape.formula];
+
+    switch (node.op) {
+        case Connective::Atom:
+        case Connective::Predicate:
+            return render(shape.formula);
+        case Connective::ForAll:
+            return "∀" + terms.render(node.terms[0]) + renderLayoutOperand(shape.operands[0]);
+        case Connective::Exists:
+            return "∃" + terms.render(node.terms[0]) + renderLayoutOperand(shape.operands[0]);
+        case Connective::Not:
+            return "~" + renderLayoutOperand(shape.operands[0]);
+        case Connective::Implies:
+            return renderLayoutOperand(shape.operands[0]) + "->" + renderLayoutOperand(shape.operands[1]);
+        case Connective::Iff:
+            return renderLayoutOperand(shape.operands[0]) + "<->" + renderLayoutOperand(shape.operands[1]);
+        case Connective::And:
+        case Connective::Or:
+            return renderLayoutOperand(shape.operands[0]) + (node.op == Connective::And ? "^" : "v") +
+                   renderLayoutOperand(shape.operands[1]);
+    }
+    return "";
+}
+
+std::string FormulaStore::render(FormulaId f) const {
+    const Formula& node = nodes[f];
+
+    switch (node.op) {
+        case Connective::Atom:
+            return node.name;
+        case Connective::Predicate: {
+            std::string out = node.name + "(";
+            for (size_t i = 0; i < node.terms.size(); ++i) {
+                if (i > 0) out += ",";
+                out += terms.render(node.terms[i]);
+            }
+            return out + ")";
+        }
+        case Connective::ForAll:
+            return "∀" + terms.render(node.terms[0]) + renderOperand(node.operands[0]);
+        case Connective::Exists:
+            return "∃" + terms.render(node.terms[0]) + renderOperand(node.operands[0]);
+        case Connective::Not:
+            return "~" + renderOperand(node.operands[0]);
+        case Connective::Implies:
+            return renderOperand(node.operands[0]) + "->" + renderOperand(node.operands[1]);
+        case Connective::Iff:
+            return renderOperand(node.operands[0]) + "<->" + renderOperand(node.operands[1]);
+        case Connective::And:
+        case Connective::Or: {
+            // Binary Carnap style: a^(b^(c^d))
+            const std::string sym = node.op == Connective::And ? "^" : "v";
+            const auto& ops = node.operands;
+            std::string out = renderOperand(ops.back());
+            for (size_t i = ops.size() - 1; i-- > 0;) {
+                std::string rest = (i == ops.size() - 2) ? out : "(" + out + ")";
+                out = renderOperand(ops[i]) + sym + rest;
+            }
+            return out;
+        }
+    }
+    return "";
+}
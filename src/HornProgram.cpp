@@ -0,0 +1,113 @@
+#include "HornProgram.h"
+#include <algorithm>
+
+namespace {
+
+bool isAtom(const FormulaStore& store, FormulaId f) {
+    return store.is(f, Connective::Atom) || store.is(f, Connective::Predicate);
+}
+
+} // namespace
+
+bool HornProgram::conjunctionOfAtoms(const FormulaStore& store, FormulaId f) {
+    if (isAtom(store, f)) return true;
+    if (!store.is(f, Connective::And)) return false;
+
+    const auto& ops = store.get(f).operands; // sorted, so duplicates are adjacent
+    for (size_t i = 0; i < ops.size(); ++i)
+        if (!isAtom(store, ops[i]) || (i > 0 && ops[i] == ops[i - 1])) return false;
+    return true;
+}
+
+int HornProgram::atomIndex(FormulaId atom) {
+    auto [it, added] = indexOf.emplace(atom, static_cast<int>(atoms.size()));
+    if (added) {
+        atoms.push_back(atom);
+        watchers.emplace_back();
+    }
+    return it->second;
+}
+
+bool HornProgram::add(const FormulaStore& store, FormulaId premise, size_t line) {
+    FormulaId antecedent = NoFormula;
+    FormulaId consequent = premise;
+    if (store.is(premise, Connective::Implies)) {
+        antecedent = store.get(premise).operands[0];
+        consequent = store.get(premise).operands[1];
+        if (!conjunctionOfAtoms(store, antecedent)) return false;
+    }
+    if (!conjunctionOfAtoms(store, consequent)) return false;
+
+    Clause clause{line, antecedent, consequent, {}, {}};
+    if (antecedent != NoFormula)
+        for (FormulaId a : store.flatten(antecedent, Connective::And)) clause.body.push_back(atomIndex(a));
+    for (FormulaId h : store.flatten(consequent, Connective::And)) clause.heads.push_back(atomIndex(h));
+
+    for (int a : clause.body) watchers[a].push_back(clauses.size());
+    clauses.push_back(std::move(clause));
+    return true;
+}
+
+std::optional<std::vector<HornProgram::Step>> HornProgram::derive(const FormulaStore& store, FormulaId goal) const {
+    std::vector<int> goals;
+    for (FormulaId g : store.flatten(goal, Connective::And)) {
+        auto it = indexOf.find(g);
+        if (it == indexOf.end()) return std::nullopt; // no clause mentions it
+        goals.push_back(it->second);
+    }
+
+    // Forward propagation until every goal atom is known
+    std::vector<int> reason(atoms.size(), -1); // clause that first yielded each atom
+    std::vector<size_t> missing(clauses.size());
+    std::vector<int> queue;
+    std::vector<size_t> fired;
+    std::vector<bool> isGoal(atoms.size(), false);
+    size_t open = 0;
+    for (int g : goals) {
+        if (!isGoal[g]) open++;
+        isGoal[g] = true;
+    }
+
+    auto fire = [&](size_t c) {
+        fired.push_back(c);
+        for (int h : clauses[c].heads) {
+            if (reason[h] != -1) continue;
+            reason[h] = static_cast<int>(c);
+            queue.push_back(h);
+            if (isGoal[h]) open--;
+        }
+    };
+
+    for (size_t c = 0; c < clauses.size(); ++c) missing[c] = clauses[c].body.size();
+    for (size_t c = 0; c < clauses.size() && open > 0; ++c)
+        if (missing[c] == 0) fire(c);
+    for (size_t next = 0; next < queue.size() && open > 0; ++next)
+        for (size_t c : watchers[queue[next]])
+            if (--missing[c] == 0) fire(c);
+    if (open > 0) return std::nullopt;
+
+    // Backward over the firing order: a clause is used when it yielded an
+    // atom the goal depends on, and then its body atoms are needed too
+    std::vector<bool> needed(atoms.size(), false);
+    std::vector<bool> used(clauses.size(), false);
+    for (int g : goals) needed[g] = true;
+    for (size_t i = fired.size(); i-- > 0;) {
+        size_t c = fired[i];
+        for (int h : clauses[c].heads)
+            if (needed[h] && reason[h] == static_cast<int>(c)) used[c] = true;
+        if (used[c])
+            for (int a : clauses[c].body) needed[a] = true;
+    }
+
+    std::vector<Step> steps;
+    for (size_t c : fired) {
+        if (!used[c]) continue;
+        Step step{c, {}};
+        for (int h : clauses[c].heads)
+            if (needed[h] && reason[h] == static_cast<int>(c)) step.atoms.push_back(atoms[h]);
+        // The goal's own conjuncts last, so the proof ends on them
+        std::stable_partition(step.atoms.begin(), step.atoms.end(), [&](FormulaId a) { return !isGoal[indexOf.at(a)]; });
+        steps.push_back(std::move(step));
+    }
+    return steps;
+}
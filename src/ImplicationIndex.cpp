@@ -0,0 +1,78 @@
+#include "ImplicationIndex.h"
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define IMPLICATION_SSE2 1
+#endif
+
+namespace {
+
+unsigned lowestBit(unsigned mask) {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#else
+    unsigned i = 0;
+    while (!(mask & 1u)) mask >>= 1, ++i;
+    return i;
+#endif
+}
+
+} // namespace
+
+void ImplicationIndex::clear() {
+    facts.clear();
+    positions.clear();
+    antecedents.clear();
+    consequents.clear();
+}
+
+void ImplicationIndex::add(const FormulaStore& fs, FormulaId line) {
+    if (fs.is(line, Connective::Implies)) {
+        const auto& ops = fs.get(line).operands;
+        positions.push_back(static_cast<int>(facts.size()));
+        antecedents.push_back(ops[0]);
+        consequents.push_back(ops[1]);
+    }
+    facts.push_back(line);
+}
+
+void ImplicationIndex::truncate(size_t lines) {
+    if (lines >= facts.size()) return;
+    facts.resize(lines);
+    size_t kept = firstAt(lines);
+    positions.resize(kept);
+    antecedents.resize(kept);
+    consequents.resize(kept);
+}
+
+size_t ImplicationIndex::firstAt(size_t position) const {
+    return static_cast<size_t>(std::lower_bound(positions.begin(), positions.end(), static_cast<int>(position)) -
+                               positions.begin());
+}
+
+// Sixteen ids per step: four compares are or-ed so a block without a hit
+// costs one movemask, and only blocks with hits are read off bit by bit
+void ImplicationIndex::sweep(const FormulaId* data, size_t n, FormulaId f, std::vector<size_t>& hits) {
+    size_t i = 0;
+#ifdef IMPLICATION_SSE2
+    const __m128i key = _mm_set1_epi32(f);
+    auto compare = [&](size_t at) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + at));
+        return _mm_cmpeq_epi32(block, key);
+    };
+    auto mask = [](__m128i eq) { return static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(eq))); };
+
+    for (; i + 16 <= n; i += 16) {
+        __m128i a = compare(i), b = compare(i + 4), c = compare(i + 8), d = compare(i + 12);
+        if (!mask(_mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d)))) continue;
+
+        unsigned bits = mask(a) | mask(b) << 4 | mask(c) << 8 | mask(d) << 12;
+        for (; bits; bits &= bits - 1) hits.push_back(i + lowestBit(bits));
+    }
+    for (; i + 4 <= n; i += 4)
+        for (unsigned bits = mask(compare(i)); bits; bits &= bits - 1) hits.push_back(i + lowestBit(bits));
+#endif
+    for (; i < n; ++i)
+        if (data[i] == f) hits.push_back(i);
+}
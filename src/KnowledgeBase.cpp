@@ -0,0 +1,396 @@
+#include "KnowledgeBase.h"
+#include "Utils.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+
+constexpr char Magic[8] = {'S', 'Y', 'L', 'K', 'B', 'A', 'S', 'E'};
+constexpr uint32_t Version = 1;
+
+// On-disk header; all integers are native-endian uint32. Lists inside records
+// (operands, terms, arguments, symbols, postings) are ranges of one shared
+// uint32 pool; strings are absolute offsets into the trailing string blob.
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t formulaCount, formulasOffset;
+    uint32_t termCount, termsOffset;
+    uint32_t premiseCount, premisesOffset;
+    uint32_t symbolCount, symbolsOffset; // sorted by name
+    uint32_t poolCount, poolOffset;
+};
+
+} // namespace
+
+struct KnowledgeBase::FormulaRecord {
+    uint32_t op;
+    uint32_t name, nameLength;
+    uint32_t operands, operandCount;
+    uint32_t terms, termCount;
+};
+
+struct KnowledgeBase::TermRecord {
+    uint32_t kind;
+    uint32_t name, nameLength;
+    uint32_t args, argCount;
+};
+
+struct KnowledgeBase::PremiseRecord {
+    uint32_t formula;
+    uint32_t symbols, symbolCount;
+};
+
+struct KnowledgeBase::SymbolRecord {
+    uint32_t name, nameLength;
+    uint32_t postings, postingCount; // premise indices, ascending
+};
+
+std::shared_ptr<const KnowledgeBase> KnowledgeBase::open(const std::string& path) {
+    std::shared_ptr<KnowledgeBase> kb(new KnowledgeBase(path));
+    const MappedFile& file = kb->file;
+
+    Header header;
+    if (!file.valid() || file.size() < sizeof(header)) {
+        std::cerr << "[KB] Cannot read " << path << "\n";
+        return nullptr;
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+
+    auto fits = [&](uint32_t offset, uint32_t count, size_t size) {
+        return uint64_t(offset) + uint64_t(count) * size <= file.size();
+    };
+    if (std::memcmp(header.magic, Magic, sizeof(Magic)) != 0 || header.version != Version ||
+        !fits(header.formulasOffset, header.formulaCount, sizeof(FormulaRecord)) ||
+        !fits(header.termsOffset, header.termCount, sizeof(TermRecord)) ||
+        !fits(header.premisesOffset, header.premiseCount, sizeof(PremiseRecord)) ||
+        !fits(header.symbolsOffset, header.symbolCount, sizeof(SymbolRecord)) ||
+        !fits(header.poolOffset, header.poolCount, sizeof(uint32_t))) {
+        std::cerr << "[KB] " << path << " is not a compiled knowledge base\n";
+        return nullptr;
+    }
+
+    kb->formulaCount = header.formulaCount;
+    kb->formulasOffset = header.formulasOffset;
+    kb->termCount = header.termCount;
+    kb->termsOffset = header.termsOffset;
+    kb->premiseCount = header.premiseCount;
+    kb->premisesOffset = header.premisesOffset;
+    kb->symbolCount = header.symbolCount;
+    kb->symbolsOffset = header.symbolsOffset;
+    kb->poolCount = header.poolCount;
+    kb->poolOffset = header.poolOffset;
+    return kb;
+}
+
+template <typename Record>
+Record KnowledgeBase::record(uint32_t offset, uint32_t index) const {
+    Record r;
+    std::memcpy(&r, file.data() + offset + size_t(index) * sizeof(Record), sizeof(Record));
+    return r;
+}
+
+uint32_t KnowledgeBase::pooled(uint32_t index) const {
+    uint32_t value = 0;
+    if (index < poolCount) std::memcpy(&value, file.data() + poolOffset + size_t(index) * sizeof(uint32_t), sizeof(value));
+    return value;
+}
+
+std::string_view KnowledgeBase::text(uint32_t offset, uint32_t length) const {
+    if (uint64_t(offset) + length > file.size()) return {};
+    return std::string_view(file.data() + offset, length);
+}
+
+std::optional<uint32_t> KnowledgeBase::findSymbol(std::string_view name) const {
+    auto nameAt = [&](uint32_t i) {
+        auto s = record<SymbolRecord>(symbolsOffset, i);
+        return text(s.name, s.nameLength);
+    };
+
+    uint32_t lo = 0, hi = symbolCount;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (nameAt(mid) < name) lo = mid + 1; else hi = mid;
+    }
+    if (lo < symbolCount && nameAt(lo) == name) return lo;
+    return std::nullopt;
+}
+
+std::vector<uint32_t> KnowledgeBase::relevant(const std::vector<std::string>& seeds, size_t limit) const {
+    std::vector<uint32_t> picked;
+    std::vector<uint32_t> symbols; // of the tier being gathered
+    std::unordered_set<uint32_t> seenSymbols;
+    std::unordered_set<uint32_t> seenPremises;
+
+    for (const auto& seed : seeds)
+        if (auto s = findSymbol(seed); s && seenSymbols.insert(*s).second) symbols.push_back(*s);
+    std::unordered_set<uint32_t> seedSymbols = seenSymbols;
+
+    // A symbol no other premise has leads nowhere, unless the problem has it
+    auto loose = [&](uint32_t p) {
+        auto premise = record<PremiseRecord>(premisesOffset, p);
+        size_t count = 0;
+        for (uint32_t j = 0; j < premise.symbolCount; ++j) {
+            uint32_t s = pooled(premise.symbols + j);
+            count += s < symbolCount && record<SymbolRecord>(symbolsOffset, s).postingCount == 1 &&
+                     !seedSymbols.count(s);
+        }
+        return count;
+    };
+
+    // Tier by tier, each whole before the cut so it can be ranked
+    std::vector<std::pair<size_t, uint32_t>> tier; // (loose symbols, premise)
+    while (!symbols.empty() && picked.size() < limit) {
+        tier.clear();
+        for (uint32_t symbol : symbols) {
+            auto s = record<SymbolRecord>(symbolsOffset, symbol);
+            for (uint32_t k = 0; k < s.postingCount; ++k) {
+                uint32_t p = pooled(s.postings + k);
+                if (p < premiseCount && seenPremises.insert(p).second) tier.push_back({0, p});
+            }
+        }
+        for (auto& [rank, p] : tier) rank = loose(p);
+        std::stable_sort(tier.begin(), tier.end(),
+                         [](const auto& a, const auto& b) { return a.first < b.first; });
+
+        symbols.clear();
+        for (const auto& [rank, p] : tier) {
+            if (picked.size() == limit) break;
+            picked.push_back(p);
+            auto premise = record<PremiseRecord>(premisesOffset, p);
+            for (uint32_t j = 0; j < premise.symbolCount; ++j) {
+                uint32_t s = pooled(premise.symbols + j);
+                if (s < symbolCount && seenSymbols.insert(s).second) symbols.push_back(s);
+            }
+        }
+    }
+    return picked;
+}
+
+FormulaId KnowledgeBase::import(uint32_t index, FormulaStore& store) const {
+    if (index >= premiseCount) return NoFormula;
+    return importFormula(record<PremiseRecord>(premisesOffset, index).formula, store);
+}
+
+// open() checks only the header, so records are checked as they are
+// imported: each needs the operands and terms its kind takes, held in the
+// pool, and every child comes before its parent, as the store that wrote
+// them interned it, which also bounds the recursion. A bad record imports as
+// NoTerm or NoFormula.
+bool KnowledgeBase::inPool(uint32_t first, uint32_t count) const {
+    return uint64_t(first) + count <= poolCount;
+}
+
+TermId KnowledgeBase::importTerm(uint32_t id, FormulaStore& store) const {
+    if (id >= termCount) return NoTerm;
+    auto t = record<TermRecord>(termsOffset, id);
+    std::string name(text(t.name, t.nameLength));
+    TermStore& terms = store.termStore();
+
+    switch (static_cast<TermKind>(t.kind)) {
+        case TermKind::Variable: return t.argCount == 0 ? terms.variable(name) : NoTerm;
+        case TermKind::Constant: return t.argCount == 0 ? terms.constant(name) : NoTerm;
+        case TermKind::Function: break;
+        default: return NoTerm;
+    }
+    if (!inPool(t.args, t.argCount)) return NoTerm;
+
+    std::vector<TermId> args;
+    for (uint32_t k = 0; k < t.argCount; ++k) {
+        uint32_t arg = pooled(t.args + k);
+        TermId a = arg < id ? importTerm(arg, store) : NoTerm;
+        if (a == NoTerm) return NoTerm;
+        args.push_back(a);
+    }
+    return terms.function(name, std::move(args));
+}
+
+FormulaId KnowledgeBase::importFormula(uint32_t id, FormulaStore& store) const {
+    if (id >= formulaCount) return NoFormula;
+    auto f = record<FormulaRecord>(formulasOffset, id);
+
+    // Operands and terms each kind of record takes
+    auto op = static_cast<Connective>(f.op);
+    bool shaped = false;
+    switch (op) {
+        case Connective::Atom: shaped = f.operandCount == 0 && f.termCount == 0; break;
+        case Connective::Not: shaped = f.operandCount == 1 && f.termCount == 0; break;
+        case Connective::And:
+        case Connective::Or: shaped = f.operandCount >= 2 && f.termCount == 0; break;
+        case Connective::Implies:
+        case Connective::Iff: shaped = f.operandCount == 2 && f.termCount == 0; break;
+        case Connective::Predicate: shaped = f.operandCount == 0; break;
+        case Connective::ForAll:
+        case Connective::Exists: shaped = f.operandCount == 1 && f.termCount == 1; break;
+    }
+    if (!shaped || !inPool(f.operands, f.operandCount) || !inPool(f.terms, f.termCount)) return NoFormula;
+
+    std::vector<FormulaId> ops;
+    for (uint32_t k = 0; k < f.operandCount; ++k) {
+        uint32_t operand = pooled(f.operands + k);
+        FormulaId o = operand < id ? importFormula(operand, store) : NoFormula;
+        if (o == NoFormula) return NoFormula;
+        ops.push_back(o);
+    }
+    std::vector<TermId> terms;
+    for (uint32_t k = 0; k < f.termCount; ++k) {
+        TermId t = importTerm(pooled(f.terms + k), store);
+        if (t == NoTerm) return NoFormula;
+        terms.push_back(t);
+    }
+
+    switch (op) {
+        case Connective::Atom: return store.atom(std::string(text(f.name, f.nameLength)));
+        case Connective::Not: return store.negate(ops[0]);
+        case Connective::And: return store.conjoin(ops);
+        case Connective::Or: return store.disjoin(ops);
+        case Connective::Implies: return store.implies(ops[0], ops[1]);
+        case Connective::Iff: return store.iff(ops[0], ops[1]);
+        case Connective::Predicate: return store.predicate(std::string(text(f.name, f.nameLength)), terms);
+        case Connective::ForAll: return store.forAll(terms[0], ops[0]);
+        case Connective::Exists: return store.exists(terms[0], ops[0]);
+    }
+    return NoFormula;
+}
+
+void KnowledgeBase::symbolsOf(const FormulaStore& store, FormulaId f, std::vector<std::string>& out) {
+    const Formula& node = store.get(f);
+    if (node.op == Connective::Atom) {
+        out.push_back(node.name);
+    } else if (node.op == Connective::Predicate) {
+        out.push_back(node.name + "/" + std::to_string(node.terms.size()));
+    } else {
+        for (FormulaId operand : node.operands) symbolsOf(store, operand, out);
+    }
+}
+
+bool KnowledgeBase::compile(const std::string& sourcePath, const std::string& outPath) {
+    std::ifstream in(sourcePath);
+    if (!in) {
+        std::cerr << "[KB] Cannot open " << sourcePath << "\n";
+        return false;
+    }
+
+    FormulaStore store;
+    std::vector<FormulaId> premises;
+    std::unordered_set<FormulaId> seen;
+    std::string raw;
+    int lineNo = 0;
+
+    while (std::getline(in, raw)) {
+        lineNo++;
+        std::string line = trim(raw);
+        if (line.empty() || line[0] == '#') continue;
+
+        auto parsed = store.parse(normalizeConnectives(line));
+        if (!parsed) {
+            std::cerr << "[KB] " << sourcePath << ":" << lineNo << ": cannot parse '" << line << "'\n";
+            return false;
+        }
+        if (seen.insert(*parsed).second) premises.push_back(*parsed);
+    }
+
+    // Symbol -> premises containing it, in name order
+    std::map<std::string, std::vector<uint32_t>> postings;
+    std::vector<std::vector<std::string>> premiseSymbols(premises.size());
+    for (uint32_t i = 0; i < premises.size(); ++i) {
+        auto& symbols = premiseSymbols[i];
+        symbolsOf(store, premises[i], symbols);
+        std::sort(symbols.begin(), symbols.end());
+        symbols.erase(std::unique(symbols.begin(), symbols.end()), symbols.end());
+        for (const auto& s : symbols) postings[s].push_back(i);
+    }
+    std::unordered_map<std::string, uint32_t> symbolIndex;
+    for (const auto& [name, list] : postings) symbolIndex.emplace(name, static_cast<uint32_t>(symbolIndex.size()));
+
+    // Records first, with string offsets relative to the blob
+    std::vector<uint32_t> pool;
+    std::string strings;
+    auto addRange = [&](const auto& values, uint32_t& start, uint32_t& count) {
+        start = static_cast<uint32_t>(pool.size());
+        count = static_cast<uint32_t>(values.size());
+        for (auto v : values) pool.push_back(static_cast<uint32_t>(v));
+    };
+    auto addString = [&](const std::string& s, uint32_t& offset, uint32_t& length) {
+        offset = static_cast<uint32_t>(strings.size());
+        length = static_cast<uint32_t>(s.size());
+        strings += s;
+    };
+
+    std::vector<FormulaRecord> formulas(store.size());
+    for (size_t id = 0; id < store.size(); ++id) {
+        const Formula& f = store.get(static_cast<FormulaId>(id));
+        FormulaRecord& r = formulas[id];
+        r.op = static_cast<uint32_t>(f.op);
+        addString(f.name, r.name, r.nameLength);
+        addRange(f.operands, r.operands, r.operandCount);
+        addRange(f.terms, r.terms, r.termCount);
+    }
+
+    const TermStore& termStore = store.termStore();
+    std::vector<TermRecord> terms(termStore.size());
+    for (size_t id = 0; id < termStore.size(); ++id) {
+        const Term& t = termStore.get(static_cast<TermId>(id));
+        TermRecord& r = terms[id];
+        r.kind = static_cast<uint32_t>(t.kind);
+        addString(t.name, r.name, r.nameLength);
+        addRange(t.args, r.args, r.argCount);
+    }
+
+    std::vector<PremiseRecord> premiseRecords(premises.size());
+    for (size_t i = 0; i < premises.size(); ++i) {
+        std::vector<uint32_t> ids;
+        for (const auto& s : premiseSymbols[i]) ids.push_back(symbolIndex.at(s));
+        premiseRecords[i].formula = static_cast<uint32_t>(premises[i]);
+        addRange(ids, premiseRecords[i].symbols, premiseRecords[i].symbolCount);
+    }
+
+    std::vector<SymbolRecord> symbols;
+    for (const auto& [name, list] : postings) {
+        SymbolRecord r;
+        addString(name, r.name, r.nameLength);
+        addRange(list, r.postings, r.postingCount);
+        symbols.push_back(r);
+    }
+
+    Header header;
+    std::memcpy(header.magic, Magic, sizeof(Magic));
+    header.version = Version;
+    header.formulaCount = static_cast<uint32_t>(formulas.size());
+    header.formulasOffset = sizeof(Header);
+    header.termCount = static_cast<uint32_t>(terms.size());
+    header.termsOffset = header.formulasOffset + header.formulaCount * sizeof(FormulaRecord);
+    header.premiseCount = static_cast<uint32_t>(premiseRecords.size());
+    header.premisesOffset = header.termsOffset + header.termCount * sizeof(TermRecord);
+    header.symbolCount = static_cast<uint32_t>(symbols.size());
+    header.symbolsOffset = header.premisesOffset + header.premiseCount * sizeof(PremiseRecord);
+    header.poolCount = static_cast<uint32_t>(pool.size());
+    header.poolOffset = header.symbolsOffset + header.symbolCount * sizeof(SymbolRecord);
+    uint32_t stringsOffset = header.poolOffset + header.poolCount * sizeof(uint32_t);
+
+    for (auto& r : formulas) r.name += stringsOffset;
+    for (auto& r : terms) r.name += stringsOffset;
+    for (auto& r : symbols) r.name += stringsOffset;
+
+    std::ofstream out(outPath, std::ios::binary);
+    if (!out) {
+        std::cerr << "[KB] Cannot write " << outPath << "\n";
+        return false;
+    }
+    auto write = [&](const auto& v) {
+        out.write(reinterpret_cast<const char*>(v.data()), static_cast<std::streamsize>(v.size() * sizeof(v[0])));
+    };
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    write(formulas);
+    write(terms);
+    write(premiseRecords);
+    write(symbols);
+    write(pool);
+    out.write(strings.data(), static_cast<std::streamsize>(strings.size()));
+    return static_cast<bool>(out);
+}
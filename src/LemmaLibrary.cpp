@@ -0,0 +1,369 @@
+#include "LemmaLibrary.h"
+#include "ProofChecker.h"
+#include "Utils.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+constexpr char Magic[8] = {'S', 'Y', 'L', 'L', 'E', 'M', 'M', 'A'};
+constexpr uint32_t Version = 1;
+
+// On-disk header; all integers are native-endian uint32
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t count;
+    uint32_t entriesOffset; // count entries, sorted by (key, name)
+    uint32_t byNameOffset;  // count entry indices, sorted by name
+};
+
+struct SourceLemma {
+    std::string name;
+    std::string premises;
+    std::string conclusion;
+    std::string proof;
+    uint32_t key = 0;
+};
+
+std::vector<std::string> splitPremises(std::string_view text) {
+    std::vector<std::string> out;
+    for (const auto& item : splitPremiseList(std::string(text)))
+        if (!trim(item).empty()) out.push_back(trim(item));
+    return out;
+}
+
+// Calls next() once per way pattern matches f, extending bindings, until a
+// call returns true. Bindings added for a match are undone before the next
+// one is tried and when every match has failed.
+bool matchInto(const FormulaStore& schema, FormulaId pattern, FormulaStore& store, FormulaId f,
+               Bindings& bindings, const std::function<bool()>& next) {
+    const Formula& p = schema.get(pattern);
+    if (p.op == Connective::Atom) {
+        auto [it, inserted] = bindings.emplace(pattern, f);
+        if (!inserted) return it->second == f && next();
+        if (next()) return true;
+        bindings.erase(pattern);
+        return false;
+    }
+
+    // Copied, as forming a group below may grow the store
+    std::vector<FormulaId> operands = store.get(f).operands;
+    Connective op = store.get(f).op;
+    if (op != p.op) return false;
+
+    if (p.op != Connective::And && p.op != Connective::Or) {
+        if (operands.size() != p.operands.size()) return false;
+        auto matchFrom = [&](auto& self, size_t i) -> bool {
+            if (i == operands.size()) return next();
+            return matchInto(schema, p.operands[i], store, operands[i], bindings,
+                             [&] { return self(self, i + 1); });
+        };
+        return matchFrom(matchFrom, 0);
+    }
+
+    // AC operands: each pattern operand takes one or more unused operands of
+    // f. A group of several has op at its head, so only a metavariable can
+    // take one; the others are placed first, one operand each.
+    if (operands.size() < p.operands.size()) return false;
+    std::vector<FormulaId> order;
+    for (FormulaId q : p.operands)
+        if (!schema.is(q, Connective::Atom)) order.push_back(q);
+    for (FormulaId q : p.operands)
+        if (schema.is(q, Connective::Atom)) order.push_back(q);
+
+    std::vector<char> used(operands.size(), 0);
+    size_t unused = operands.size();
+    std::vector<FormulaId> group;
+
+    auto assign = [&](auto& self, size_t k) -> bool {
+        if (k == order.size()) return unused == 0 && next();
+        FormulaId q = order[k];
+        auto rest = [&] { return self(self, k + 1); };
+
+        if (!schema.is(q, Connective::Atom)) {
+            for (size_t j = 0; j < operands.size(); ++j) {
+                if (used[j]) continue;
+                used[j] = 1, --unused;
+                if (matchInto(schema, q, store, operands[j], bindings, rest)) return true;
+                used[j] = 0, ++unused;
+            }
+            return false;
+        }
+
+        // A bound metavariable claims the operands of its formula
+        if (auto bound = bindings.find(q); bound != bindings.end()) {
+            std::vector<FormulaId> wanted = store.flatten(bound->second, p.op);
+            std::vector<size_t> claimed;
+            for (FormulaId g : wanted) {
+                size_t j = 0;
+                while (j < operands.size() && (used[j] || operands[j] != g)) ++j;
+                if (j == operands.size()) break;
+                used[j] = 1;
+                claimed.push_back(j);
+            }
+            unused -= claimed.size();
+            bool matched = claimed.size() == wanted.size() && rest();
+            unused += claimed.size();
+            for (size_t j : claimed) used[j] = 0;
+            return matched;
+        }
+
+        // An unbound one tries every group that leaves the rest an operand
+        // each, smallest first; the last one takes what is left
+        if (unused < order.size() - k) return false;
+        size_t largest = unused - (order.size() - k - 1);
+        size_t smallest = k + 1 == order.size() ? largest : 1;
+        auto choose = [&](auto& choose, size_t from, size_t left) -> bool {
+            if (left == 0) {
+                FormulaId g = group.size() == 1 ? group[0]
+                            : p.op == Connective::And ? store.conjoin(group) : store.disjoin(group);
+                return g != NoFormula && matchInto(schema, q, store, g, bindings, rest);
+            }
+            for (size_t j = from; j < operands.size(); ++j) {
+                if (used[j]) continue;
+                used[j] = 1, --unused;
+                group.push_back(operands[j]);
+                if (choose(choose, j + 1, left - 1)) return true;
+                group.pop_back();
+                used[j] = 0, ++unused;
+            }
+            return false;
+        };
+        for (size_t size = smallest; size <= largest; ++size)
+            if (choose(choose, 0, size)) return true;
+        return false;
+    };
+    return assign(assign, 0);
+}
+
+} // namespace
+
+struct LemmaLibrary::Entry {
+    uint32_t key; // Connective of the conclusion
+    uint32_t name, nameLength;
+    uint32_t premises, premisesLength;
+    uint32_t conclusion, conclusionLength;
+    uint32_t proof, proofLength;
+};
+
+bool forEachMatch(const FormulaStore& schema, FormulaId pattern, FormulaStore& store, FormulaId f,
+                  Bindings& bindings, const std::function<bool(const Bindings&)>& onMatch) {
+    return matchInto(schema, pattern, store, f, bindings, [&] { return onMatch(bindings); });
+}
+
+std::shared_ptr<const LemmaLibrary> LemmaLibrary::open(const std::string& path) {
+    std::shared_ptr<LemmaLibrary> library(new LemmaLibrary(path));
+    const MappedFile& file = library->file;
+
+    Header header;
+    if (!file.valid() || file.size() < sizeof(header)) {
+        std::cerr << "[LEMMA] Cannot read " << path << "\n";
+        return nullptr;
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+
+    uint64_t tableEnd = uint64_t(header.entriesOffset) + uint64_t(header.count) * sizeof(Entry);
+    uint64_t indexEnd = uint64_t(header.byNameOffset) + uint64_t(header.count) * sizeof(uint32_t);
+    if (std::memcmp(header.magic, Magic, sizeof(Magic)) != 0 || header.version != Version ||
+        tableEnd > file.size() || indexEnd > file.size()) {
+        std::cerr << "[LEMMA] " << path << " is not a compiled lemma library\n";
+        return nullptr;
+    }
+
+    library->count = header.count;
+    library->entriesOffset = header.entriesOffset;
+    library->byNameOffset = header.byNameOffset;
+    return library;
+}
+
+LemmaLibrary::Entry LemmaLibrary::entry(uint32_t index) const {
+    Entry e;
+    std::memcpy(&e, file.data() + entriesOffset + size_t(index) * sizeof(Entry), sizeof(Entry));
+    return e;
+}
+
+std::string_view LemmaLibrary::text(uint32_t offset, uint32_t length) const {
+    if (uint64_t(offset) + length > file.size()) return {};
+    return std::string_view(file.data() + offset, length);
+}
+
+std::pair<uint32_t, uint32_t> LemmaLibrary::byConclusion(Connective op) const {
+    uint32_t key = static_cast<uint32_t>(op);
+    uint32_t lo = 0, hi = count;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (entry(mid).key < key) lo = mid + 1; else hi = mid;
+    }
+    uint32_t first = lo;
+    hi = count;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (entry(mid).key <= key) lo = mid + 1; else hi = mid;
+    }
+    return {first, lo};
+}
+
+std::optional<uint32_t> LemmaLibrary::find(std::string_view wanted) const {
+    auto indexAt = [&](uint32_t i) {
+        uint32_t index;
+        std::memcpy(&index, file.data() + byNameOffset + size_t(i) * sizeof(uint32_t), sizeof(index));
+        return index;
+    };
+
+    uint32_t lo = 0, hi = count;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (name(indexAt(mid)) < wanted) lo = mid + 1; else hi = mid;
+    }
+    if (lo < count && name(indexAt(lo)) == wanted) return indexAt(lo);
+    return std::nullopt;
+}
+
+std::string_view LemmaLibrary::name(uint32_t index) const {
+    Entry e = entry(index);
+    return text(e.name, e.nameLength);
+}
+
+std::string_view LemmaLibrary::proofText(uint32_t index) const {
+    Entry e = entry(index);
+    return text(e.proof, e.proofLength);
+}
+
+std::optional<Lemma> LemmaLibrary::lemma(uint32_t index) const {
+    if (index >= count) return std::nullopt;
+    Entry e = entry(index);
+
+    Lemma out;
+    out.name = std::string(text(e.name, e.nameLength));
+    for (const auto& p : splitPremises(text(e.premises, e.premisesLength))) {
+        auto parsed = out.schema.parse(p);
+        if (!parsed) return std::nullopt;
+        out.premises.push_back(*parsed);
+    }
+
+    auto parsed = out.schema.parse(std::string(text(e.conclusion, e.conclusionLength)));
+    if (!parsed) return std::nullopt;
+    out.conclusion = *parsed;
+    return out;
+}
+
+bool LemmaLibrary::compile(const std::string& sourcePath, const std::string& outPath) {
+    std::ifstream in(sourcePath);
+    if (!in) {
+        std::cerr << "[LEMMA] Cannot open " << sourcePath << "\n";
+        return false;
+    }
+
+    std::vector<SourceLemma> lemmas;
+    SourceLemma* current = nullptr;
+    bool inProof = false;
+    std::string raw;
+    int lineNo = 0;
+
+    while (std::getline(in, raw)) {
+        lineNo++;
+        std::string line = trim(raw);
+
+        if (inProof) {
+            if (line == "end") inProof = false;
+            else current->proof += raw + "\n";
+            continue;
+        }
+        if (line.empty() || line[0] == '#') continue;
+
+        if (line.rfind("lemma ", 0) == 0) {
+            current = &lemmas.emplace_back();
+            current->name = trim(line.substr(6));
+        } else if (!current) {
+            std::cerr << "[LEMMA] " << sourcePath << ":" << lineNo << ": expected 'lemma NAME'\n";
+            return false;
+        } else if (line.rfind("premises:", 0) == 0) {
+            current->premises = trim(line.substr(9));
+        } else if (line.rfind("conclusion:", 0) == 0) {
+            current->conclusion = trim(line.substr(11));
+        } else if (line == "proof:") {
+            inProof = true;
+        } else {
+            std::cerr << "[LEMMA] " << sourcePath << ":" << lineNo << ": unexpected '" << line << "'\n";
+            return false;
+        }
+    }
+
+    // Only lemmas whose stored proof checks are admitted
+    for (auto& lemma : lemmas) {
+        FormulaStore schema;
+        auto conclusion = schema.parse(lemma.conclusion);
+        if (lemma.name.empty() || !conclusion) {
+            std::cerr << "[LEMMA] " << lemma.name << ": missing name or conclusion\n";
+            return false;
+        }
+        lemma.key = static_cast<uint32_t>(schema.get(*conclusion).op);
+
+        std::stringstream proofText(lemma.proof);
+        ProofChecker checker;
+        CheckResult result = checker.check(ProofChecker::parseProofText(proofText),
+                                           splitPremises(lemma.premises), lemma.conclusion);
+        if (!result.valid) {
+            std::cerr << "[LEMMA] " << lemma.name << ": proof fails at line "
+                      << result.line << ": " << result.message << "\n";
+            return false;
+        }
+    }
+
+    std::sort(lemmas.begin(), lemmas.end(), [](const SourceLemma& a, const SourceLemma& b) {
+        return a.key != b.key ? a.key < b.key : a.name < b.name;
+    });
+    for (size_t i = 1; i < lemmas.size(); ++i) {
+        if (lemmas[i].name == lemmas[i - 1].name) {
+            std::cerr << "[LEMMA] Duplicate lemma " << lemmas[i].name << "\n";
+            return false;
+        }
+    }
+
+    uint32_t n = static_cast<uint32_t>(lemmas.size());
+    Header header;
+    std::memcpy(header.magic, Magic, sizeof(Magic));
+    header.version = Version;
+    header.count = n;
+    header.entriesOffset = sizeof(Header);
+    header.byNameOffset = header.entriesOffset + n * sizeof(Entry);
+
+    std::vector<uint32_t> byName(n);
+    for (uint32_t i = 0; i < n; ++i) byName[i] = i;
+    std::sort(byName.begin(), byName.end(), [&](uint32_t a, uint32_t b) {
+        return lemmas[a].name < lemmas[b].name;
+    });
+
+    std::string strings;
+    uint32_t stringsOffset = header.byNameOffset + n * sizeof(uint32_t);
+    auto store = [&](const std::string& s, uint32_t& offset, uint32_t& length) {
+        offset = stringsOffset + static_cast<uint32_t>(strings.size());
+        length = static_cast<uint32_t>(s.size());
+        strings += s;
+    };
+
+    std::vector<Entry> entries(n);
+    for (uint32_t i = 0; i < n; ++i) {
+        entries[i].key = lemmas[i].key;
+        store(lemmas[i].name, entries[i].name, entries[i].nameLength);
+        store(lemmas[i].premises, entries[i].premises, entries[i].premisesLength);
+        store(lemmas[i].conclusion, entries[i].conclusion, entries[i].conclusionLength);
+        store(lemmas[i].proof, entries[i].proof, entries[i].proofLength);
+    }
+
+    std::ofstream out(outPath, std::ios::binary);
+    if (!out) {
+        std::cerr << "[LEMMA] Cannot write " << outPath << "\n";
+        return false;
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(entries.data()), n * sizeof(Entry));
+    out.write(reinterpret_cast<const char*>(byName.data()), n * sizeof(uint32_t));
+    out.write(strings.data(), static_cast<std::streamsize>(strings.size()));
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,422 @@
+#include "ProblemCorpus.h"
+#include <array>
+#include <deque>
+#include <initializer_list>
+#include <iostream>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define CORPUS_SSE2 1
+#endif
+
+namespace {
+
+// A small set of bytes matched 16 at a time: each block is compared against
+// every member and the hits are read off one movemask. Where SSE2 is
+// unavailable the same masks are built bytewise.
+class ByteSet {
+public:
+    ByteSet(std::initializer_list<char> bytes) {
+        for (char b : bytes) {
+            members[count++] = b;
+            table[static_cast<unsigned char>(b)] = true;
+        }
+    }
+
+    // Bit i set when p[i] is in the set, for the first min(n, 16) bytes
+    unsigned block(const char* p, size_t n) const {
+#ifdef CORPUS_SSE2
+        if (n >= 16) {
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            __m128i hits = _mm_setzero_si128();
+            for (size_t i = 0; i < count; ++i)
+                hits = _mm_or_si128(hits, _mm_cmpeq_epi8(bytes, _mm_set1_epi8(members[i])));
+            return static_cast<unsigned>(_mm_movemask_epi8(hits));
+        }
+#endif
+        unsigned mask = 0;
+        for (size_t i = 0; i < n && i < 16; ++i)
+            if (table[static_cast<unsigned char>(p[i])]) mask |= 1u << i;
+        return mask;
+    }
+
+    // First byte of [p, end) in the set, or end
+    const char* find(const char* p, const char* end) const {
+        for (; p < end; p += 16)
+            if (unsigned mask = block(p, end - p)) return p + lowestBit(mask);
+        return end;
+    }
+
+    static unsigned lowestBit(unsigned mask) {
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast<unsigned>(__builtin_ctz(mask));
+#else
+        unsigned i = 0;
+        while (!(mask & 1u)) mask >>= 1, ++i;
+        return i;
+#endif
+    }
+
+private:
+    std::array<char, 8> members{};
+    size_t count = 0;
+    std::array<bool, 256> table{};
+};
+
+// The positions of a ByteSet's bytes in [begin, end), in order. Each block
+// is masked once and its hits are consumed bit by bit, so the cost follows
+// the number of blocks and hits rather than restarting the search per hit.
+class Matches {
+public:
+    Matches(const ByteSet& set, const char* begin, const char* end) : set(set), base(begin), end(end) { load(); }
+
+    // The next match, or end
+    const char* next() {
+        while (!mask) {
+            base += 16;
+            if (base >= end) return end;
+            load();
+        }
+        const char* hit = base + ByteSet::lowestBit(mask);
+        mask &= mask - 1;
+        return hit;
+    }
+
+    // Continues from p, skipping anything before it
+    void seek(const char* p) {
+        base = p;
+        load();
+    }
+
+private:
+    void load() { mask = base < end ? set.block(base, end - base) : 0; }
+
+    const ByteSet& set;
+    const char* base;
+    const char* end;
+    unsigned mask = 0;
+};
+
+// Line ends, premise commas, nesting, and the first byte of each side
+// separator (; |- ⊢); 0xE2 also starts ∀ and ∃, which are passed over
+const ByteSet TextStructure{'\n', ',', '(', ')', ';', '|', '\xE2'};
+const ByteSet PremiseStructure{',', '(', ')'};
+const ByteSet LineEnd{'\n'};
+const ByteSet JsonStringEnd{'"', '\\'};
+
+constexpr std::string_view Turnstile = "⊢";
+
+std::string_view trimView(std::string_view s) {
+    size_t first = s.find_first_not_of(" \t\r");
+    if (first == std::string_view::npos) return {};
+    size_t last = s.find_last_not_of(" \t\r");
+    return s.substr(first, last - first + 1);
+}
+
+std::string_view span(const char* from, const char* to) {
+    return {from, static_cast<size_t>(to - from)};
+}
+
+// Appends the comma-separated items of text outside parentheses
+void splitPremises(std::string_view text, std::vector<std::string_view>& out) {
+    text = trimView(text);
+    if (text.empty()) return;
+
+    const char* end = text.data() + text.size();
+    const char* item = text.data();
+    int depth = 0;
+    Matches matches(PremiseStructure, item, end);
+    for (const char* p = matches.next(); p < end; p = matches.next()) {
+        if (*p == '(') depth++;
+        else if (*p == ')') depth--;
+        else if (depth == 0) {
+            out.push_back(trimView(span(item, p)));
+            item = p + 1;
+        }
+    }
+    out.push_back(trimView(span(item, end)));
+}
+
+// Width of the side separator at p (;, |- or ⊢), 0 if there is none
+size_t separatorAt(const char* p, const char* end) {
+    if (*p == ';') return 1;
+    if (*p == '|') return p + 1 < end && p[1] == '-' ? 2 : 0;
+    return span(p, end).substr(0, Turnstile.size()) == Turnstile ? Turnstile.size() : 0;
+}
+
+void appendUtf8(unsigned code, std::string& out) {
+    if (code < 0x80) {
+        out += static_cast<char>(code);
+    } else if (code < 0x800) {
+        out += static_cast<char>(0xC0 | (code >> 6));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    } else if (code < 0x10000) {
+        out += static_cast<char>(0xE0 | (code >> 12));
+        out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (code >> 18));
+        out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    }
+}
+
+// Just enough JSON for one flat object per line. Strings without escapes
+// are returned as views into the line; the rare escaped one is decoded into
+// scratch, which outlives the record's visit.
+class JsonRecord {
+public:
+    JsonRecord(std::string_view line, std::deque<std::string>& scratch)
+        : p(line.data()), end(line.data() + line.size()), scratch(scratch) {}
+
+    bool parse(CorpusRecord& record) {
+        bool sawConclusion = false;
+        if (!consume('{')) return false;
+        if (consume('}')) return false;
+        do {
+            std::string_view key;
+            if (!string(key) || !consume(':')) return false;
+
+            if (key == "premises") {
+                if (consume('[')) {
+                    if (consume(']')) continue;
+                    do {
+                        std::string_view item;
+                        if (!string(item)) return false;
+                        record.premises.push_back(trimView(item));
+                    } while (consume(','));
+                    if (!consume(']')) return false;
+                } else {
+                    std::string_view list;
+                    if (!string(list)) return false;
+                    splitPremises(list, record.premises);
+                }
+            } else if (key == "conclusion") {
+                if (!string(record.conclusion)) return false;
+                record.conclusion = trimView(record.conclusion);
+                sawConclusion = true;
+            } else if (!skipValue()) {
+                return false;
+            }
+        } while (consume(','));
+        if (!consume('}')) return false;
+        skipSpace();
+        return p == end && sawConclusion && !record.conclusion.empty();
+    }
+
+private:
+    const char* p;
+    const char* end;
+    std::deque<std::string>& scratch;
+
+    void skipSpace() {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) ++p;
+    }
+
+    bool consume(char c) {
+        skipSpace();
+        if (p < end && *p == c) {
+            ++p;
+            return true;
+        }
+        return false;
+    }
+
+    bool string(std::string_view& out) {
+        if (!consume('"')) return false;
+        const char* start = p;
+        const char* stop = JsonStringEnd.find(p, end);
+        if (stop == end) return false;
+        if (*stop == '"') {
+            out = {start, static_cast<size_t>(stop - start)};
+            p = stop + 1;
+            return true;
+        }
+
+        std::string& decoded = scratch.emplace_back(start, stop - start);
+        for (p = stop; p < end && *p != '"'; ++p) {
+            if (*p != '\\') {
+                decoded += *p;
+                continue;
+            }
+            if (++p == end) return false;
+            switch (*p) {
+                case '"': case '\\': case '/': decoded += *p; break;
+                case 'b': decoded += '\b'; break;
+                case 'f': decoded += '\f'; break;
+                case 'n': decoded += '\n'; break;
+                case 'r': decoded += '\r'; break;
+                case 't': decoded += '\t'; break;
+                case 'u': {
+                    unsigned code = 0;
+                    if (!hex4(code)) return false;
+                    if (code >= 0xD800 && code < 0xDC00) {
+                        unsigned low = 0;
+                        if (end - p < 3 || p[1] != '\\' || p[2] != 'u') return false;
+                        p += 2;
+                        if (!hex4(low) || low < 0xDC00 || low >= 0xE000) return false;
+                        code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    appendUtf8(code, decoded);
+                    break;
+                }
+                default: return false;
+            }
+        }
+        if (p == end) return false;
+        ++p;
+        out = decoded;
+        return true;
+    }
+
+    // The four digits after \u; leaves p on the last one
+    bool hex4(unsigned& code) {
+        if (end - p < 5) return false;
+        for (int i = 0; i < 4; ++i) {
+            char c = *++p;
+            code <<= 4;
+            if (c >= '0' && c <= '9') code |= c - '0';
+            else if (c >= 'a' && c <= 'f') code |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F') code |= c - 'A' + 10;
+            else return false;
+        }
+        return true;
+    }
+
+    // Any other value: scalars up to the next , or }, containers by nesting
+    bool skipValue() {
+        skipSpace();
+        int depth = 0;
+        while (p < end) {
+            char c = *p;
+            if (c == '"') {
+                std::string_view ignored;
+                if (!string(ignored)) return false;
+                continue;
+            }
+            if (c == '{' || c == '[') depth++;
+            else if (c == '}' || c == ']') {
+                if (depth == 0) return true;
+                depth--;
+            } else if (c == ',' && depth == 0) {
+                return true;
+            }
+            ++p;
+        }
+        return false;
+    }
+};
+
+} // namespace
+
+ProblemCorpus::ProblemCorpus(const std::string& path) : path(path), file(path) {
+    if (!file.valid()) std::cerr << "[CORPUS] Cannot open " << path << "\n";
+}
+
+size_t ProblemCorpus::lineCount() const {
+    if (!file.valid()) return 0;
+
+    const char* end = file.data() + file.size();
+    size_t count = 0;
+    for (const char* p = file.data(); p < end; ++count) {
+        const char* eol = LineEnd.find(p, end);
+        p = eol < end ? eol + 1 : end;
+    }
+    return count;
+}
+
+// One pass over the mapping: text records are split at the structural
+// bytes as they stream past; JSON records and comments are handed the
+// whole line and the scan resumes after it.
+size_t ProblemCorpus::forEach(const std::function<void(const CorpusRecord&)>& visit) const {
+    if (!file.valid()) return 0;
+
+    const char* p = file.data();
+    const char* end = p + file.size();
+    Matches matches(TextStructure, p, end);
+    CorpusRecord record;
+    std::deque<std::string> scratch;
+    size_t malformed = 0;
+
+    for (size_t lineNo = 1; p < end; ++lineNo) {
+        const char* first = p;
+        while (first < end && (*first == ' ' || *first == '\t' || *first == '\r')) ++first;
+
+        record.line = lineNo;
+        record.premises.clear();
+        record.conclusion = {};
+        bool ok;
+
+        if (first == end || *first == '\n' || *first == '#' || *first == '{') {
+            const char* eol = LineEnd.find(first, end);
+            p = eol < end ? eol + 1 : end;
+            matches.seek(p);
+            if (first == eol || *first == '#') continue;
+            scratch.clear();
+            ok = JsonRecord(trimView(span(first, eol)), scratch).parse(record);
+        } else {
+            const char* item = first;
+            const char* separator = nullptr;
+            const char* eol = end;
+            size_t width = 0;
+            int depth = 0;
+            for (const char* q = matches.next(); q < end; q = matches.next()) {
+                if (*q == '\n') {
+                    eol = q;
+                    break;
+                }
+                if (separator) continue;
+                if (*q == '(') depth++;
+                else if (*q == ')') depth--;
+                else if (depth > 0) continue;
+                else if (*q == ',') {
+                    record.premises.push_back(trimView(span(item, q)));
+                    item = q + 1;
+                } else if ((width = separatorAt(q, end)) > 0) {
+                    std::string_view last = trimView(span(item, q));
+                    if (!last.empty() || !record.premises.empty()) record.premises.push_back(last);
+                    separator = q;
+                }
+            }
+            if (separator) record.conclusion = trimView(span(separator + width, eol));
+            ok = separator && !record.conclusion.empty();
+            p = eol < end ? eol + 1 : end;
+        }
+
+        if (!ok) {
+            std::cerr << "[CORPUS] " << path << ":" << lineNo << ": expected premises |- conclusion\n";
+            malformed++;
+            continue;
+        }
+        visit(record);
+    }
+    return malformed;
+}
+
+size_t ProblemCorpus::parseAll(FormulaStore& store,
+                               const std::function<void(const CorpusRecord&, const std::vector<FormulaId>&, FormulaId)>& visit) const {
+    std::vector<FormulaId> premises;
+    size_t unparsed = 0;
+
+    size_t malformed = forEach([&](const CorpusRecord& record) {
+        premises.clear();
+        for (std::string_view text : record.premises) {
+            auto parsed = store.parse(text);
+            if (!parsed) {
+                std::cerr << "[CORPUS] " << path << ":" << record.line << ": cannot parse '" << text << "'\n";
+                unparsed++;
+                return;
+            }
+            premises.push_back(*parsed);
+        }
+        auto goal = store.parse(record.conclusion);
+        if (!goal) {
+            std::cerr << "[CORPUS] " << path << ":" << record.line << ": cannot parse '" << record.conclusion << "'\n";
+            unparsed++;
+            return;
+        }
+        visit(record, premises, *goal);
+    });
+    return malformed + unparsed;
+}
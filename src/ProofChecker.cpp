@@ -0,0 +1,313 @@
+#include "ProofChecker.h"
+#include "CarnapRules.h"
+#include "Utils.h"
+#include <algorithm>
+#include <sstream>
+#include <unordered_set>
+
+namespace {
+
+struct Frame {
+    int showLine;
+    FormulaId show;
+    LayoutId shown; // the Show line's formula as written
+    int indent;
+    LayoutId assumption = NoLayout;
+};
+
+CheckResult fail(int line, const std::string& message) {
+    return {false, line, message};
+}
+
+} // namespace
+
+ProofChecker::ProofChecker(const LemmaLibrary* lemmas) : lemmas(lemmas) {}
+
+const Lemma* ProofChecker::findLemma(const std::string& name) {
+    if (!lemmas) return nullptr;
+    auto it = lemmaCache.find(name);
+    if (it == lemmaCache.end()) {
+        auto index = lemmas->find(name);
+        it = lemmaCache.emplace(name, index ? lemmas->lemma(*index) : std::nullopt).first;
+    }
+    return it->second ? &*it->second : nullptr;
+}
+
+CheckResult ProofChecker::check(const std::vector<Statement>& lines,
+                                const std::vector<std::string>& premises,
+                                const std::string& conclusion) {
+    // Premises and conclusion are compared as written, not modulo AC
+    std::unordered_set<LayoutId> given;
+    for (const auto& p : premises) {
+        auto parsed = formulas.parseLayout(p);
+        if (!parsed) return fail(0, "cannot parse premise: " + p);
+        given.insert(*parsed);
+    }
+
+    LayoutId goal = NoLayout;
+    if (!trim(conclusion).empty()) {
+        auto parsed = formulas.parseLayout(conclusion);
+        if (!parsed) return fail(0, "cannot parse conclusion: " + conclusion);
+        goal = *parsed;
+    }
+
+    // Per-line state, indexed by line number
+    size_t n = lines.size();
+    std::vector<FormulaId> formulaOf(n + 1, NoFormula);
+    std::vector<LayoutId> layoutOf(n + 1, NoLayout);
+    std::vector<int> frameOf(n + 1, -1);
+    std::vector<char> isShow(n + 1, 0);
+    std::vector<char> proved(n + 1, 0);
+
+    // Line on which each constant first occurs, and constants introduced by ED
+    std::unordered_map<TermId, int> firstSeen;
+    std::unordered_set<TermId> existentialConstants;
+    std::vector<TermId> termsOfLine;
+    auto noteConstants = [&](FormulaId f, int line) {
+        termsOfLine.clear();
+        formulas.collectGroundTerms(f, termsOfLine);
+        for (TermId t : termsOfLine)
+            if (formulas.termStore().get(t).kind == TermKind::Constant) firstSeen.emplace(t, line);
+    };
+
+    // A subproof's lines stay citable exactly as long as its frame is open
+    std::vector<Frame> frames;
+    std::vector<char> frameOpen;
+    std::vector<int> stack;
+    bool discharged = false;
+
+    auto citable = [&](int ref, int current) {
+        if (ref < 1 || ref >= current) return false;
+        if (formulaOf[ref] == NoFormula || frameOf[ref] < 0) return false;
+        if (!frameOpen[frameOf[ref]]) return false;
+        return !isShow[ref] || proved[ref];
+    };
+
+    auto negates = [&](LayoutId a, LayoutId b) {
+        return formulas.is(formulas.layout(a).formula, Connective::Not) && formulas.layout(a).operands[0] == b;
+    };
+
+    // Validates a DD/CD/ID closure of frame top; returns an error or ""
+    auto checkClosure = [&](const Frame& top, const std::string& rule,
+                            const std::vector<int>& refs, int current) -> std::string {
+        for (int ref : refs)
+            if (!citable(ref, current)) return "cites inaccessible line " + std::to_string(ref);
+
+        if (rule == "DD") {
+            if (refs.size() != 1 || layoutOf[refs[0]] != top.shown)
+                return "DD must cite a line holding the shown formula";
+            return "";
+        }
+        if (rule == "CD") {
+            if (!formulas.is(top.show, Connective::Implies))
+                return "CD requires a conditional Show line";
+            const auto& ops = formulas.layout(top.shown).operands;
+            if (top.assumption != ops[0]) return "CD assumption is not the antecedent";
+            if (refs.size() != 1 || layoutOf[refs[0]] != ops[1])
+                return "CD must cite a line holding the consequent";
+            return "";
+        }
+        if (rule == "ID") {
+            bool negatedGoal = top.assumption != NoLayout && (negates(top.assumption, top.shown) ||
+                                                              negates(top.shown, top.assumption));
+            if (!negatedGoal) return "ID assumption is not the negated goal";
+            if (refs.size() != 2 || !(negates(layoutOf[refs[0]], layoutOf[refs[1]]) ||
+                                      negates(layoutOf[refs[1]], layoutOf[refs[0]])))
+                return "ID must cite a formula and its negation";
+            return "";
+        }
+        if (rule == "UD") {
+            if (!formulas.is(top.show, Connective::ForAll) || top.assumption != NoLayout)
+                return "UD requires a universal Show line and no assumption";
+            if (refs.size() != 1) return "UD must cite one instance";
+
+            const Formula& show = formulas.get(top.show);
+            auto t = formulas.instanceTerm(show.operands[0], show.terms[0], formulaOf[refs[0]]);
+            if (!t) return "UD must cite an instance of the shown formula";
+            if (*t == NoTerm) return "";
+
+            auto seenAt = firstSeen.find(*t);
+            if (formulas.termStore().get(*t).kind != TermKind::Constant || existentialConstants.count(*t) ||
+                seenAt == firstSeen.end() || seenAt->second <= top.showLine)
+                return "UD instance constant is not arbitrary";
+            return "";
+        }
+        return "unknown closing rule " + rule;
+    };
+
+    auto closeTop = [&]() {
+        frameOpen[stack.back()] = 0;
+        proved[frames[stack.back()].showLine] = 1;
+        stack.pop_back();
+    };
+
+    for (size_t i = 0; i < n; ++i) {
+        const Statement& stmt = lines[i];
+        int num = static_cast<int>(i) + 1;
+        if (stmt.lineNumber != num) return fail(stmt.lineNumber, "line numbers must be consecutive");
+
+        std::string text = trim(stmt.expression);
+        const std::string& just = stmt.justification;
+
+        if (text.rfind("Show:", 0) == 0) {
+            if (stack.empty() && i != 0) return fail(num, "Show line after the proof was closed");
+
+            int expectedIndent = stack.empty() ? 0 : frames[stack.back()].indent + 1;
+            if (stmt.indentLevel != expectedIndent) return fail(num, "Show line at wrong indent");
+
+            auto shown = formulas.parseLayout(text.substr(5));
+            if (!shown) return fail(num, "cannot parse formula");
+            FormulaId f = formulas.layout(*shown).formula;
+            if (i == 0) {
+                if (goal == NoLayout) goal = *shown;
+                else if (*shown != goal) return fail(num, "line 1 does not show the conclusion");
+            }
+
+            formulaOf[num] = f;
+            layoutOf[num] = *shown;
+            isShow[num] = 1;
+            noteConstants(f, num);
+            frameOf[num] = stack.empty() ? -1 : stack.back();
+
+            stack.push_back(static_cast<int>(frames.size()));
+            frames.push_back({num, f, *shown, stmt.indentLevel});
+            frameOpen.push_back(1);
+            continue;
+        }
+
+        if (stack.empty()) return fail(num, "line outside any subproof");
+
+        // QED line: no expression, closes the innermost subproof in place
+        if (text.empty()) {
+            const Frame& top = frames[stack.back()];
+            if (stmt.indentLevel != top.indent) return fail(num, "closing line at wrong indent");
+
+            std::string error = checkClosure(top, just, stmt.references, num);
+            if (!error.empty()) return fail(num, error);
+
+            if (top.showLine == 1) discharged = true;
+            closeTop();
+            continue;
+        }
+
+        auto parsed = formulas.parseLayout(text);
+        if (!parsed) return fail(num, "cannot parse formula");
+        FormulaId f = formulas.layout(*parsed).formula;
+
+        // Result line one level out: closes the innermost subproof and states f
+        if (stmt.indentLevel == frames[stack.back()].indent - 1) {
+            const Frame& top = frames[stack.back()];
+            if (*parsed != top.shown) return fail(num, "result does not match the Show line");
+
+            std::string error = checkClosure(top, just, stmt.references, num);
+            if (!error.empty()) return fail(num, error);
+            closeTop();
+        } else if (stmt.indentLevel != frames[stack.back()].indent) {
+            return fail(num, "line at wrong indent");
+        } else if (just == "AS") {
+            Frame& top = frames[stack.back()];
+            if (num != top.showLine + 1 || top.showLine == 1)
+                return fail(num, "assumption must directly follow a subproof's Show line");
+            top.assumption = *parsed;
+        } else if (just == "PR") {
+            if (stack.size() != 1) return fail(num, "premise inside a subproof");
+            if (!given.empty() && !given.count(*parsed)) return fail(num, "not one of the given premises");
+        } else if (just == "UI" || just == "EG" || just == "ED") {
+            if (stmt.references.size() != 1) return fail(num, just + " expects 1 reference");
+            int ref = stmt.references[0];
+            if (!citable(ref, num)) return fail(num, "cites inaccessible line " + std::to_string(ref));
+
+            // UI and ED instantiate the cited quantifier; EG generalizes into f
+            FormulaId quantified = just == "EG" ? f : formulaOf[ref];
+            FormulaId instance = just == "EG" ? formulaOf[ref] : f;
+            Connective op = just == "UI" ? Connective::ForAll : Connective::Exists;
+            if (!formulas.is(quantified, op)) return fail(num, just + " needs a quantified formula");
+
+            const Formula& q = formulas.get(quantified);
+            auto t = formulas.instanceTerm(q.operands[0], q.terms[0], instance);
+            if (!t) return fail(num, just + " does not yield this formula");
+
+            if (just == "ED" && *t != NoTerm) {
+                if (formulas.termStore().get(*t).kind != TermKind::Constant || firstSeen.count(*t))
+                    return fail(num, "ED must instantiate with a new constant");
+                existentialConstants.insert(*t);
+            }
+        } else {
+            auto arity = carnapArity(just);
+            const Lemma* lemma = arity ? nullptr : findLemma(just);
+            if (!arity && !lemma) return fail(num, "unknown rule " + just);
+            if (lemma) arity = lemma->premises.size();
+
+            if (stmt.references.size() != *arity)
+                return fail(num, just + " expects " + std::to_string(*arity) + " references");
+
+            std::vector<FormulaId> cited;
+            std::vector<LayoutId> citedLayouts;
+            for (int ref : stmt.references) {
+                if (!citable(ref, num)) return fail(num, "cites inaccessible line " + std::to_string(ref));
+                cited.push_back(formulaOf[ref]);
+                citedLayouts.push_back(layoutOf[ref]);
+            }
+
+            if (lemma) {
+                // One consistent instantiation of the whole schema
+                Bindings bindings;
+                auto premisesFrom = [&](auto& self, size_t k) -> bool {
+                    if (k == *arity) return true;
+                    return forEachMatch(lemma->schema, lemma->premises[k], formulas, cited[k], bindings,
+                                        [&](const Bindings&) { return self(self, k + 1); });
+                };
+                bool matched = forEachMatch(lemma->schema, lemma->conclusion, formulas, f, bindings,
+                                            [&](const Bindings&) { return premisesFrom(premisesFrom, 0); });
+                if (!matched) return fail(num, just + " does not yield this formula");
+            } else if (!carnapStep(formulas, just, citedLayouts, *parsed)) {
+                return fail(num, just + " does not yield this formula");
+            }
+        }
+
+        formulaOf[num] = f;
+        layoutOf[num] = *parsed;
+        frameOf[num] = stack.back();
+        noteConstants(f, num);
+        if (stack.size() == 1 && *parsed == goal) discharged = true;
+    }
+
+    if (!discharged) return fail(static_cast<int>(n), "conclusion is not established");
+    return {};
+}
+
+std::vector<Statement> ProofChecker::parseProofText(std::istream& in) {
+    std::vector<Statement> lines;
+    std::string raw;
+
+    while (std::getline(in, raw)) {
+        size_t start = raw.find_first_not_of(' ');
+        if (start == std::string::npos) continue;
+
+        size_t dot = raw.find('.', start);
+        if (dot == std::string::npos) continue;
+
+        std::string number = raw.substr(start, dot - start);
+        if (number.empty() || number.find_first_not_of("0123456789") != std::string::npos) continue;
+
+        Statement stmt;
+        stmt.lineNumber = std::stoi(number);
+        stmt.indentLevel = static_cast<int>(start / 3);
+
+        std::string rest = trim(raw.substr(dot + 1));
+        size_t colon = rest.rfind(':');
+        if (rest.rfind("Show:", 0) == 0 || colon == std::string::npos) {
+            stmt.expression = rest;
+        } else {
+            stmt.expression = trim(rest.substr(0, colon));
+            std::stringstream ss(rest.substr(colon + 1));
+            ss >> stmt.justification;
+            int ref;
+            while (ss >> ref) stmt.references.push_back(ref);
+        }
+
+        lines.push_back(stmt);
+    }
+
+    return lines;
+}
@@ -1,9 +1,15 @@
 #include "ProofSolver.h"
+#include "HornProgram.h"
 #include "Utils.h"
 #include "Rules.h"
+#include "ProofChecker.h"
+#include "BinaryProof.h"
 #include <iostream>
 #include <sstream>
 #include <unordered_set>
+#include <algorithm>
+#include <thread>
+#include <tuple>
 
 void ProofSolver::readInput() {
     std::string input;
@@ -11,10 +17,8 @@ void ProofSolver::readInput() {
     std::cout << "\nEnter premises separated by commas:\n";
     std::getline(std::cin, input);
 
-    std::stringstream ss(input);
-    std::string item;
     premises.clear();  // Clear any leftover premises
-    while (std::getline(ss, item, ',')) {
+    for (const auto& item : splitPremiseList(input)) {
         premises.push_back(normalizeConnectives(trim(item)));
     }
 
@@ -28,399 +32,1559 @@ void ProofSolver::addRule(const Rule& rule) {
 }
 
 void ProofSolver::solve() {
+    stats = {};
+    if (portfolio) {
+        solvePortfolio();
+        return;
+    }
+    search();
+
+    // What the observer has seen, to restate what the rewrite changes
+    std::vector<Statement> reported;
+    if (lineObserver)
+        for (size_t i = 0; i < proof.size(); ++i) reported.push_back(statement(i));
+
+    dropUncitedImports();
+    proof = BinaryProofWriter(formulas).write(proof);
+    if (lineObserver) restate(reported);
+}
+
+void ProofSolver::SolveStats::merge(const SolveStats& other) {
+    combinations += other.combinations;
+    rounds += other.rounds;
+    maxCdDepth = std::max(maxCdDepth, other.maxCdDepth);
+    rulesSkipped += other.rulesSkipped;
+    targetsPruned += other.targetsPruned;
+    aborted = aborted || other.aborted;
+    lineCapped = lineCapped || other.lineCapped;
+}
+
+void ProofSolver::search() {
     rules = getAllRules();
-    proofLines.push_back({1, "Show: " + trim(conclusion), "", {}, 0});
+    if (reversedRules) std::reverse(rules.begin(), rules.end());
+    scheduler.reset(rules);
+
+    auto parsedGoal = formulas.parseLayout(conclusion);
+    if (!parsedGoal) {
+        if (diagnostics) std::cerr << "[ERROR] Could not parse conclusion: " << conclusion << "\n";
+        return;
+    }
+    goal = formulas.layout(*parsedGoal).formula;
+
+    appendLine(goal, ShowRule, {}, 0, *parsedGoal);
     showStack.push_back(0);
     currentIndent = 0;
 
-    int lineNum = 2;
+    RuleId premiseRule = proof.internRule("PR");
+    premiseText.clear();
     for (const auto& p : premises) {
-        proofLines.push_back({lineNum++, trim(p), "PR", {}, currentIndent});
+        auto parsed = formulas.parseLayout(p);
+        if (!parsed) {
+            if (diagnostics) std::cerr << "[ERROR] Could not parse premise: " << p << "\n";
+            continue;
+        }
+        premiseText.emplace(*parsed, p);
+        appendLine(formulas.layout(*parsed).formula, premiseRule, {}, currentIndent, *parsed);
+    }
+    importKnowledge();
+    if (decideHorn(goal)) return;
+
+    // Room for the X, ψ and R that D-MCC, ADD and D-EFQ introduce
+    std::vector<FormulaId> problem = {goal};
+    for (int line : scopes.accessible()) problem.push_back(proof.formula(line));
+    oracle.reset(EntailmentOracle::countAtoms(formulas, problem) + 3);
+    if (!mayFollow(goal)) {
+        if (diagnostics) std::cout << "[INFO] The conclusion does not follow from the premises\n";
+        return;
     }
 
-    std::unordered_set<std::string> attempted;
-    if (tryConditionalDerivation(conclusion, attempted)) return;
+    std::unordered_set<FormulaId> attempted;
 
-    if (tryDirectDerivation(conclusion)) {
-        displayProof();
-        return;
+    for (Strategy strategy : strategiesFor(goal)) {
+        switch (strategy) {
+            case Strategy::Conditional:
+                if (parallelSubproofs ? raceConditionalDerivation(goal, attempted)
+                                      : tryConditionalDerivation(goal, attempted)) return;
+                break;
+
+            case Strategy::Direct:
+                if (tryDirectDerivation(goal) || restateGiven(goal) || tryOneStep(goal) ||
+                    tryLemmaStep(goal) || tryReplacement(goal) || tryGeneralization(goal))
+                    return;
+                break;
+
+            case Strategy::Forward:
+                if (saturate(goal)) return;
+                break;
+
+            case Strategy::Indirect:
+                if (tryIndirectDerivation(goal)) return;
+                break;
+
+            case Strategy::Universal:
+                if (tryUniversalDerivation(goal, attempted)) return;
+                break;
+
+            case Strategy::Split:
+                if (trySplit(goal, attempted)) return;
+                break;
+        }
+
+        if (cancelled()) return;
     }
+}
 
-    for (const auto& stmt : proofLines) {
-        if (normalizeConnectives(trim(stmt.expression)) == normalizeConnectives(trim(conclusion))) {
-            displayProof();
-            return;
+// Puts target on an accessible line at the current level, trying the
+// strategies solve() would try for a goal of its shape. Used for the parts
+// of a split goal, which have no Show line of their own.
+bool ProofSolver::establish(FormulaId target, std::unordered_set<FormulaId>& attempted) {
+    if (derived.contains(target)) return true;
+
+    for (Strategy strategy : strategiesFor(target)) {
+        bool reached = false;
+        switch (strategy) {
+            case Strategy::Conditional: reached = tryConditionalDerivation(target, attempted); break;
+            case Strategy::Direct:
+                reached = tryOneStep(target) || tryLemmaStep(target) || tryReplacement(target) ||
+                          tryGeneralization(target);
+                break;
+            case Strategy::Forward: reached = saturate(target); break;
+            case Strategy::Indirect: reached = tryIndirectDerivation(target); break;
+            case Strategy::Universal: reached = tryUniversalDerivation(target, attempted); break;
+            case Strategy::Split: reached = trySplit(target, attempted); break;
         }
+        if (reached) return true;
+        if (cancelled()) return false;
     }
+    return false;
+}
 
-    std::cout << "\n[DEBUG] Running fallback rule application\n";
+// ADJ and CB backwards: a conjunction from each conjunct, a biconditional
+// from both conditionals, each established on its own first
+bool ProofSolver::trySplit(FormulaId target, std::unordered_set<FormulaId>& attempted) {
+    bool conjunction = formulas.is(target, Connective::And);
+    if (!conjunction && !formulas.is(target, Connective::Iff)) return false;
+    if (!mayFollow(target)) return false;
+
+    std::vector<FormulaId> parts = formulas.get(target).operands;
+    if (!conjunction) {
+        FormulaId left = parts[0], right = parts[1];
+        parts = {formulas.implies(left, right), formulas.implies(right, left)};
+    }
 
-    bool progress = true;
-    std::unordered_set<std::string> seen;
-    for (const auto& stmt : proofLines) {
-        seen.insert(normalizeConnectives(trim(stmt.expression)));
+    Checkpoint start = checkpoint();
+    for (FormulaId part : parts) {
+        if (!establish(part, attempted)) {
+            rollback(start);
+            return false;
+        }
     }
 
-    int iterationCount = 0;
-    int derivationCount = 0;
+    if (conjunction) adjoin(target);
+    else appendLine(target, proof.internRule("CB"),
+                    {proof.lineNumber(*derived.line(parts[0])), proof.lineNumber(*derived.line(parts[1]))},
+                    currentIndent);
+    return true;
+}
 
-    while (progress) {
-    progress = false;
-    iterationCount++;
-    if (iterationCount > 1000) {
-        std::cerr << "[ERROR] Aborting solve() — rule application exceeded 1000 iterations.\n";
-        break;
-    }
-
-    for (const auto& rule : rules) {
-        size_t n = rule.numPremises;
-        std::vector<int> indices(proofLines.size());
-        for (size_t i = 0; i < proofLines.size(); ++i)
-            indices[i] = static_cast<int>(i);
-
-        std::vector<std::vector<int>> combos;
-        std::function<void(size_t, std::vector<int>)> generateCombos =
-            [&](size_t start, std::vector<int> current) {
-                if (current.size() == n) {
-                    combos.push_back(current);
-                    return;
-                }
-                for (size_t i = start; i < indices.size(); ++i) {
-                    auto temp = current;
-                    temp.push_back(indices[i]);
-                    generateCombos(i + 1, temp);
+// Builds a conjunction whose conjuncts are all on lines, left to right by ADJ
+void ProofSolver::adjoin(FormulaId conjunction) {
+    auto numberOf = [&](FormulaId f) { return proof.lineNumber(*derived.line(f)); };
+    std::vector<FormulaId> ops = formulas.get(conjunction).operands; // conjoin may grow the store
+    FormulaId built = ops[0];
+    for (size_t i = 1; i < ops.size(); ++i) {
+        FormulaId next = formulas.conjoin(built, ops[i]);
+        if (!derived.contains(next)) {
+            int a = numberOf(built), b = numberOf(ops[i]);
+            appendLine(next, proof.internRule("ADJ"), {std::min(a, b), std::max(a, b)}, currentIndent);
+        }
+        built = next;
+    }
+}
+
+bool ProofSolver::decideHorn(FormulaId target) {
+    if (!HornProgram::conjunctionOfAtoms(formulas, target) || derived.contains(target)) return false;
+
+    HornProgram horn;
+    for (int line : scopes.accessible())
+        if (!horn.add(formulas, proof.formula(line), static_cast<size_t>(line))) return false;
+
+    auto steps = horn.derive(formulas, target);
+    if (diagnostics)
+        std::cout << "\n[DEBUG] Horn problem, decided by unit propagation: "
+                  << (steps ? "goal follows" : importTruncated ? "goal not reached from the capped import" : "goal does not follow")
+                  << "\n";
+    if (!steps) return true;
+
+    for (const HornProgram::Step& step : *steps) {
+        const HornProgram::Clause& clause = horn.clause(step.clause);
+        if (clause.antecedent != NoFormula && !derived.contains(clause.consequent)) {
+            if (!derived.contains(clause.antecedent)) adjoin(clause.antecedent);
+            int a = proof.lineNumber(clause.line), b = proof.lineNumber(*derived.line(clause.antecedent));
+            appendLine(clause.consequent, proof.internRule("MP"), {std::min(a, b), std::max(a, b)}, currentIndent);
+        }
+        for (FormulaId atom : step.atoms) hornLine(atom, clause.consequent);
+    }
+    if (!derived.contains(target)) adjoin(target);
+    return true;
+}
+
+void ProofSolver::hornLine(FormulaId atom, FormulaId from) {
+    // S splits off the first conjunct; walk the remainders until atom is one
+    FormulaId rest = from;
+    while (!derived.contains(atom)) {
+        FormulaId first = formulas.get(rest).operands[0];
+        FormulaId next = first == atom ? atom : formulas.withoutOperand(rest, 0);
+        if (!derived.contains(next))
+            appendLine(next, proof.internRule("S"), {proof.lineNumber(*derived.line(rest))}, currentIndent);
+        rest = next;
+    }
+}
+
+// Picks the order in which strategies are tried for a goal of a given shape.
+// A goal already present or one rule or lemma application away is always
+// tried first. Implications then go to CD and universal goals to UD.
+// Conjunctions and biconditionals are split into their conjuncts or
+// conditionals. Disjunctions are rarely reachable forward (ADD only
+// introduces a placeholder disjunct), and assuming the opposite of a negation
+// or sentence letter gives the search a line to refute, so these go to ID
+// before saturation. Everything else saturates first and falls back to ID
+// once the forward budget is exhausted.
+std::vector<ProofSolver::Strategy> ProofSolver::strategiesFor(FormulaId target) const {
+    std::vector<Strategy> list;
+    switch (formulas.get(target).op) {
+        case Connective::Implies:
+            list = {Strategy::Direct, Strategy::Conditional, Strategy::Forward, Strategy::Indirect};
+            break;
+        case Connective::ForAll:
+            list = {Strategy::Direct, Strategy::Universal, Strategy::Forward, Strategy::Indirect};
+            break;
+        case Connective::And:
+        case Connective::Iff:
+            list = {Strategy::Direct, Strategy::Split, Strategy::Forward, Strategy::Indirect};
+            break;
+        case Connective::Or:
+        case Connective::Not:
+        case Connective::Atom:
+            list = {Strategy::Direct, Strategy::Indirect, Strategy::Forward};
+            break;
+        default:
+            list = {Strategy::Direct, Strategy::Forward, Strategy::Indirect};
+            break;
+    }
+
+    // Portfolio variants move one strategy up behind the direct attempt
+    if (order != StrategyOrder::GoalShape) {
+        Strategy first = order == StrategyOrder::ForwardFirst ? Strategy::Forward : Strategy::Indirect;
+        auto it = std::find(list.begin(), list.end(), first);
+        if (it != list.end()) std::rotate(list.begin() + 1, it, it + 1);
+    }
+    return list;
+}
+
+// Runs solve() on one forked copy per configuration, each on its own thread,
+// taking configurations in order up to the hardware thread count so racers
+// never share a core. The first proof found wins: the others are cancelled,
+// the winner's state replaces ours and its configuration is recorded. If none
+// succeeds, the goal-shape configuration's attempt is kept.
+void ProofSolver::solvePortfolio() {
+    struct Configuration {
+        const char* name;
+        StrategyOrder order;
+        bool reversedRules;
+    };
+    static const Configuration configurations[] = {
+        {"cd-first", StrategyOrder::GoalShape, false},
+        {"forward-first", StrategyOrder::ForwardFirst, false},
+        {"indirect-first", StrategyOrder::IndirectFirst, false},
+        {"reversed-rules", StrategyOrder::GoalShape, true}
+    };
+    constexpr size_t count = sizeof(configurations) / sizeof(configurations[0]);
+
+    // One thread per core at most; the configurations beyond them queue, and
+    // each thread takes the next one when its last has failed
+    size_t threads = std::max<size_t>(1, std::min<size_t>(count, std::thread::hardware_concurrency()));
+
+    std::atomic<bool> done{false};
+    std::atomic<int> first{-1};
+    std::atomic<size_t> next{0};
+
+    // Forks start empty and take only our inputs and settings
+    std::vector<ProofSolver> forks(count);
+    auto run = [&]() {
+        for (size_t i = next++; i < count && !done; i = next++) {
+            ProofSolver& fork = forks[i];
+            fork.beautify = beautify;
+            fork.diagnostics = false;
+            fork.parallelSubproofs = parallelSubproofs;
+            fork.lineLimit = lineLimit;
+            fork.cancelFlag = &done;
+            fork.stopFlag = stopFlag;
+            fork.order = configurations[i].order;
+            fork.reversedRules = configurations[i].reversedRules;
+            fork.premises = premises;
+            fork.conclusion = conclusion;
+            fork.scheduler = scheduler;
+            fork.lemmas = lemmas;
+            fork.knowledgeBase = knowledgeBase;
+            fork.knowledgeLimit = knowledgeLimit;
+
+            fork.solve();
+            if (!fork.wasConclusionDerived()) continue;
+
+            int expected = -1;
+            if (first.compare_exchange_strong(expected, static_cast<int>(i)))
+                done = true;
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) workers.emplace_back(run);
+    for (auto& worker : workers) worker.join();
+
+    // Our own settings survive the swap; cancelFlag may be a caller's race
+    size_t won = first < 0 ? 0 : static_cast<size_t>(first.load());
+    auto observer = std::move(lineObserver);
+    auto retracts = std::move(retractObserver);
+    auto rounds = std::move(roundObserver);
+    const std::atomic<bool>* stop = stopFlag;
+    const std::atomic<bool>* cancel = cancelFlag;
+    bool verbose = diagnostics;
+
+    *this = std::move(forks[won]);
+    lineObserver = std::move(observer);
+    retractObserver = std::move(retracts);
+    roundObserver = std::move(rounds);
+    stopFlag = stop;
+    cancelFlag = cancel;
+    diagnostics = verbose;
+    portfolio = true;
+    order = StrategyOrder::GoalShape;
+    reversedRules = false;
+    winner = first < 0 ? "" : configurations[won].name;
+
+    if (lineObserver)
+        for (size_t i = 0; i < proof.size(); ++i) lineObserver(statement(i));
+}
+
+// Visits every k-subset of line indices [0, n) in lexicographic order until
+// visit returns true. combo is the caller's buffer, so a pass over all
+// subsets allocates nothing once it has held k indices.
+template <typename Visit>
+bool ProofSolver::forEachCombo(size_t n, size_t k, std::vector<int>& combo, Visit&& visit) {
+    if (k == 0 || k > n) return false;
+
+    combo.resize(k);
+    for (size_t i = 0; i < k; ++i) combo[i] = static_cast<int>(i);
+
+    while (true) {
+        if (visit(combo)) return true;
+
+        // Advance the rightmost index that still has room
+        size_t i = k;
+        while (i > 0 && combo[i - 1] == static_cast<int>(n - k + i - 1)) --i;
+        if (i == 0) return false;
+
+        combo[i - 1]++;
+        for (size_t j = i; j < k; ++j) combo[j] = combo[j - 1] + 1;
+    }
+}
+
+// Runs the scheduled rules once over all combinations of citable lines,
+// appending each new formula and reporting it to onDerived. A true return
+// from onDerived stops the round early. If throttling skipped rules and
+// nothing fired, the round is retried with every rule before reporting a stall.
+ProofSolver::RoundResult ProofSolver::applyRulesRound(const std::function<bool(size_t)>& onDerived) {
+    stats.rounds++;
+
+    // This round's buffers, kept from earlier rounds at the same depth, so a
+    // round that adds no line allocates nothing
+    if (roundBuffers.size() <= roundDepth) roundBuffers.emplace_back();
+    RoundBuffers& buffers = roundBuffers[roundDepth];
+    struct Nested {
+        ProofSolver& solver;
+        explicit Nested(ProofSolver& solver) : solver(solver) {
+            if (solver.roundObserver) solver.roundObserver(false, solver.proof.size());
+            ++solver.roundDepth;
+        }
+        ~Nested() {
+            --solver.roundDepth;
+            if (solver.roundObserver) solver.roundObserver(true, solver.proof.size());
+        }
+    } nested(*this);
+
+    // Budgeted by what the round adds, whatever the rules' hit rates: it may
+    // at most double the proof, so rules firing on every tuple (ADJ, DNI,
+    // ADD) grow it geometrically across rounds instead of quadratically
+    // within one
+    size_t roundLimit = proof.size() + std::max(proof.size(), MinRoundGrowth);
+
+    RoundResult quantified = instantiateQuantifiers(onDerived, buffers.instances);
+    if (quantified != RoundResult::Progress && quantified != RoundResult::Stalled) return quantified;
+
+    RoundResult bridged = bridgeEquivalences(onDerived, buffers.wanted);
+    if (bridged != RoundResult::Progress && bridged != RoundResult::Stalled) return bridged;
+
+    bool progress = quantified == RoundResult::Progress || bridged == RoundResult::Progress;
+    bool full = false;
+
+    // Not the shared buffers: onDerived may start a nested round
+    Conclusions& results = buffers.results;
+    std::vector<FormulaId>& exprs = buffers.exprs;
+    std::vector<int>& refs = buffers.refs;
+    std::vector<int>& indices = buffers.indices;
+    std::vector<int>& matching = buffers.matching;
+
+    while (true) {
+        scheduler.plan(full, buffers.order);
+        for (size_t r : buffers.order) {
+            const Rule& rule = rules[r];
+            if (!scopes.covers(rule.needs)) {
+                stats.rulesSkipped++;
+                continue;
+            }
+            bool fired = false;
+            RoundResult stop = RoundResult::Progress;
+
+            if (rule.kernel != Rule::Kernel::None) {
+                // Matched by sweeps, then written out in the order the pair
+                // loop below would find them. Pairs among lines swept before
+                // concluded what they could then, so only newer lines are.
+                std::vector<ImplicationMatch>& matches = buffers.matches;
+                size_t lines = implications.lines();
+                matches.clear();
+                if (cancelled()) stop = RoundResult::Cancelled;
+                else matchImplications(rule, std::min(sweptBy(rule), lines), matches);
+
+                // The view only grows while the matches are written, so
+                // their positions stay put
+                bool complete = stop == RoundResult::Progress;
+                for (const ImplicationMatch& match : matches) {
+                    FormulaId result = conclusionOf(rule, match);
+                    if (derived.contains(result)) continue;
+
+                    refs.clear();
+                    refs.push_back(proof.lineNumber(scopes.accessible()[match.lo]));
+                    refs.push_back(proof.lineNumber(scopes.accessible()[match.hi]));
+                    appendLine(result, proof.internRule(rule.name), refs, currentIndent);
+                    progress = fired = true;
+
+                    if (onDerived(proof.size() - 1)) {
+                        stop = RoundResult::Stopped;
+                        break;
+                    }
+                    if (outOfLines()) {
+                        stop = RoundResult::Exhausted;
+                        break;
+                    }
+                    if (proof.size() >= roundLimit) {
+                        complete = false;
+                        break;
+                    }
                 }
-            };
-        generateCombos(0, {});
-
-        for (const auto& combo : combos) {
-            std::vector<std::string> exprs;
-            bool skipCombo = false;
-
-            for (int idx : combo) {
-                std::string expr = trim(proofLines[idx].expression);
-                if (expr.rfind("Show:", 0) == 0) {
-                    skipCombo = true;
-                    break;
+                if (complete && stop == RoundResult::Progress) sweptBy(rule) = lines;
+
+                scheduler.record(r, fired);
+                if (stop != RoundResult::Progress) return stop;
+                if (proof.size() >= roundLimit) {
+                    scheduler.cutOff(r);
+                    return RoundResult::Progress;
                 }
-                exprs.push_back(normalizeConnectives(expr));
+                continue;
             }
 
-            if (skipCombo || exprs.size() != rule.numPremises)
-                continue;
+            // Combinations range over accessible lines only; lines appended
+            // while a rule runs join the view from the next rule on
+            const std::vector<int>& candidates = premiseLines(rule, matching);
+            if (scheduler.overBudget(r, candidates.size())) continue;
+
+            forEachCombo(candidates.size(), rule.numPremises, indices, [&](const std::vector<int>& combo) {
+                if (cancelled()) {
+                    stop = RoundResult::Cancelled;
+                    return true;
+                }
+
+                exprs.clear();
+                for (int pos : combo) exprs.push_back(proof.formula(candidates[pos]));
+                if (!coversNeeds(rule, exprs)) return false;
+                stats.combinations++;
+
+                results.clear();
+                rule.apply(formulas, exprs, results);
+
+                refs.clear();
+                for (FormulaId result : results) {
+                    if (derived.contains(result)) continue;
+
+                    if (refs.empty())
+                        for (int pos : combo) refs.push_back(proof.lineNumber(candidates[pos]));
 
-            std::optional<std::string> result = rule.apply(exprs);
-            if (result) {
-                std::string trimmedResult = normalizeConnectives(trim(*result));
-                if (seen.find(trimmedResult) == seen.end()) {
-                    derivationCount++;
-                    if (derivationCount % 100 == 0) {
-                        std::cout << "[INFO] Derived " << derivationCount << " formulas...\n";
+                    appendLine(result, proof.internRule(rule.name), refs, currentIndent);
+                    progress = fired = true;
+
+                    if (onDerived(proof.size() - 1)) {
+                        stop = RoundResult::Stopped;
+                        return true;
+                    }
+                    if (outOfLines()) {
+                        stop = RoundResult::Exhausted;
+                        return true;
                     }
+                    if (proof.size() >= roundLimit) return true;
+                }
+                return false;
+            });
+
+            scheduler.record(r, fired);
+            if (stop != RoundResult::Progress) return stop;
+            if (proof.size() >= roundLimit) {
+                scheduler.cutOff(r);
+                return RoundResult::Progress;
+            }
+        }
+
+        if (progress || full || !scheduler.lastPlanThrottled()) break;
+        full = true;
+    }
+
+    return progress ? RoundResult::Progress : RoundResult::Stalled;
+}
+
+bool ProofSolver::coversNeeds(const Rule& rule, const std::vector<FormulaId>& premises) const {
+    ShapeMask heads = 0;
+    for (FormulaId premise : premises) heads |= shapeBit(formulas.get(premise).op);
+    return (heads & rule.needs) == rule.needs;
+}
+
+size_t& ProofSolver::sweptBy(const Rule& rule) {
+    return rule.kernel == Rule::Kernel::ModusPonens ? swept.ponens : swept.tollens;
+}
+
+// Each fact from position from on is swept against the antecedents (MP) or,
+// when negated, the consequents (MT) of every accessible implication; each
+// implication from there on against the facts before it
+void ProofSolver::matchImplications(const Rule& rule, size_t from, std::vector<ImplicationMatch>& matches) {
+    if (implications.size() == 0) return;
+
+    bool ponens = rule.kernel == Rule::Kernel::ModusPonens;
+    size_t count = implications.lines();
+    for (size_t pos = from; pos < count; ++pos) {
+        FormulaId fact = implications.fact(pos);
+        hits.clear();
+        if (ponens) implications.withAntecedent(fact, hits);
+        else if (formulas.is(fact, Connective::Not)) implications.withConsequent(formulas.get(fact).operands[0], hits);
+        else continue;
+        stats.combinations += implications.size();
+
+        int at = static_cast<int>(pos);
+        for (size_t i : hits) {
+            int other = implications.position(i);
+            if (other == at) continue;
+            FormulaId source = ponens ? implications.consequent(i) : implications.antecedent(i);
+            matches.push_back({std::min(at, other), std::max(at, other), other < at, source});
+        }
+    }
+
+    for (size_t i = implications.firstAt(from); i < implications.size() && from > 0; ++i) {
+        // MP needs the antecedent on a line, MT the negated consequent
+        FormulaId partner = implications.antecedent(i);
+        if (!ponens) {
+            FormulaStore::Probe probe(formulas);
+            partner = formulas.negate(implications.consequent(i));
+        }
+        if (partner == NoFormula) continue;
+
+        factHits.clear();
+        implications.withFact(partner, from, factHits);
+        stats.combinations += from;
+
+        int at = implications.position(i);
+        FormulaId source = ponens ? implications.consequent(i) : implications.antecedent(i);
+        for (size_t pos : factHits)
+            matches.push_back({static_cast<int>(pos), at, false, source});
+    }
+
+    // Pair order, and within a pair the implication second first, as apply tries them
+    std::sort(matches.begin(), matches.end(), [](const ImplicationMatch& a, const ImplicationMatch& b) {
+        return std::tie(a.lo, a.hi, a.loIsImplication) < std::tie(b.lo, b.hi, b.loIsImplication);
+    });
+}
+
+// Only the implications that could conclude target are swept for; of the
+// pairs completing one, the first in pair order is the one enumeration finds
+std::optional<ProofSolver::ImplicationMatch> ProofSolver::matchTarget(const Rule& rule, FormulaId target) {
+    bool ponens = rule.kernel == Rule::Kernel::ModusPonens;
+    if (!ponens && !formulas.is(target, Connective::Not)) return std::nullopt;
+
+    hits.clear();
+    if (ponens) implications.withConsequent(target, hits);
+    else implications.withAntecedent(formulas.get(target).operands[0], hits);
+
+    std::optional<ImplicationMatch> best;
+    for (size_t i : hits) {
+        // MP needs the antecedent on a line, MT the negated consequent
+        FormulaId partner = implications.antecedent(i);
+        if (!ponens) {
+            FormulaStore::Probe probe(formulas);
+            partner = formulas.negate(implications.consequent(i));
+        }
+        if (partner == NoFormula) continue;
+
+        int other = implications.position(i);
+        factHits.clear();
+        implications.withFact(partner, implications.lines(), factHits);
+        stats.combinations += implications.lines();
+        for (size_t pos : factHits) {
+            int at = static_cast<int>(pos);
+            if (at == other) continue;
+
+            ImplicationMatch match{std::min(at, other), std::max(at, other), other < at, partner};
+            if (!best || std::tie(match.lo, match.hi) < std::tie(best->lo, best->hi)) best = match;
+        }
+    }
+    return best;
+}
+
+FormulaId ProofSolver::conclusionOf(const Rule& rule, const ImplicationMatch& match) {
+    return rule.kernel == Rule::Kernel::ModusPonens ? match.source : formulas.negate(match.source);
+}
+
+const std::vector<int>& ProofSolver::premiseLines(const Rule& rule, std::vector<int>& buffer) const {
+    const std::vector<int>& view = scopes.accessible();
+    if (rule.accepts == AnyShape) return view;
+
+    buffer.clear();
+    for (size_t pos = 0; pos < view.size(); ++pos)
+        if (rule.accepts & shapeBit(scopes.head(pos))) buffer.push_back(view[pos]);
+    return buffer;
+}
+
+// Tries to reach target with a single rule application over citable lines,
+// without adding any other line
+bool ProofSolver::tryOneStep(FormulaId target) {
+    std::vector<FormulaId>& exprs = stepBuffers.exprs;
+    std::vector<int>& indices = stepBuffers.indices;
+    std::vector<int>& matching = stepBuffers.matching;
+    std::vector<int>& found = stepBuffers.refs;
+
+    ShapeMask shape = shapeBit(formulas.get(target).op);
+    scheduler.ranking(stepBuffers.order);
+    for (size_t r : stepBuffers.order) {
+        const Rule& rule = rules[r];
+        if (!(rule.yields & shape) || !scopes.covers(rule.needs)) {
+            stats.rulesSkipped++;
+            continue;
+        }
+        if (rule.kernel != Rule::Kernel::None) {
+            auto match = matchTarget(rule, target);
+            if (!match) continue;
+            const std::vector<int>& view = scopes.accessible();
+            appendLine(target, proof.internRule(rule.name),
+                       {proof.lineNumber(view[match->lo]), proof.lineNumber(view[match->hi])}, currentIndent);
+            return true;
+        }
+
+        const std::vector<int>& candidates = premiseLines(rule, matching);
+        found.clear();
+
+        forEachCombo(candidates.size(), rule.numPremises, indices, [&](const std::vector<int>& combo) {
+            exprs.clear();
+            for (int pos : combo) exprs.push_back(proof.formula(candidates[pos]));
+            if (!coversNeeds(rule, exprs)) return false;
+            stats.combinations++;
 
-                    std::cout << "[DEBUG] Derived: " << trimmedResult << "    :" << rule.name << "\n\n";
+            conclusions.clear();
+            rule.apply(formulas, exprs, conclusions);
+            if (std::find(conclusions.begin(), conclusions.end(), target) == conclusions.end()) return false;
 
-                    std::vector<int> refs;
-                    for (int idx : combo)
-                        refs.push_back(proofLines[idx].lineNumber);
+            for (int pos : combo) found.push_back(proof.lineNumber(candidates[pos]));
+            return true;
+        });
+
+        if (!found.empty()) {
+            appendLine(target, proof.internRule(rule.name), found, currentIndent);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// The goal is already a premise. If a one-premise rule recognizes it as an
+// instance of its schema (the equivalence laws), restate it under that rule
+// so the proof records the law; otherwise the premise line stands.
+bool ProofSolver::restateGiven(FormulaId target) {
+    auto line = derived.line(target);
+    if (!line) return false;
+
+    const std::vector<FormulaId> given = {target};
+    scheduler.ranking(stepBuffers.order);
+    for (size_t r : stepBuffers.order) {
+        const Rule& rule = rules[r];
+        if (rule.numPremises != 1) continue;
+
+        conclusions.clear();
+        rule.apply(formulas, given, conclusions);
+        if (std::find(conclusions.begin(), conclusions.end(), target) != conclusions.end()) {
+            appendLine(target, proof.internRule(rule.name), {proof.lineNumber(*line)}, currentIndent);
+            break;
+        }
+    }
+    return true;
+}
+
+// Adds the knowledge-base premises relevant to the goal and the given
+// premises as PR lines. Only premises reachable through shared symbols are
+// imported, so a large knowledge base costs no more than the few premises a
+// problem touches.
+void ProofSolver::importKnowledge() {
+    importedPremises.clear();
+    if (!knowledgeBase) return;
+
+    std::vector<std::string> seeds;
+    KnowledgeBase::symbolsOf(formulas, goal, seeds);
+    for (size_t i = 0; i < proof.size(); ++i)
+        if (proof.usable(i)) KnowledgeBase::symbolsOf(formulas, proof.formula(i), seeds);
+
+    // One more than the limit shows whether the cap left anything out
+    size_t limit = std::min(knowledgeLimit, lineLimit / 2);
+    std::vector<uint32_t> relevant = knowledgeBase->relevant(seeds, limit + 1);
+    importTruncated = relevant.size() > limit;
+    if (importTruncated) relevant.resize(limit);
+
+    RuleId premiseRule = proof.internRule("PR");
+    importedFrom = proof.size();
+    for (uint32_t index : relevant) {
+        FormulaId f = knowledgeBase->import(index, formulas);
+        if (f == NoFormula || derived.contains(f)) continue;
+        appendLine(f, premiseRule, {}, currentIndent);
+        importedPremises.push_back(formulas.render(f));
+    }
+    if (diagnostics && !importedPremises.empty())
+        std::cout << "[KB] Imported " << importedPremises.size() << " of " << knowledgeBase->size() << " premises"
+                  << (importTruncated ? " (capped)" : "") << "\n";
+}
+
+// The relevance closure is generous; a finished proof keeps only the
+// imported premises some line cites
+void ProofSolver::dropUncitedImports() {
+    size_t importedTo = importedFrom + importedPremises.size();
+    if (importedPremises.empty() || proof.size() < importedTo) return;
+
+    std::vector<bool> dropped(proof.size(), false);
+    for (size_t i = importedFrom; i < importedTo; ++i) dropped[i] = true;
+    for (size_t i = importedTo; i < proof.size(); ++i)
+        for (int k = 0; k < proof.refCount(i); ++k) dropped[static_cast<size_t>(proof.refs(i)[k] - 1)] = false;
+
+    importedPremises.clear();
+    for (size_t i = importedFrom; i < importedTo; ++i)
+        if (!dropped[i]) importedPremises.push_back(formulas.render(proof.formula(i)));
+    proof.erase(dropped);
+}
+
+// Withdraws the reported lines from the first one the finished proof states
+// differently, and reports the proof's lines from there
+void ProofSolver::restate(const std::vector<Statement>& reported) {
+    auto same = [](const Statement& a, const Statement& b) {
+        return a.lineNumber == b.lineNumber && a.expression == b.expression && a.justification == b.justification &&
+               a.references == b.references && a.indentLevel == b.indentLevel;
+    };
+
+    size_t kept = 0;
+    while (kept < reported.size() && kept < proof.size() && same(reported[kept], statement(kept))) kept++;
+    if (kept < reported.size() && retractObserver) retractObserver(reported[kept].lineNumber);
+    for (size_t i = kept; i < proof.size(); ++i) lineObserver(statement(i));
+}
+
+// Tries to reach target as one instance of a library lemma. Only lemmas whose
+// conclusion has target's main connective are considered; the conclusion is
+// matched first so the premises are searched with most metavariables bound.
+bool ProofSolver::tryLemmaStep(FormulaId target) {
+    if (!lemmas) return false;
+
+    auto [first, last] = lemmas->byConclusion(formulas.get(target).op);
+    for (uint32_t i = first; i < last; ++i) {
+        const Lemma* lemma = cachedLemma(i);
+        if (!lemma) continue;
+
+        Bindings bindings;
+        std::vector<int> refs;
+        bool cited = forEachMatch(lemma->schema, lemma->conclusion, formulas, target, bindings,
+                                  [&](const Bindings&) { return citeLemmaPremises(*lemma, 0, bindings, refs); });
+        if (cited) {
+            appendLine(target, proof.internRule(lemma->name), refs, currentIndent);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Finds citable lines for premises k.. of lemma under bindings, backtracking
+// over earlier choices and over the ways each premise matches
+bool ProofSolver::citeLemmaPremises(const Lemma& lemma, size_t k, Bindings& bindings, std::vector<int>& refs) {
+    if (k == lemma.premises.size()) return true;
+
+    for (int i : scopes.accessible()) {
+        refs.push_back(proof.lineNumber(i));
+        if (forEachMatch(lemma.schema, lemma.premises[k], formulas, proof.formula(i), bindings,
+                         [&](const Bindings&) { return citeLemmaPremises(lemma, k + 1, bindings, refs); }))
+            return true;
+        refs.pop_back();
+    }
+    return false;
+}
+
+const Lemma* ProofSolver::cachedLemma(uint32_t index) {
+    auto it = lemmaCache.find(index);
+    if (it == lemmaCache.end()) it = lemmaCache.emplace(index, lemmas->lemma(index)).first;
+    return it->second ? &*it->second : nullptr;
+}
+
+// Forward chaining at the current level until target appears or the budget
+// runs out. A failed run is rolled back like a failed subproof, so the
+// strategy tried next starts with the whole line budget.
+bool ProofSolver::saturate(FormulaId target) {
+    if (!mayFollow(target)) return false;
+    if (diagnostics) std::cout << "\n[DEBUG] Running fallback rule application\n";
 
-                    proofLines.push_back({
-                        static_cast<int>(proofLines.size()) + 1,
-                        trimmedResult,
-                        rule.name,
-                        refs,
-                        currentIndent
-                    });
+    Checkpoint start = checkpoint();
+    int iterationCount = 0;
+    int derivationCount = 0;
 
-                    seen.insert(trimmedResult);
-                    progress = true;
+    while (true) {
+        iterationCount++;
+        if (iterationCount > 1000) {
+            if (diagnostics) std::cerr << "[ERROR] Aborting solve() — rule application exceeded 1000 iterations.\n";
+            stats.aborted = true;
+            rollback(start);
+            return false;
+        }
 
-                    if (trimmedResult == normalizeConnectives(trim(conclusion))) return;
+        RoundResult result = applyRulesRound([&](size_t line) {
+            derivationCount++;
+            if (diagnostics) {
+                if (derivationCount % 100 == 0) {
+                    std::cout << "[INFO] Derived " << derivationCount << " formulas...\n";
                 }
+
+                std::cout << "[DEBUG] Derived: " << formulas.render(proof.formula(line)) << "    :"
+                          << proof.ruleName(proof.rule(line)) << "\n\n";
             }
+
+            if (proof.formula(line) == target) return true;
+            if (equivalences.equivalent(formulas, proof.formula(line), target) && tryReplacement(target)) return true;
+
+            // An instance of an existential target closes it by EG right away
+            if (!formulas.is(target, Connective::Exists)) return false;
+            const Formula& q = formulas.get(target);
+            if (!formulas.instanceTerm(q.operands[0], q.terms[0], proof.formula(line))) return false;
+            appendLine(target, proof.internRule("EG"), {proof.lineNumber(line)}, currentIndent);
+            return true;
+        });
+
+        if (result == RoundResult::Stopped) return true;
+        if (result != RoundResult::Progress) {
+            rollback(start);
+            return false;
         }
     }
 }
+
+// Adds the ground atoms of lines appended since the last call to the term index
+void ProofSolver::indexNewLines() {
+    std::vector<FormulaId> atoms;
+    for (; indexedLines < proof.size(); ++indexedLines) {
+        FormulaId f = proof.formula(indexedLines);
+        if (f == NoFormula) continue;
+        atoms.clear();
+        formulas.collectPredicates(f, atoms);
+        for (FormulaId atom : atoms) termIndex.insert(atom, formulas);
+    }
+}
+
+// Fills out with the ground terms worth substituting for var in body: each
+// predicate of body that mentions var is looked up in the term index, and
+// the candidates are unified with it to read off var's binding
+void ProofSolver::instantiationTerms(FormulaId body, TermId var, std::vector<TermId>& out) {
+    indexNewLines();
+    const TermStore& terms = formulas.termStore();
+
+    std::vector<FormulaId> patterns;
+    formulas.collectPredicates(body, patterns);
+
+    out.clear();
+    for (FormulaId pattern : patterns) {
+        const auto& args = formulas.get(pattern).terms;
+        bool mentions = std::any_of(args.begin(), args.end(), [&](TermId t) { return terms.occurs(var, t); });
+        if (!mentions) continue;
+
+        for (FormulaId atom : termIndex.candidates(pattern, formulas)) {
+            Substitution s;
+            const auto& ground = formulas.get(atom).terms;
+            bool unified = true;
+            for (size_t i = 0; unified && i < args.size(); ++i)
+                unified = terms.unify(args[i], ground[i], s);
+
+            auto it = s.find(var);
+            if (unified && it != s.end() && terms.ground(it->second) &&
+                std::find(out.begin(), out.end(), it->second) == out.end())
+                out.push_back(it->second);
+        }
+    }
+}
+
+TermId ProofSolver::freshConstant() {
+    TermStore& terms = formulas.termStore();
+    for (int i = 0;; ++i) {
+        std::string name = i < 21 ? std::string(1, "abcdefghijklmnopqrstu"[i]) : "c" + std::to_string(i - 20);
+        if (terms.find(TermKind::Constant, name) == NoTerm && terms.find(TermKind::Variable, name) == NoTerm)
+            return terms.constant(name);
+    }
+}
+
+// One pass of the forward quantifier rules over citable lines: each ∃xφ is
+// instantiated once with a fresh constant (ED), and each ∀xφ with every
+// indexed term that makes one of its predicates match an existing atom (UI),
+// or with a fresh constant if no term does
+ProofSolver::RoundResult ProofSolver::instantiateQuantifiers(const std::function<bool(size_t)>& onDerived,
+                                                             std::vector<TermId>& instances) {
+    bool progress = false;
+
+    // Instances appended here are visited too, so ∀x∀y... unfolds in one pass
+    const std::vector<int>& view = scopes.accessible();
+    for (size_t pos = 0; pos < view.size(); ++pos) {
+        int i = view[pos];
+        FormulaId f = proof.formula(i);
+        bool universal = formulas.is(f, Connective::ForAll);
+        if (!universal && !formulas.is(f, Connective::Exists)) continue;
+
+        FormulaId body = formulas.get(f).operands[0];
+        TermId var = formulas.get(f).terms[0];
+
+        // A fresh-constant instance is made again only once the last one has
+        // gone out of scope
+        instances.clear();
+        if (universal) instantiationTerms(body, var, instances);
+        auto previous = instantiated.find(f);
+        if (instances.empty() && (previous == instantiated.end() || !derived.contains(previous->second))) {
+            TermId fresh = freshConstant();
+            instances.push_back(fresh);
+            instantiated[f] = formulas.substitute(body, var, fresh);
+        }
+
+        for (TermId t : instances) {
+            if (cancelled()) return RoundResult::Cancelled;
+
+            FormulaId instance = formulas.substitute(body, var, t);
+            if (derived.contains(instance)) continue;
+
+            appendLine(instance, proof.internRule(universal ? "UI" : "ED"), {proof.lineNumber(i)}, currentIndent);
+            progress = true;
+            if (onDerived(proof.size() - 1)) return RoundResult::Stopped;
+            if (outOfLines()) return RoundResult::Exhausted;
+        }
+    }
+
+    return progress ? RoundResult::Progress : RoundResult::Stalled;
+}
+
+// target is equivalent to a citable line under the replacement laws: write
+// out the rewrite chain from that line, reusing any step already on a line.
+// The graph also equates formulas the laws cannot chain (it takes ~ as
+// injective); such a pair is tried once, so later rounds skip it.
+bool ProofSolver::tryReplacement(FormulaId target) {
+    if (derived.contains(target)) return false;
+
+    // Lines written below change the graph, so the loop ends with them
+    for (FormulaId source : equivalences.equivalents(formulas, target)) {
+        auto line = derived.line(source);
+        if (!line) continue;
+
+        uint64_t pair = static_cast<uint64_t>(static_cast<uint32_t>(source)) << 32 | static_cast<uint32_t>(target);
+        if (unchained.count(pair)) continue;
+        auto chain = replacementChain(formulas, source, target);
+        if (!chain) {
+            unchained.insert(pair);
+            continue;
+        }
+
+        int ref = proof.lineNumber(*line);
+        for (const auto& [f, rule] : *chain) {
+            if (auto existing = derived.line(f)) ref = proof.lineNumber(*existing);
+            else ref = appendLine(f, proof.internRule(rule), {ref}, currentIndent);
+        }
+        return true;
+    }
+    return false;
+}
+
+// MP and MT need an implication's antecedent or negated consequent on a line
+// of their own. Where a citable line is only equivalent to one, the rewrite
+// chain is written out so the rules can match it next round.
+ProofSolver::RoundResult ProofSolver::bridgeEquivalences(const std::function<bool(size_t)>& onDerived,
+                                                         std::vector<FormulaId>& wanted) {
+    wanted.clear();
+    const std::vector<int>& view = scopes.accessible();
+    for (int i : view) {
+        FormulaId f = proof.formula(i);
+        if (!formulas.is(f, Connective::Implies)) continue;
+        for (FormulaId w : {formulas.get(f).operands[0], formulas.negate(formulas.get(f).operands[1])}) {
+            if (derived.contains(w)) continue;
+            equivalences.add(formulas, w);
+            wanted.push_back(w);
+        }
+    }
+
+    bool progress = false;
+    for (FormulaId w : wanted) {
+        if (cancelled()) return RoundResult::Cancelled;
+        if (!tryReplacement(w)) continue;
+
+        progress = true;
+        if (onDerived(proof.size() - 1)) return RoundResult::Stopped;
+        if (outOfLines()) return RoundResult::Exhausted;
+    }
+    return progress ? RoundResult::Progress : RoundResult::Stalled;
+}
+
+// EG: target ∃xφ follows from a citable line φ[t/x]
+bool ProofSolver::tryGeneralization(FormulaId target) {
+    if (!formulas.is(target, Connective::Exists)) return false;
+
+    FormulaId body = formulas.get(target).operands[0];
+    TermId var = formulas.get(target).terms[0];
+
+    std::vector<TermId> terms;
+    instantiationTerms(body, var, terms);
+    std::vector<FormulaId> instances = {body};
+    for (TermId t : terms)
+        instances.push_back(formulas.substitute(body, var, t));
+
+    for (FormulaId instance : instances) {
+        if (auto line = derived.line(instance)) {
+            appendLine(target, proof.internRule("EG"), {proof.lineNumber(*line)}, currentIndent);
+            return true;
+        }
+    }
+    return false;
+}
+
+// UD: Show ∀xφ, derive φ[c/x] for a constant c that occurs nowhere else yet,
+// and close citing it
+bool ProofSolver::tryUniversalDerivation(FormulaId target, std::unordered_set<FormulaId>& attempted) {
+    if (!formulas.is(target, Connective::ForAll)) return false;
+
+    FormulaId body = formulas.get(target).operands[0];
+    TermId var = formulas.get(target).terms[0];
+
+    Checkpoint start = checkpoint();
+    startShow(target);
+    FormulaId instance = formulas.substitute(body, var, freshConstant());
+
+    // The instance is not on any line yet; index it so UI can aim at it
+    std::vector<FormulaId> atoms;
+    formulas.collectPredicates(instance, atoms);
+    for (FormulaId atom : atoms) termIndex.insert(atom, formulas);
+
+    bool reached = derived.contains(instance);
+    if (!reached) {
+        if (formulas.is(instance, Connective::Implies))
+            reached = tryConditionalDerivation(instance, attempted);
+        else if (formulas.is(instance, Connective::ForAll))
+            reached = tryUniversalDerivation(instance, attempted);
+        else
+            reached = tryOneStep(instance) || tryLemmaStep(instance) || tryReplacement(instance) ||
+                      tryGeneralization(instance) || saturate(instance);
+    }
+    if (!reached) {
+        rollback(start);
+        return false;
+    }
+
+    closeSubproof(target, "UD", {proof.lineNumber(*derived.line(instance))});
+    return true;
 }
 
 // Helper Function for solver()
-bool ProofSolver::tryConditionalDerivation(const std::string& implicationStr, std::unordered_set<std::string>& attempted) {
+bool ProofSolver::tryConditionalDerivation(FormulaId implication, std::unordered_set<FormulaId>& attempted) {
 
-    static int cdDepth = 0;
     cdDepth++;
+    stats.maxCdDepth = std::max(stats.maxCdDepth, cdDepth);
 
     if (cdDepth > 10) {
-        std::cerr << "[ERROR] Maximum CD recursion depth exceeded.\n";
+        if (diagnostics) std::cerr << "[ERROR] Maximum CD recursion depth exceeded.\n";
+        stats.aborted = true;
         cdDepth--;
         return false;
     }
 
-    std::string normalized = normalizeConnectives(trim(implicationStr));
+    if (attempted.count(implication)) {
+        if (diagnostics)
+            std::cerr << "[CD] Skipping already-attempted implication: " << formulas.render(implication) << "\n";
+        cdDepth--;
+        return false;
+    }
+    attempted.insert(implication);
 
-    if (attempted.count(normalized)) {
-        std::cerr << "[CD] Skipping already-attempted implication: " << normalized << "\n";
+    if (!formulas.is(implication, Connective::Implies)) {
+        cdDepth--;
         return false;
     }
-    attempted.insert(normalized);
 
-    auto implication = splitImplication(implicationStr);
-    if (!implication) {
+    if (!mayFollow(implication)) {
         cdDepth--;
         return false;
     }
 
-    std::string antecedent = implication->first;
-    std::string consequent = implication->second;
+    FormulaId antecedent = formulas.get(implication).operands[0];
+    FormulaId consequent = formulas.get(implication).operands[1];
 
-    startSubproof(antecedent); // Show: antecedent + AS
+    Checkpoint start = checkpoint();
+    startSubproof(implication, antecedent); // Show: implication + AS antecedent
 
-    std::unordered_set<std::string> seen;
-    for (const auto& stmt : proofLines) {
-        seen.insert(normalizeConnectives(trim(stmt.expression)));
+    // Try to close the subproof directly first
+    if (auto line = derived.line(consequent)) {
+        closeSubproof(implication, "CD", {proof.lineNumber(*line)});
+        cdDepth--;
+        return true;
     }
 
-    // Try to close the subproof directly first
-    if (tryDirectDerivation(consequent)) {
-        int qedLine = static_cast<int>(proofLines.size());
-        endSubproof("CD", {qedLine});
+    // Or with a single lemma, replacement or EG step
+    if (tryLemmaStep(consequent) || tryReplacement(consequent) || tryGeneralization(consequent)) {
+        closeSubproof(implication, "CD", {proof.lineNumber(proof.size() - 1)});
         cdDepth--;
         return true;
     }
 
     // Try rules + recursive CD
-    bool progress = true;
     int stallCounter = 0;
+    bool closed = false;
 
-    while (progress) {
-        progress = false;
+    while (true) {
         stallCounter++;
         if (stallCounter > 100) {
-            std::cerr << "[ERROR] CD subproof stalled — no progress after 100 cycles.\n";
+            if (diagnostics) std::cerr << "[ERROR] CD subproof stalled — no progress after 100 cycles.\n";
+            rollback(start);
             cdDepth--;
             return false;
         }
 
-        for (const auto& rule : rules) {
-            size_t n = rule.numPremises;
-            std::vector<int> indices(proofLines.size());
-            for (size_t i = 0; i < indices.size(); ++i) indices[i] = static_cast<int>(i);
+        RoundResult result = applyRulesRound([&](size_t line) {
+            // Direct match with consequent?
+            if (proof.formula(line) == consequent) {
+                // Push the actual implication line as conclusion of the CD
+                closeSubproof(implication, "CD", {proof.lineNumber(line)});
+                closed = true;
+                return true;
+            }
 
-            std::vector<std::vector<int>> combos;
-            std::function<void(size_t, std::vector<int>)> generateCombos =
-                [&](size_t start, std::vector<int> current) {
-                    if (current.size() == n) {
-                        combos.push_back(current);
-                        return;
-                    }
-                    for (size_t i = start; i < indices.size(); ++i) {
-                        auto temp = current;
-                        temp.push_back(indices[i]);
-                        generateCombos(i + 1, temp);
-                    }
-                };
-            generateCombos(0, {});
+            // Or a line equivalent to it, rewritten into it
+            if (equivalences.equivalent(formulas, proof.formula(line), consequent) && tryReplacement(consequent)) {
+                closeSubproof(implication, "CD", {proof.lineNumber(proof.size() - 1)});
+                closed = true;
+                return true;
+            }
 
-            for (const auto& combo : combos) {
-                std::vector<std::string> exprs;
-                bool skipCombo = false;
+            // Consequent is an implication? Try CD on it.
+            bool inner = allowNestedCD && formulas.is(consequent, Connective::Implies);
+            if (inner && tryConditionalDerivation(consequent, attempted)) {
+                // The inner CD's result line is the consequent
+                closeSubproof(implication, "CD", {proof.lineNumber(proof.size() - 1)});
+                closed = true;
+                return true;
+            }
 
-                for (int idx : combo) {
-                    std::string expr = trim(proofLines[idx].expression);
-                    if (expr.rfind("Show:", 0) == 0) {
-                        skipCombo = true;
-                        break;
-                    }
-                    exprs.push_back(normalizeConnectives(expr));
-                }
+            return false;
+        });
 
-                if (skipCombo || exprs.size() != rule.numPremises) continue;
+        if (result != RoundResult::Progress) {
+            if (!closed) rollback(start);
+            cdDepth--;
+            return closed;
+        }
+    }
+}
 
-                std::optional<std::string> result = rule.apply(exprs);
-                if (!result) continue;
+// Indirect derivation: assume the negation of target (or, for target ~φ,
+// assume φ) and saturate until any φ and ~φ are both on accessible lines.
+// The contradiction index maps φ to the first lines holding φ and ~φ; every
+// line is filed positively under itself and, if it is a negation ~ψ,
+// negatively under ψ. It is dense by formula id, so filing a line allocates
+// only when new formulas extend the id range.
+bool ProofSolver::tryIndirectDerivation(FormulaId target) {
+    if (!mayFollow(target)) return false;
+
+    FormulaId assumption = formulas.is(target, Connective::Not)
+        ? formulas.get(target).operands[0]
+        : formulas.negate(target);
+
+    Checkpoint start = checkpoint();
+    startSubproof(target, assumption); // Show: target + AS
+
+    std::vector<std::pair<int, int>> contradictionIndex(formulas.size());
+    std::vector<int> clash;
+
+    auto file = [&](FormulaId base, bool negative, int lineNum) {
+        if (static_cast<size_t>(base) >= contradictionIndex.size()) contradictionIndex.resize(formulas.size());
+        auto& entry = contradictionIndex[base];
+        int& slot = negative ? entry.second : entry.first;
+        if (slot == 0) slot = lineNum;
+
+        if (entry.first && entry.second) {
+            clash = {std::min(entry.first, entry.second), std::max(entry.first, entry.second)};
+            return true;
+        }
+        return false;
+    };
 
-                std::string trimmedResult = normalizeConnectives(trim(*result));
-                if (seen.count(trimmedResult)) continue;
+    auto record = [&](size_t line) {
+        FormulaId f = proof.formula(line);
+        if (file(f, false, proof.lineNumber(line))) return true;
+        return formulas.is(f, Connective::Not) && file(formulas.get(f).operands[0], true, proof.lineNumber(line));
+    };
 
-                std::vector<int> refs;
-                for (int idx : combo)
-                    refs.push_back(proofLines[idx].lineNumber);
+    bool found = false;
+    for (size_t pos = 0; pos < scopes.accessible().size() && !found; ++pos)
+        found = record(scopes.accessible()[pos]);
 
-                proofLines.push_back({
-                    static_cast<int>(proofLines.size()) + 1,
-                    trimmedResult,
-                    rule.name,
-                    refs,
-                    currentIndent
-                });
+    int stallCounter = 0;
+    while (!found) {
+        if (++stallCounter > 100) {
+            if (diagnostics) std::cerr << "[ERROR] ID subproof stalled — no contradiction after 100 cycles.\n";
+            rollback(start);
+            return false;
+        }
 
-                seen.insert(trimmedResult);
-                progress = true;
+        RoundResult result = applyRulesRound(record);
+        if (result == RoundResult::Stopped) found = true;
+        else if (result != RoundResult::Progress) {
+            rollback(start);
+            return false;
+        }
+    }
 
-                // Direct match with consequent?
-                if (trimmedResult == normalizeConnectives(consequent)) {
-                    int qedLine = static_cast<int>(proofLines.size());
-                    // Close the subproof (manually adjust indent)
-                    if (!showStack.empty()) {
-                        showStack.pop_back();
-                        currentIndent = showStack.empty() ? 0 : showStack.back();
-                    }
+    closeSubproof(target, "ID", clash);
+    return true;
+}
 
-                    if (proofLines.size() > 5000) {
-                        std::cerr << "[ERROR] Proof line explosion (>5000). Aborting CD.\n";
-                        cdDepth--;
-                        return false;
-                    }
+// Speculatively explores a conditional subproof on forked copies of the
+// solver, one per strategy. The first fork to close its Show line wins and
+// its state replaces ours; the others observe the flag and bail out.
+// The fork's proof, derived and scopes extend ours, which stay unchanged
+// while it runs, so it holds only what it adds. The stores it interns into
+// only grow, so they are copied and the winner's replace ours; the buffers
+// and stats start empty.
+ProofSolver ProofSolver::fork() const {
+    ProofSolver f;
+    f.beautify = beautify;
+    f.diagnostics = diagnostics;
+    f.allowNestedCD = allowNestedCD;
+    f.order = order;
+    f.reversedRules = reversedRules;
+    f.cancelFlag = cancelFlag;
+    f.stopFlag = stopFlag;
+    f.cdDepth = cdDepth;
+    f.lineLimit = lineLimit;
+
+    f.proof.extend(proof);
+    f.derived.extend(derived);
+    f.scopes.extend(scopes);
+    f.goal = goal;
+    f.rules = rules;
+    f.implications = implications;
+    f.swept = swept;
+    f.sweptAtOpen = sweptAtOpen;
+    f.scheduler = scheduler;
+    f.lemmas = lemmas;
+    f.lemmaCache = lemmaCache;
+    f.importTruncated = importTruncated;
+    f.formulas = formulas;
+    f.termIndex = termIndex;
+    f.indexedLines = indexedLines;
+    f.instantiated = instantiated;
+    f.equivalences = equivalences;
+    f.unchained = unchained;
+    f.oracle = oracle;
+    f.showStack = showStack;
+    f.currentIndent = currentIndent;
+    return f;
+}
 
+bool ProofSolver::raceConditionalDerivation(FormulaId implication, std::unordered_set<FormulaId>& attempted) {
+    if (!mayFollow(implication)) return false;
+
+    const SubproofStrategy strategies[] = {
+        SubproofStrategy::NestedCD,
+        SubproofStrategy::Saturate,
+        SubproofStrategy::ReversedRules
+    };
+    constexpr size_t count = sizeof(strategies) / sizeof(strategies[0]);
+
+    std::atomic<bool> done{false};
+    std::atomic<int> winner{-1};
+
+    // We only wait while the forks run, so they may read through to our lines
+    std::vector<ProofSolver> forks;
+    std::vector<std::unordered_set<FormulaId>> forkAttempted(count, attempted);
+    std::vector<std::thread> workers;
+
+    for (size_t i = 0; i < count; ++i) {
+        forks.push_back(fork());
+        ProofSolver& f = forks.back();
+        f.cancelFlag = &done;
+        f.allowNestedCD = strategies[i] != SubproofStrategy::Saturate;
+        if (strategies[i] == SubproofStrategy::ReversedRules) {
+            std::reverse(f.rules.begin(), f.rules.end());
+            f.scheduler.reorder(f.rules);
+        }
+    }
 
-                    // Push the actual implication line as conclusion of the CD
-                    proofLines.push_back({
-                        static_cast<int>(proofLines.size()) + 1,
-                        implicationStr,
-                        "CD",
-                        {qedLine},
-                        currentIndent
-                    });
+    for (size_t i = 0; i < count; ++i) {
+        workers.emplace_back([&, i]() {
+            if (!forks[i].tryConditionalDerivation(implication, forkAttempted[i])) return;
 
-                    cdDepth--;
-                    return true;
-                }
+            int expected = -1;
+            if (winner.compare_exchange_strong(expected, static_cast<int>(i)))
+                done = true;
+        });
+    }
 
-                // Consequent is an implication? Try CD on it.
-                auto inner = splitImplication(consequent);
-                if (inner && tryConditionalDerivation(consequent, attempted)) {
-                    int qedLine = static_cast<int>(proofLines.size());
-                    // Pop subproof indent level (manual version of endSubproof)
-                    if (!showStack.empty()) {
-                        showStack.pop_back();
-                        currentIndent = showStack.empty() ? 0 : showStack.back();
-                    }
+    for (auto& worker : workers) worker.join();
+
+    if (winner < 0) return false;
+
+    // Splice the winning branch in; its formula store extends ours, so ids agree
+    ProofSolver& won = forks[winner];
+    size_t firstNew = proof.size();
+    proof.absorb(std::move(won.proof));
+    derived.absorb(std::move(won.derived));
+    scopes.absorb(std::move(won.scopes));
+    formulas = std::move(won.formulas);
+    showStack = std::move(won.showStack);
+    currentIndent = won.currentIndent;
+    termIndex = std::move(won.termIndex);
+    indexedLines = won.indexedLines;
+    implications = std::move(won.implications);
+    swept = won.swept;
+    sweptAtOpen = std::move(won.sweptAtOpen);
+    instantiated = std::move(won.instantiated);
+    equivalences = std::move(won.equivalences);
+    unchained = std::move(won.unchained);
+    oracle = std::move(won.oracle);
+    lemmaCache = std::move(won.lemmaCache);
+    stats.merge(won.stats);
+    scheduler.absorb(won.scheduler);
+    attempted = std::move(forkAttempted[winner]);
+
+    if (lineObserver)
+        for (size_t i = firstNew; i < proof.size(); ++i) lineObserver(statement(i));
+    return true;
+}
 
-                    // Push final implication as actual proof line
-                    proofLines.push_back({
-                        static_cast<int>(proofLines.size()) + 1,
-                        implicationStr,
-                        "CD",
-                        {qedLine},
-                        currentIndent
-                    });
-                    cdDepth--;
-                    return true;
-                }
-            }
-        }
-    }
+bool ProofSolver::mayFollow(FormulaId target) {
+    if (importTruncated) return true; // the premises left out may entail it
 
-    cdDepth--;
+    if (oracle.entailed(formulas, target).value_or(true)) return true;
+
+    stats.targetsPruned++;
     return false;
 }
 
-bool ProofSolver::tryDirectDerivation(const std::string& goal) {
-    std::string normalizedGoal = normalizeConnectives(trim(goal));
+bool ProofSolver::outOfLines() {
+    if (proof.size() <= lineLimit) return false;
+    if (diagnostics && !stats.aborted)
+        std::cerr << "[ERROR] Proof line explosion (>" << lineLimit << "). Aborting the attempt.\n";
+    stats.aborted = true;
+    stats.lineCapped = true;
+    return true;
+}
+
+bool ProofSolver::cancelled() const {
+    if (stopFlag && stopFlag->load(std::memory_order_relaxed)) return true;
+    return cancelFlag && cancelFlag->load(std::memory_order_relaxed);
+}
 
-    for (const auto& stmt : proofLines) {
-        if (normalizeConnectives(trim(stmt.expression)) == normalizedGoal &&
-            stmt.justification != "" &&  // skip "Show:" line
-            stmt.justification != "PR") // usually only assumptions or derived lines
-        {
-            endSubproof("DD", {stmt.lineNumber});
-            return true;
-        }
-    }
+bool ProofSolver::tryDirectDerivation(FormulaId goal) {
+    // Only assumptions or derived lines; a premise is restated instead
+    auto line = derived.line(goal);
+    if (!line || proof.rule(*line) == proof.internRule("PR")) return false;
 
-    return false;
+    endSubproof("DD", {proof.lineNumber(*line)});
+    return true;
 }
 
-void ProofSolver::startSubproof(const std::string& formula) {
-    int showLineNum = static_cast<int>(proofLines.size()) + 1;
+ProofSolver::Checkpoint ProofSolver::checkpoint() const {
+    return {proof.size(), derived.mark(), scopes.mark(), termIndex.mark(), indexedLines, showStack.size(), currentIndent,
+            swept};
+}
 
-    // Insert "Show: φ"
-    proofLines.push_back({
-        showLineNum,
-        "Show: " + formula,
-        "",
-        {},
-        currentIndent + 1
-    });
+// The e-graph keeps what it learned: its classes are facts about formulas,
+// not lines, and lookups through it are checked against derived anyway
+void ProofSolver::rollback(const Checkpoint& to) {
+    if (retractObserver && to.lines < proof.size()) retractObserver(proof.lineNumber(to.lines));
+    proof.truncate(to.lines);
+    derived.rollback(to.derived);
+    scopes.rollback(to.scopes);
+    implications.truncate(scopes.accessible().size());
+    oracle.truncatePremises(scopes.accessible().size());
+    termIndex.rollback(to.terms);
+    indexedLines = to.indexedLines;
+    showStack.resize(std::min(showStack.size(), to.showDepth));
+    sweptAtOpen.resize(std::min(sweptAtOpen.size(), to.showDepth));
+    swept = to.swept;
+    currentIndent = to.indent;
+
+    // A full e-graph is rebuilt from the lines that survived, dropping the
+    // formulas of every attempt rolled back so far
+    if (equivalences.full()) {
+        equivalences.clear();
+        for (size_t line = 0; line < proof.size(); ++line)
+            if (proof.usable(line)) equivalences.add(formulas, proof.formula(line));
+    }
+}
 
-    // Push subproof context
+void ProofSolver::startSubproof(FormulaId formula, FormulaId assumption) {
+    if (assumption == NoFormula) assumption = formula;
+
+    // Insert "Show: φ" and push the subproof context
+    startShow(formula);
+
+    // Insert assumption line φ :AS (or ~φ for ID)
+    appendLine(assumption, proof.internRule("AS"), {}, currentIndent);
+}
+
+void ProofSolver::startShow(FormulaId formula) {
+    appendLine(formula, ShowRule, {}, currentIndent + 1);
     showStack.push_back(currentIndent + 1);
     currentIndent++;
+    derived.pushScope();
+    scopes.open(static_cast<int>(proof.size() - 1));
+    oracle.openScope();
+    sweptAtOpen.push_back(swept);
+}
 
-    // Insert assumption line φ :AS
-    proofLines.push_back({
-        showLineNum + 1,
-        formula,
-        "AS",
-        {},
-        currentIndent
-    });
+int ProofSolver::appendLine(FormulaId formula, RuleId rule, const std::vector<int>& refs, int indent,
+                            LayoutId layout) {
+    int number = proof.append(formula, rule, refs, indent, layout);
+    size_t line = proof.size() - 1;
+    if (proof.usable(line)) {
+        derived.insert(formula, line);
+        scopes.add(static_cast<int>(line), formulas.get(formula).op);
+        implications.add(formulas, formula);
+        oracle.addPremise(formula);
+        equivalences.add(formulas, formula);
+    }
+    if (lineObserver) lineObserver(statement(line));
+    return number;
 }
 
 void ProofSolver::endSubproof(const std::string& rule, const std::vector<int>& refs) {
-    int qedLineNum = static_cast<int>(proofLines.size()) + 1;
-
-    // Insert QED line
-    proofLines.push_back({
-        qedLineNum,
-        "",          // no expression for QED, only justification
-        rule,        // e.g., CD, DD, ID
-        refs,
-        currentIndent  // same indent as containing proof
-    });
+    // Insert QED line: no expression, only justification (e.g., CD, DD, ID),
+    // at the same indent as the containing proof
+    appendLine(NoFormula, proof.internRule(rule), refs, currentIndent);
+
+    // Pop the subproof; its lines are no longer accessible
+    derived.popScope();
+    scopes.close();
+    implications.truncate(scopes.accessible().size());
+    oracle.truncatePremises(scopes.accessible().size());
+    if (!showStack.empty()) {
+        showStack.pop_back();
+        currentIndent = showStack.empty() ? 0 : showStack.back();
+    }
+    if (!sweptAtOpen.empty()) {
+        swept.ponens = std::min(swept.ponens, sweptAtOpen.back().ponens);
+        swept.tollens = std::min(swept.tollens, sweptAtOpen.back().tollens);
+        sweptAtOpen.pop_back();
+    }
+}
 
-    // Pop the subproof
+// Closes the innermost subproof and states its result on the enclosing level,
+// e.g. "φ->ψ :CD n" or "φ :ID a b"
+void ProofSolver::closeSubproof(FormulaId result, const std::string& rule, const std::vector<int>& refs) {
+    derived.popScope();
+    scopes.close();
+    implications.truncate(scopes.accessible().size());
+    oracle.truncatePremises(scopes.accessible().size());
     if (!showStack.empty()) {
         showStack.pop_back();
         currentIndent = showStack.empty() ? 0 : showStack.back();
     }
+    if (!sweptAtOpen.empty()) {
+        swept.ponens = std::min(swept.ponens, sweptAtOpen.back().ponens);
+        swept.tollens = std::min(swept.tollens, sweptAtOpen.back().tollens);
+        sweptAtOpen.pop_back();
+    }
+
+    appendLine(result, proof.internRule(rule), refs, currentIndent);
 }
 
 void ProofSolver::displayProof() const {
-    std::cout << "=== Proof Steps ===\n";
-    for (const auto& stmt : proofLines) {
+    writeProof(std::cout);
+}
+
+void ProofSolver::writeProof(std::ostream& out) const {
+    out << "=== Proof Steps ===\n";
+    for (const auto& stmt : getProofLines()) {
         std::string indent(stmt.indentLevel * 3, ' ');
         std::string expr = beautify ? beautifyConnectives(stmt.expression) : stmt.expression;
 
         if (stmt.lineNumber == 1) {
-            std::cout << stmt.lineNumber << ". " << expr << "\n";
+            out << stmt.lineNumber << ". " << expr << "\n";
         } else {
-            std::cout << indent << stmt.lineNumber << ".  " << expr;
+            out << indent << stmt.lineNumber << ".  " << expr;
             if (!stmt.justification.empty()) {
-                std::cout << "    :" << stmt.justification;
+                out << "    :" << stmt.justification;
             }
 
             if (!stmt.references.empty()) {
-                std::cout << " ";
+                out << " ";
                 for (size_t i = 0; i < stmt.references.size(); ++i) {
-                    std::cout << stmt.references[i];
-                    if (i < stmt.references.size() - 1) std::cout << " ";
+                    out << stmt.references[i];
+                    if (i < stmt.references.size() - 1) out << " ";
                 }
             }
 
-            std::cout << "\n";
+            out << "\n";
         }
     }
 }
 
+bool ProofSolver::checkProof() const {
+    ProofChecker checker(lemmas.get());
+    std::vector<std::string> given = premises;
+    given.insert(given.end(), importedPremises.begin(), importedPremises.end());
+    CheckResult result = checker.check(getProofLines(), given, conclusion);
+    if (!result.valid)
+        std::cerr << "[CHECK] Line " << result.line << ": " << result.message << "\n";
+    return result.valid;
+}
+
 bool ProofSolver::wasConclusionDerived() const {
-    std::string goal = normalizeConnectives(trim(conclusion));
-    for (const auto& stmt : proofLines) {
-        if (normalizeConnectives(trim(stmt.expression)) == goal)
-            return true;
-    }
-    return false;
+    return goal != NoFormula && derived.contains(goal);
+}
+
+std::vector<Statement> ProofSolver::getProofLines() const {
+    std::vector<Statement> lines;
+    lines.reserve(proof.size());
+    for (size_t i = 0; i < proof.size(); ++i)
+        lines.push_back(statement(i));
+    return lines;
 }
 
-const std::vector<Statement>& ProofSolver::getProofLines() const {
-    return proofLines;
+// A given premise reads as it was typed, not re-rendered
+Statement ProofSolver::statement(size_t i) const {
+    Statement stmt = proof.statement(i, formulas);
+    auto text = premiseText.find(proof.layout(i));
+    if (text != premiseText.end() && stmt.justification == "PR") stmt.expression = text->second;
+    return stmt;
 }
 
 
 void ProofSolver::setInput(const std::string& premisesStr, const std::string& conclusionStr) {
     premises.clear();
-    std::stringstream ss(premisesStr);
-    std::string item;
-    while (std::getline(ss, item, ',')) {
+    for (const auto& item : splitPremiseList(premisesStr)) {
         premises.push_back(normalizeConnectives(trim(item)));
     }
     conclusion = normalizeConnectives(trim(conclusionStr));
@@ -428,4 +1592,54 @@ void ProofSolver::setInput(const std::string& premisesStr, const std::string& co
 
 void ProofSolver::enableBeautify(bool enable) {
     beautify = enable;
-}
\ No newline at end of file
+}
+
+void ProofSolver::enableParallelSubproofs(bool enable) {
+    parallelSubproofs = enable;
+}
+
+void ProofSolver::enableDiagnostics(bool enable) {
+    diagnostics = enable;
+}
+
+void ProofSolver::enablePortfolio(bool enable) {
+    portfolio = enable;
+}
+
+bool ProofSolver::loadRuleStats(const std::string& path) {
+    return scheduler.load(path);
+}
+
+bool ProofSolver::saveRuleStats(const std::string& path) const {
+    return scheduler.save(path);
+}
+
+void ProofSolver::useLemmas(std::shared_ptr<const LemmaLibrary> library) {
+    lemmas = std::move(library);
+    lemmaCache.clear();
+}
+
+void ProofSolver::useKnowledgeBase(std::shared_ptr<const KnowledgeBase> kb, size_t limit) {
+    knowledgeBase = std::move(kb);
+    knowledgeLimit = limit;
+}
+
+void ProofSolver::setLineObserver(std::function<void(const Statement&)> observer) {
+    lineObserver = std::move(observer);
+}
+
+void ProofSolver::setRetractObserver(std::function<void(int from)> observer) {
+    retractObserver = std::move(observer);
+}
+
+void ProofSolver::setRoundObserver(std::function<void(bool ended, size_t lines)> observer) {
+    roundObserver = std::move(observer);
+}
+
+void ProofSolver::setLineLimit(size_t lines) {
+    lineLimit = std::min(lines, MaxLines);
+}
+
+void ProofSolver::setStopFlag(const std::atomic<bool>* flag) {
+    stopFlag = flag;
+}
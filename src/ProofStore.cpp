@@ -0,0 +1,129 @@
+#include "ProofStore.h"
+
+ProofStore::ProofStore() {
+    internRule(""); // ShowRule: Show: lines carry no justification
+}
+
+RuleId ProofStore::internRule(const std::string& name) {
+    auto it = ruleIndex.find(name);
+    if (it != ruleIndex.end()) return it->second;
+
+    RuleId id = static_cast<RuleId>(ruleNames.size());
+    ruleNames.push_back(name);
+    ruleIndex.emplace(name, id);
+    return id;
+}
+
+int ProofStore::append(FormulaId formula, RuleId rule, const std::vector<int>& refs, int indent,
+                       LayoutId layout) {
+    int lineNum = static_cast<int>(size()) + 1;
+
+    formulas.push_back(formula);
+    rules.push_back(rule);
+    indents.push_back(indent);
+    lineNumbers.push_back(lineNum);
+    layouts.push_back(layout);
+    refOffsets.push_back(static_cast<int>(refPool.size()));
+    refCounts.push_back(static_cast<int>(refs.size()));
+    refPool.insert(refPool.end(), refs.begin(), refs.end());
+
+    return lineNum;
+}
+
+void ProofStore::truncate(size_t n) {
+    if (n >= size()) return;
+    n -= first;
+
+    refPool.resize(refOffsets[n]);
+    formulas.resize(n);
+    rules.resize(n);
+    indents.resize(n);
+    lineNumbers.resize(n);
+    layouts.resize(n);
+    refOffsets.resize(n);
+    refCounts.resize(n);
+}
+
+void ProofStore::erase(const std::vector<bool>& dropped) {
+    std::vector<int> renumbered(formulas.size() + 1, 0);
+    std::vector<int> pool;
+    size_t kept = 0;
+    for (size_t i = 0; i < formulas.size(); ++i) {
+        if (dropped[i]) continue;
+        renumbered[lineNumbers[i]] = static_cast<int>(kept) + 1;
+
+        int offset = static_cast<int>(pool.size());
+        for (int k = 0; k < refCounts[i]; ++k) pool.push_back(renumbered[refPool[refOffsets[i] + k]]);
+        formulas[kept] = formulas[i];
+        rules[kept] = rules[i];
+        indents[kept] = indents[i];
+        lineNumbers[kept] = static_cast<int>(kept) + 1;
+        layouts[kept] = layouts[i];
+        refOffsets[kept] = offset;
+        refCounts[kept] = refCounts[i];
+        ++kept;
+    }
+    formulas.resize(kept);
+    rules.resize(kept);
+    indents.resize(kept);
+    lineNumbers.resize(kept);
+    layouts.resize(kept);
+    refOffsets.resize(kept);
+    refCounts.resize(kept);
+    refPool = std::move(pool);
+}
+
+void ProofStore::clear() {
+    base = nullptr;
+    first = 0;
+    formulas.clear();
+    rules.clear();
+    indents.clear();
+    lineNumbers.clear();
+    layouts.clear();
+    refOffsets.clear();
+    refCounts.clear();
+    refPool.clear();
+}
+
+void ProofStore::extend(const ProofStore& base) {
+    clear();
+    this->base = &base;
+    first = base.size();
+    ruleNames = base.ruleNames;
+    ruleIndex = base.ruleIndex;
+}
+
+// The extension's rule names started as ours and only grew, so its rule ids
+// hold here once we take its names
+void ProofStore::absorb(ProofStore&& extension) {
+    int offset = static_cast<int>(refPool.size());
+    formulas.insert(formulas.end(), extension.formulas.begin(), extension.formulas.end());
+    rules.insert(rules.end(), extension.rules.begin(), extension.rules.end());
+    indents.insert(indents.end(), extension.indents.begin(), extension.indents.end());
+    lineNumbers.insert(lineNumbers.end(), extension.lineNumbers.begin(), extension.lineNumbers.end());
+    layouts.insert(layouts.end(), extension.layouts.begin(), extension.layouts.end());
+    for (int o : extension.refOffsets) refOffsets.push_back(offset + o);
+    refCounts.insert(refCounts.end(), extension.refCounts.begin(), extension.refCounts.end());
+    refPool.insert(refPool.end(), extension.refPool.begin(), extension.refPool.end());
+    ruleNames = std::move(extension.ruleNames);
+    ruleIndex = std::move(extension.ruleIndex);
+    extension.clear();
+}
+
+Statement ProofStore::statement(size_t i, const FormulaStore& store) const {
+    Statement stmt;
+    stmt.lineNumber = lineNumber(i);
+    stmt.indentLevel = indent(i);
+    stmt.formula = formula(i);
+    stmt.justification = ruleNames[rule(i)];
+    stmt.references.assign(refs(i), refs(i) + refCount(i));
+
+    if (stmt.formula != NoFormula) {
+        LayoutId l = layout(i);
+        stmt.expression = l != NoLayout ? store.renderLayout(l) : store.render(stmt.formula);
+        if (rule(i) == ShowRule) stmt.expression = "Show: " + stmt.expression;
+    }
+
+    return stmt;
+}
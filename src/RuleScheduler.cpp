@@ -0,0 +1,131 @@
+#include "RuleScheduler.h"
+#include "ProofSolver.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+constexpr double ThrottleRate = 0.15;     // below this a rule is throttled
+constexpr int ThrottlePeriod = 4;         // throttled rules run every Nth round
+constexpr double PriorRounds = 20.0;      // persisted stats count as at most this many rounds
+constexpr double ComboBudget = 2000000.0; // combinations one rule may try in one round
+
+double combinations(size_t n, int k) {
+    double c = 1.0;
+    for (int i = 0; i < k; ++i) c = c * static_cast<double>(n - i) / (i + 1);
+    return n < static_cast<size_t>(k) ? 0.0 : c;
+}
+
+} // namespace
+
+void RuleScheduler::reset(const std::vector<Rule>& rules) {
+    names.clear();
+    arity.clear();
+    for (const auto& rule : rules) {
+        names.push_back(rule.name);
+        arity.push_back(rule.numPremises);
+    }
+    live.assign(rules.size(), {});
+    round = 0;
+    throttled = false;
+    resumeAfter = -1;
+}
+
+void RuleScheduler::reorder(const std::vector<Rule>& rules) {
+    RuleScheduler before = *this;
+    reset(rules);
+    absorb(before);
+}
+
+void RuleScheduler::absorb(const RuleScheduler& fork) {
+    for (size_t i = 0; i < names.size(); ++i) {
+        auto it = std::find(fork.names.begin(), fork.names.end(), names[i]);
+        if (it != fork.names.end()) live[i] = fork.live[it - fork.names.begin()];
+    }
+    round = fork.round;
+}
+
+double RuleScheduler::hitRate(size_t rule) const {
+    double run = static_cast<double>(live[rule].roundsRun);
+    double fired = static_cast<double>(live[rule].roundsFired);
+
+    auto it = persisted.find(names[rule]);
+    if (it != persisted.end() && it->second.roundsRun > 0) {
+        double weight = std::min(1.0, PriorRounds / it->second.roundsRun);
+        run += it->second.roundsRun * weight;
+        fired += it->second.roundsFired * weight;
+    }
+
+    // Laplace smoothing: unseen rules start at 0.5
+    return (fired + 1.0) / (run + 2.0);
+}
+
+// Ties keep rule order, as a stable sort would, without its buffer
+void RuleScheduler::ranking(std::vector<size_t>& order) const {
+    order.resize(names.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        double ra = hitRate(a), rb = hitRate(b);
+        return ra > rb || (ra == rb && a < b);
+    });
+}
+
+void RuleScheduler::plan(bool full, std::vector<size_t>& order) {
+    round++;
+    throttled = false;
+
+    ranking(order);
+    auto kept = std::remove_if(order.begin(), order.end(), [&](size_t rule) {
+        bool lowRate = round > 1 && hitRate(rule) < ThrottleRate;
+        return !full && lowRate && round % ThrottlePeriod != 0;
+    });
+    throttled = kept != order.end();
+    order.erase(kept, order.end());
+
+    // Round-robin past a cut: a rule that fills every round would otherwise
+    // starve the rules ranked behind it
+    auto cut = std::find(order.begin(), order.end(), static_cast<size_t>(resumeAfter));
+    if (resumeAfter >= 0 && cut != order.end()) std::rotate(order.begin(), cut + 1, order.end());
+    resumeAfter = -1;
+}
+
+bool RuleScheduler::overBudget(size_t rule, size_t candidates) const {
+    return combinations(candidates, arity[rule]) > ComboBudget;
+}
+
+void RuleScheduler::record(size_t rule, bool fired) {
+    live[rule].roundsRun++;
+    if (fired) live[rule].roundsFired++;
+}
+
+// Stats file: one "name roundsRun roundsFired" line per rule
+bool RuleScheduler::load(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) return false;
+
+    std::string line;
+    while (std::getline(in, line)) {
+        std::stringstream ss(line);
+        std::string name;
+        RuleStats stats;
+        if (ss >> name >> stats.roundsRun >> stats.roundsFired)
+            persisted[name] = stats;
+    }
+    return true;
+}
+
+bool RuleScheduler::save(const std::string& path) const {
+    auto merged = persisted;
+    for (size_t i = 0; i < names.size(); ++i) {
+        merged[names[i]].roundsRun += live[i].roundsRun;
+        merged[names[i]].roundsFired += live[i].roundsFired;
+    }
+
+    std::ofstream out(path);
+    if (!out) return false;
+    for (const auto& [name, stats] : merged)
+        out << name << " " << stats.roundsRun << " " << stats.roundsFired << "\n";
+    return true;
+}
@@ -1,31 +1,65 @@
 #include "Rules.h"
 #include "Utils.h"
-#include <regex>
+#include <algorithm>
+#include <functional>
 #include <optional>
+#include <unordered_map>
+
+// Rules operate on interned formula ids. Conjunctions and disjunctions are
+// AC-normal in the store, so matching is modulo operand order and nesting.
+// Each application emits every conclusion of its premise tuple, in every
+// orientation, so results do not depend on call order.
+
+// Rule signatures (needs, accepts, yields), by the connective heading a line
+constexpr ShapeMask AtomHead = shapeBit(Connective::Atom);
+constexpr ShapeMask NotHead = shapeBit(Connective::Not);
+constexpr ShapeMask AndHead = shapeBit(Connective::And);
+constexpr ShapeMask OrHead = shapeBit(Connective::Or);
+constexpr ShapeMask ImpliesHead = shapeBit(Connective::Implies);
+constexpr ShapeMask IffHead = shapeBit(Connective::Iff);
+
+// Appends a conclusion unless this application already produced it
+static void emit(Conclusions& out, std::optional<FormulaId> f) {
+    if (f && std::find(out.begin(), out.end(), *f) == out.end()) out.push_back(*f);
+}
+
+// Operands of f when it is a binary node of the given connective
+static std::optional<std::pair<FormulaId, FormulaId>> binary(const FormulaStore& fs, FormulaId f, Connective op) {
+    if (!fs.is(f, op)) return std::nullopt;
+    const auto& ops = fs.get(f).operands;
+    return std::make_pair(ops[0], ops[1]);
+}
+
+// Inner formula of a negation
+static std::optional<FormulaId> negated(const FormulaStore& fs, FormulaId f) {
+    if (!fs.is(f, Connective::Not)) return std::nullopt;
+    return fs.get(f).operands[0];
+}
+
+// The ^/v node left over after removing one occurrence of `operand`
+static std::optional<FormulaId> without(FormulaStore& fs, FormulaId f, FormulaId operand) {
+    const auto& ops = fs.get(f).operands;
+    for (size_t i = 0; i < ops.size(); ++i)
+        if (ops[i] == operand) return fs.withoutOperand(f, i);
+    return std::nullopt;
+}
 
 // Modus Ponens (MP): From A and A->B, conclude B
 Rule makeMP() {
     return {
         "MP",
         2,
-        [](const std::vector<std::string>& premises) -> std::optional<std::string> {
-            std::string a = normalizeConnectives(trim(premises[0]));
-            std::string b = normalizeConnectives(trim(premises[1]));
-
-            // Try both combinations
-            auto tryMP = [&](const std::string& phi, const std::string& implication) -> std::optional<std::string> {
-                auto maybe = splitImplication(implication);
-                if (maybe && trim(maybe->first) == phi) {
-                    return trim(maybe->second);
-                }
-                return std::nullopt;
-            };
-
-            if (auto res = tryMP(a, b)) return res;
-            if (auto res = tryMP(b, a)) return res;
-
-            return std::nullopt;
-        }
+        [](FormulaStore& fs, const std::vector<FormulaId>& premises, Conclusions& out) {
+            // Either premise may be the conditional
+            for (int i = 0; i < 2; ++i) {
+                auto imp = binary(fs, premises[1 - i], Connective::Implies);
+                if (imp && imp->first == premises[i]) emit(out, imp->second);
+            }
+        },
+        ImpliesHead,
+        AnyShape,
+        AnyShape,
+        Rule::Kernel::ModusPonens
     };
 }
 
@@ -34,25 +68,17 @@ Rule makeMT() {
     return {
         "MT",
         2,
-        [](const std::vector<std::string>& premises) -> std::optional<std::string> {
-            std::string a = normalizeConnectives(trim(premises[0]));
-            std::string b = normalizeConnectives(trim(premises[1]));
-
-            auto tryMT = [&](const std::string& notPsi, const std::string& imp) -> std::optional<std::string> {
-                if (notPsi.rfind("~", 0) == 0) {
-                    std::string psi = trim(notPsi.substr(1));
-                    auto maybeImp = splitImplication(imp);
-                    if (maybeImp && trim(maybeImp->second) == psi) {
-                        return "~" + trim(maybeImp->first);
-                    }
-                }
-                return std::nullopt;
-            };
-
-            if (auto res = tryMT(a, b)) return res;
-            if (auto res = tryMT(b, a)) return res;
-            return std::nullopt;
-        }
+        [](FormulaStore& fs, const std::vector<FormulaId>& premises, Conclusions& out) {
+            for (int i = 0; i < 2; ++i) {
+                auto psi = negated(fs, premises[i]);
+                auto imp = binary(fs, premises[1 - i], Connective::Implies);
+                if (psi && imp && imp->second == *psi) emit(out, fs.negate(imp->first));
+            }
+        },
+        NotHead | ImpliesHead,
+        NotHead | ImpliesHead,
+        NotHead,
+        Rule::Kernel::ModusTollens
     };
 }
 
@@ -60,15 +86,13 @@ Rule makeDNE() {
     return {
         "DNE",
         1,
-        [](const std::vector<std::string>& premises) -> std::optional<std::string> {
-            std::string expr = normalizeConnectives(trim(premises[0]));
-
-            if (expr.rfind("~~", 0) == 0) {
-                return trim(expr.substr(2)); // remove the two leading negations
-            }
-
-            return std::nullopt;
-        }
+        [](FormulaStore& fs, const std::vector<FormulaId>& premises, Conclusions& out) {
+            auto inner = negated(fs, premises[0]);
+            if (inner) emit(out, negated(fs, *inner)); // remove the two leading negations
+        },
+        NotHead,
+        NotHead,
+        AnyShape
     };
 }
 
@@ -76,32 +100,31 @@ Rule makeDNI() {
     return {
         "DNI",
         1,
-        [](const std::vector<std::string>& premises) -> std::optional<std::string> {
-            std::string expr = normalizeConnectives(trim(premises[0]));
-            return "~~" + expr;
-        }
+        [](FormulaStore& fs, const std::vector<FormulaId>& premises, Conclusions& out) {
+            emit(out, fs.negate(fs.negate(premises[0])));
+        },
+        0,
+        AnyShape,
+        NotHead
     };
 }
 
+// Simplification (S): From φ^ψ, conclude φ and ψ. An n-ary conjunction splits
+// into its first operand and the conjunction of the rest.
 Rule makeS() {
     return {
         "S",
         1,
-        [](const std::vector<std::string>& premises) -> std::optional<std::string> {
-            std::string expr = normalizeConnectives(trim(premises[0]));
-
-            size_t andPos = expr.find("^");
-            if (andPos != std::string::npos) {
-                std::string left = trim(expr.substr(0, andPos));
-                std::string right = trim(expr.substr(andPos + 1));
-
-                static bool toggle = false;
-                toggle = !toggle;
-                return toggle ? left : right;
-            }
-
-            return std::nullopt;
-        }
+        [](FormulaStore& fs, const std::vector<FormulaId>& premises, Conclusions& out) {
+            if (!fs.is(premises[0], Connective::And)) return;
+
+            FormulaId left = fs.get(premises[0]).operands[0];
+            emit(out, left);
+            emit(out, without(fs, premises[0], left));
+        },
+        AndHead,
+        AndHead,
+        AnyShape
     };
 }
 
@@ -109,47 +132,31 @@ Rule makeADJ() {
     return {
         "ADJ",
         2,
-        [](const std::vector<std::string>& premises) -> std::optional<std::string> {
-            if (premises.size() != 2) return std::nullopt;
-
-            std::string a = normalizeConnectives(trim(premises[0]));
-            std::string b = normalizeConnectives(trim(premises[1]));
-
-            if (a == b) return std::nullopt; // Don't introduce redundancy like "P∧P"
-
-            return a + "^" + b;
-        }
+        [](FormulaStore& fs, const std::vector<FormulaId>& premises, Conclusions& out) {
+            if (premises[0] == premises[1]) return; // Don't introduce redundancy like "P∧P"
+            emit(out, fs.conjoin(premises[0], premises[1]));
+        },
+        0,
+        AnyShape,
+        AndHead
     };
 }
 
+// Modus Tollendo Ponens (MTP): From φvψ and ~φ, conclude ψ. Any disjunct of an
+// n-ary disjunction may be the one eliminated.
 Rule makeMTP() {
     return {
         "MTP",
         2,
-        [](const std::vector<std::string>& premises) -> std::optional<std::string> {
-            std::string a = normalizeConnectives(trim(premises[0]));
-            std::string b = normalizeConnectives(trim(premises[1]));
-
-            auto tryMTP = [](const std::string& disj, const std::string& negated) -> std::optional<std::string> {
-                if (disj.find("v") == std::string::npos || negated.rfind("~", 0) != 0)
-                    return std::nullopt;
-
-                size_t barPos = disj.find("v");
-                std::string left = trim(disj.substr(0, barPos));
-                std::string right = trim(disj.substr(barPos + 1));
-                std::string negTerm = trim(negated.substr(1));  // remove ~
-
-                if (negTerm == left) return right;
-                if (negTerm == right) return left;
-
-                return std::nullopt;
-            };
-
-            if (auto res = tryMTP(a, b)) return res;
-            if (auto res = tryMTP(b, a)) return res;
-
-            return std::nullopt;
-        }
+        [](FormulaStore& fs, const std::vector<FormulaId>& premises, Conclusions& out) {
+            for (int i = 0; i < 2; ++i) {
+                auto negTerm = negated(fs, premises[1 - i]);
+                if (fs.is(premises[i], Connective::Or) && negTerm) emit(out, without(fs, premises[i], *negTerm));
+            }
+        },
+        OrHead | NotHead,
+        OrHead | NotHead,
+        AnyShape
     };
 }
 
@@ -157,43 +164,35 @@ Rule makeADD() {
     return {
         "ADD",
         1,
-        [](const std::vector<std::string>& premises) -> std::optional<std::string> {
-            std::string expr = normalizeConnectives(trim(premises[0]));
-            return expr + "v" + "ψ";
-        }
+        [](FormulaStore& fs, const std::vector<FormulaId>& premises, Conclusions& out) {
+            emit(out, fs.disjoin(premises[0], fs.atom("ψ")));
+        },
+        0,
+        AnyShape,
+        OrHead
     };
 }
 
+// Biconditional to Conditional (BC): From φ<->ψ and one direction, conclude the other
 Rule makeBC() {
     return {
         "BC",
         2,
-        [](const std::vector<std::string>& premises) -> std::optional<std::string> {
-            if (premises.size() != 2) return std::nullopt;
-
-            std::string biconditional = normalizeConnectives(trim(premises[0]));
-            std::string implication   = normalizeConnectives(trim(premises[1]));
-
-
-            size_t bicondPos = biconditional.find("<->");
-            size_t implPos = implication.find("->");
-
-            if (bicondPos == std::string::npos || implPos == std::string::npos)
-                return std::nullopt;
-
-            std::string lhs = trim(biconditional.substr(0, bicondPos));
-            std::string rhs = trim(biconditional.substr(bicondPos + 3));
-
-            std::string antecedent = trim(implication.substr(0, implPos));
-            std::string consequent = trim(implication.substr(implPos + 2));
-
-            if ((antecedent == lhs && consequent == rhs) ||
-                (antecedent == rhs && consequent == lhs)) {
-                return normalizeConnectives(trim(antecedent + "->" + consequent));
+        [](FormulaStore& fs, const std::vector<FormulaId>& premises, Conclusions& out) {
+            for (int i = 0; i < 2; ++i) {
+                auto biconditional = binary(fs, premises[i], Connective::Iff);
+                auto implication   = binary(fs, premises[1 - i], Connective::Implies);
+                if (!biconditional || !implication) continue;
+
+                auto [lhs, rhs] = *biconditional;
+                auto [antecedent, consequent] = *implication;
+                if ((antecedent == lhs && consequent == rhs) || (antecedent == rhs && consequent == lhs))
+                    emit(out, fs.implies(consequent, antecedent));
             }
-
-            return std::nullopt;
-        }
+        },
+        IffHead | ImpliesHead,
+        IffHead | ImpliesHead,
+        ImpliesHead
     };
 }
 
@@ -201,26 +200,20 @@ Rule makeCB() {
     return {
         "CB",
         2,
-        [](const std::vector<std::string>& premises) -> std::optional<std::string> {
-            if (premises.size() != 2) return std::nullopt;
-
-            auto imp1 = splitImplication(normalizeConnectives(trim(premises[0])));
-            auto imp2 = splitImplication(normalizeConnectives(trim(premises[1])));
-
-
-            if (!imp1 || !imp2) return std::nullopt;
-
-            std::string a1 = trim(imp1->first);
-            std::string b1 = trim(imp1->second);
-            std::string a2 = trim(imp2->first);
-            std::string b2 = trim(imp2->second);
-
-            if (a1 == b2 && b1 == a2) {
-                return a1 + "<->" + b1;
+        [](FormulaStore& fs, const std::vector<FormulaId>& premises, Conclusions& out) {
+            auto imp1 = binary(fs, premises[0], Connective::Implies);
+            auto imp2 = binary(fs, premises[1], Connective::Implies);
+            if (!imp1 || !imp2) return;
+
+            // Both readings of the biconditional
+            if (imp1->first == imp2->second && imp1->second == imp2->first) {
+                emit(out, fs.iff(imp1->first, imp1->second));
+                emit(out, fs.iff(imp2->first, imp2->second));
             }
-
-            return std::nullopt;
-        }
+        },
+        ImpliesHead,
+        ImpliesHead,
+        IffHead
     };
 }
 
@@ -230,20 +223,18 @@ Rule makeD_HS() {
     return {
         "D-HS",
         2,
-        [](const std::vector<std::string>& premises) -> std::optional<std::string> {
-            auto imp1 = splitImplication(trim(premises[0]));
-            auto imp2 = splitImplication(trim(premises[1]));
-
-            if (imp1 && imp2) {
-                // Try both orderings: imp1 then imp2, or imp2 then imp1
-                if (normalizeConnectives(imp2->second) == normalizeConnectives(imp1->first)) {
-                    return imp2->first + "->" + imp1->second;
-                } else if (normalizeConnectives(imp1->second) == normalizeConnectives(imp2->first)) {
-                    return imp1->first + "->" + imp2->second;
-                }
-            }
-            return std::nullopt;
-        }
+        [](FormulaStore& fs, const std::vector<FormulaId>& premises, Conclusions& out) {
+            auto imp1 = binary(fs, premises[0], Connective::Implies);
+            auto imp2 = binary(fs, premises[1], Connective::Implies);
+            if (!imp1 || !imp2) return;
+
+            // Chain in either order
+            if (imp2->second == imp1->first) emit(out, fs.implies(imp2->first, imp1->second));
+            if (imp1->second == imp2->first) emit(out, fs.implies(imp1->first, imp2->second));
+        },
+        ImpliesHead,
+        ImpliesHead,
+        ImpliesHead
     };
 }
 
@@ -253,14 +244,13 @@ Rule makeD_MCC() {
     return {
         "D-MCC",
         1,
-        [](const std::vector<std::string>& premises) -> std::optional<std::string> {
-            std::string phi = trim(premises[0]);
-
+        [](FormulaStore& fs, const std::vector<FormulaId>& premises, Conclusions& out) {
             // Use a generic placeholder for ψ — user may later customize this
-            std::string psi = "X";
-
-            return psi + "->" + phi;
-        }
+            emit(out, fs.implies(fs.atom("X"), premises[0]));
+        },
+        0,
+        AnyShape,
+        ImpliesHead
     };
 }
 
@@ -270,16 +260,13 @@ Rule makeD_MCNA() {
     return {
         "D-MCNA",
         1,
-        [](const std::vector<std::string>& premises) -> std::optional<std::string> {
-            std::string not_phi = normalizeConnectives(trim(premises[0]));
-
-            if (not_phi.rfind("~", 0) != 0) return std::nullopt;
-
-            std::string phi = not_phi.substr(1);  // remove the ~
-            std::string psi = "X";  // placeholder or fresh variable
-
-            return phi + "->" + psi;
-        }
+        [](FormulaStore& fs, const std::vector<FormulaId>& premises, Conclusions& out) {
+            auto phi = negated(fs, premises[0]);
+            if (phi) emit(out, fs.implies(*phi, fs.atom("X"))); // placeholder or fresh variable
+        },
+        NotHead,
+        NotHead,
+        ImpliesHead
     };
 }
 
@@ -289,17 +276,13 @@ Rule makeD_CPO() {
     return {
         "D-CPO",
         1,
-        [](const std::vector<std::string>& premises) -> std::optional<std::string> {
-            std::string implication = normalizeConnectives(trim(premises[0]));
-
-            auto maybe = splitImplication(implication);
-            if (!maybe) return std::nullopt;
-
-            std::string phi = trim(maybe->first);
-            std::string psi = trim(maybe->second);
-
-            return "~" + psi + "->~" + phi;
-        }
+        [](FormulaStore& fs, const std::vector<FormulaId>& premises, Conclusions& out) {
+            auto maybe = binary(fs, premises[0], Connective::Implies);
+            if (maybe) emit(out, fs.implies(fs.negate(maybe->second), fs.negate(maybe->first)));
+        },
+        ImpliesHead,
+        ImpliesHead,
+        ImpliesHead
     };
 }
 
@@ -309,23 +292,17 @@ Rule makeD_CPT() {
     return {
         "D-CPT",
         1,
-        [](const std::vector<std::string>& premises) -> std::optional<std::string> {
-            std::string implication = normalizeConnectives(trim(premises[0]));
-
-            auto maybe = splitImplication(implication);
-            if (!maybe) return std::nullopt;
-
-            std::string not_phi = trim(maybe->first);
-            std::string not_psi = trim(maybe->second);
-
-            if (not_phi.rfind("~", 0) != 0 || not_psi.rfind("~", 0) != 0)
-                return std::nullopt;
-
-            std::string phi = not_phi.substr(1);
-            std::string psi = not_psi.substr(1);
-
-            return trim(psi) + "->" + trim(phi);
-        }
+        [](FormulaStore& fs, const std::vector<FormulaId>& premises, Conclusions& out) {
+            auto maybe = binary(fs, premises[0], Connective::Implies);
+            if (!maybe) return;
+
+            auto phi = negated(fs, maybe->first);
+            auto psi = negated(fs, maybe->second);
+            if (phi && psi) emit(out, fs.implies(*psi, *phi));
+        },
+        ImpliesHead,
+        ImpliesHead,
+        ImpliesHead
     };
 }
 
@@ -335,34 +312,19 @@ Rule makeD_DIL() {
     return {
         "D-DIL",
         2,
-        [](const std::vector<std::string>& premises) -> std::optional<std::string> {
-            std::string a = trim(premises[0]);
-            std::string b = trim(premises[1]);
-
-            auto tryDIL = [](const std::string& first, const std::string& second) -> std::optional<std::string> {
-                auto imp1 = splitImplication(first);
-                auto imp2 = splitImplication(second);
-                if (!imp1 || !imp2) return std::nullopt;
-
-                std::string ant1 = trim(imp1->first);
-                std::string cons1 = trim(imp1->second);
-                std::string ant2 = trim(imp2->first);
-                std::string cons2 = trim(imp2->second);
-
-                if (ant1.rfind("~", 0) == 0) {
-                    std::string phi1 = ant1.substr(1);
-                    if (ant2 == phi1 && cons1 == cons2) {
-                        return cons1;
-                    }
-                }
-
-                return std::nullopt;
-            };
-
-            if (auto res = tryDIL(a, b)) return res;
-            if (auto res = tryDIL(b, a)) return res;
-            return std::nullopt;
-        }
+        [](FormulaStore& fs, const std::vector<FormulaId>& premises, Conclusions& out) {
+            for (int i = 0; i < 2; ++i) {
+                auto imp1 = binary(fs, premises[i], Connective::Implies);
+                auto imp2 = binary(fs, premises[1 - i], Connective::Implies);
+                if (!imp1 || !imp2) continue;
+
+                auto phi1 = negated(fs, imp1->first);
+                if (phi1 && imp2->first == *phi1 && imp1->second == imp2->second) emit(out, imp1->second);
+            }
+        },
+        ImpliesHead,
+        ImpliesHead,
+        AnyShape
     };
 }
 
@@ -372,23 +334,16 @@ Rule makeD_CM() {
     return {
         "D-CM",
         1,
-        [](const std::vector<std::string>& premises) -> std::optional<std::string> {
-            std::string imp = normalizeConnectives(trim(premises[0]));
-            auto maybe = splitImplication(imp);
-            if (!maybe) return std::nullopt;
-
-            std::string antecedent = trim(maybe->first);
-            std::string consequent = trim(maybe->second);
-
-            if (antecedent.rfind("~", 0) == 0) {
-                std::string phi = antecedent.substr(1);
-                if (phi == consequent) {
-                    return phi;
-                }
-            }
-
-            return std::nullopt;
-        }
+        [](FormulaStore& fs, const std::vector<FormulaId>& premises, Conclusions& out) {
+            auto maybe = binary(fs, premises[0], Connective::Implies);
+            if (!maybe) return;
+
+            auto phi = negated(fs, maybe->first);
+            if (phi && *phi == maybe->second) emit(out, *phi);
+        },
+        ImpliesHead,
+        ImpliesHead,
+        AnyShape
     };
 }
 
@@ -398,56 +353,184 @@ Rule makeD_EFQ() {
     return {
         "D-EFQ",
         2,
-        [](const std::vector<std::string>& premises) -> std::optional<std::string> {
-            std::string a = trim(premises[0]);
-            std::string b = trim(premises[1]);
+        [](FormulaStore& fs, const std::vector<FormulaId>& premises, Conclusions& out) {
+            FormulaId a = premises[0];
+            FormulaId b = premises[1];
 
             // Check for φ and ¬φ in any order
-            if (a.rfind("~", 0) == 0 && a.substr(1) == b)
-                return "R";  // pick arbitrary formula R as placeholder
-            if (b.rfind("~", 0) == 0 && b.substr(1) == a)
-                return "R";
+            if (negated(fs, a) == b || negated(fs, b) == a)
+                emit(out, fs.atom("R"));  // pick arbitrary formula R as placeholder
+        },
+        NotHead,
+        AnyShape,
+        AtomHead
+    };
+}
 
-            return std::nullopt;
+// The equivalence laws, each oriented left to right as written
+enum class Law {
+    DN,    // ~~φ => φ
+    DMO,   // ~(φ v ψ) => ~φ ^ ~ψ
+    DMT,   // ~(φ ^ ψ) => ~φ v ~ψ
+    SDMO,  // φ ^ ψ => ~(~φ v ~ψ)
+    SDMT,  // φ v ψ => ~(~φ ^ ~ψ)
+    NC     // ~(φ -> ψ) => φ ^ ~ψ
+};
+
+// f rewritten by law at its top level
+static std::optional<FormulaId> rewriteTop(FormulaStore& fs, FormulaId f, Law law) {
+    if (law == Law::SDMO || law == Law::SDMT) {
+        Connective op = law == Law::SDMO ? Connective::And : Connective::Or;
+        if (!fs.is(f, op)) return std::nullopt;
+        return fs.negate(fs.negatedOperands(law == Law::SDMO ? Connective::Or : Connective::And, f));
+    }
+
+    auto inner = negated(fs, f);
+    if (!inner) return std::nullopt;
+
+    switch (law) {
+        case Law::DN:
+            return negated(fs, *inner);
+        case Law::DMO:
+            if (!fs.is(*inner, Connective::Or)) return std::nullopt;
+            return fs.negatedOperands(Connective::And, *inner);
+        case Law::DMT:
+            if (!fs.is(*inner, Connective::And)) return std::nullopt;
+            return fs.negatedOperands(Connective::Or, *inner);
+        case Law::NC: {
+            auto imp = binary(fs, *inner, Connective::Implies);
+            if (!imp) return std::nullopt;
+            return fs.conjoin(imp->first, fs.negate(imp->second));
         }
+        default:
+            return std::nullopt;
+    }
+}
+
+// Visits f rewritten by law at each position in turn, until visit returns true
+static bool forEachReplacement(FormulaStore& fs, FormulaId f, Law law,
+                               const std::function<bool(FormulaId)>& visit) {
+    if (auto top = rewriteTop(fs, f, law); top && visit(*top)) return true;
+
+    size_t n = fs.get(f).operands.size();
+    for (size_t i = 0; i < n; ++i) {
+        FormulaId operand = fs.get(f).operands[i];
+        bool found = forEachReplacement(fs, operand, law, [&](FormulaId r) {
+            return visit(fs.withOperand(f, i, r));
+        });
+        if (found) return true;
+    }
+    return false;
+}
+
+bool isReplacementStep(FormulaStore& fs, const std::string& rule, FormulaId from, FormulaId to) {
+    static const std::unordered_map<std::string, Law> laws = {
+        {"DNE", Law::DN}, {"DNI", Law::DN}, {"D-DMO", Law::DMO}, {"D-DMT", Law::DMT},
+        {"D-SDMO", Law::SDMO}, {"D-SDMT", Law::SDMT}, {"D-NC", Law::NC}
+    };
+    auto it = laws.find(rule);
+    if (it == laws.end()) return false;
+
+    auto reaches = [&](FormulaId a, FormulaId b) {
+        return forEachReplacement(fs, a, it->second, [&](FormulaId r) { return r == b; });
     };
+
+    // DNE removes a double negation and DNI adds one; the other laws go either way
+    if (rule == "DNE") return reaches(from, to);
+    if (rule == "DNI") return reaches(to, from);
+    return reaches(from, to) || reaches(to, from);
 }
 
-// Second De Morgan One
-// From (φ ^ ψ) <-> ~(~φ v ~ψ) or vice versa
-Rule makeD_SDMO() {
-    return {
-        "D-SDMO",
-        1,
-        [](const std::vector<std::string>& premises) -> std::optional<std::string> {
-            std::string expr = normalizeConnectives(trim(premises[0]));
-            size_t iffPos = expr.find("<->");
-            if (iffPos == std::string::npos) return std::nullopt;
+// One step toward negation normal form at the outermost, leftmost position
+// where a negation can move inward, with the rule name for that step
+static std::optional<std::pair<FormulaId, Law>> normalStep(FormulaStore& fs, FormulaId f) {
+    for (Law law : {Law::DN, Law::DMO, Law::DMT, Law::NC})
+        if (auto r = rewriteTop(fs, f, law)) return std::make_pair(*r, law);
+
+    size_t n = fs.get(f).operands.size();
+    for (size_t i = 0; i < n; ++i) {
+        if (auto step = normalStep(fs, fs.get(f).operands[i]))
+            return std::make_pair(fs.withOperand(f, i, step->first), step->second);
+    }
+    return std::nullopt;
+}
 
-            std::string left = trim(expr.substr(0, iffPos));
-            std::string right = trim(expr.substr(iffPos + 3));
+static std::string lawRule(Law law, bool inverse) {
+    switch (law) {
+        case Law::DN: return inverse ? "DNI" : "DNE";
+        case Law::DMO: return "D-DMO";
+        case Law::DMT: return "D-DMT";
+        case Law::SDMO: return "D-SDMO";
+        case Law::SDMT: return "D-SDMT";
+        default: return "D-NC";
+    }
+}
 
-            // Check one direction: (A ^ B) <-> ~(~A v ~B)
-            auto isDeMorganSDMO = [](const std::string& a, const std::string& b) -> bool {
-                if (a.find("^") == std::string::npos) return false;
-                if (b.rfind("~(", 0) != 0 || b.back() != ')') return false;
+// Both ends are rewritten toward negation normal form; where the two paths
+// meet, the second one is walked back with each step's inverse
+std::optional<std::vector<std::pair<FormulaId, std::string>>>
+replacementChain(FormulaStore& fs, FormulaId from, FormulaId to) {
+    constexpr size_t MaxSteps = 64;
+
+    auto path = [&](FormulaId f) {
+        std::vector<std::pair<FormulaId, Law>> steps = {{f, Law::DN}};
+        while (steps.size() < MaxSteps) {
+            auto step = normalStep(fs, steps.back().first);
+            if (!step) break;
+            steps.push_back(*step);
+        }
+        return steps;
+    };
 
-                std::string inner = b.substr(2, b.size() - 3); // strip outer ~(...)
-                size_t vPos = inner.find("v");
-                if (vPos == std::string::npos) return false;
+    auto forward = path(from);
+    auto backward = path(to);
 
-                std::string left = trim(inner.substr(0, vPos));
-                std::string right = trim(inner.substr(vPos + 1));
+    std::unordered_map<FormulaId, size_t> onBackward;
+    for (size_t j = 0; j < backward.size(); ++j) onBackward.emplace(backward[j].first, j);
 
-                return (left.rfind("~", 0) == 0 && right.rfind("~", 0) == 0);
-            };
+    for (size_t i = 0; i < forward.size(); ++i) {
+        auto meet = onBackward.find(forward[i].first);
+        if (meet == onBackward.end()) continue;
 
-            if (isDeMorganSDMO(left, right) || isDeMorganSDMO(right, left)) {
-                return expr;
-            }
+        std::vector<std::pair<FormulaId, std::string>> chain;
+        for (size_t k = 1; k <= i; ++k)
+            chain.emplace_back(forward[k].first, lawRule(forward[k].second, false));
+        for (size_t k = meet->second; k > 0; --k)
+            chain.emplace_back(backward[k - 1].first, lawRule(backward[k].second, true));
+        return chain;
+    }
+    return std::nullopt;
+}
 
-            return std::nullopt;
-        }
+// Shared matcher for the De Morgan recognizers: expr is lhs <-> rhs and
+// either side equals build(other side) modulo AC. The rewrites are only
+// probed, so a biconditional that does not match adds nothing to the store.
+template <typename Build>
+static std::optional<FormulaId> matchEquivalence(FormulaStore& fs, FormulaId expr, Build build) {
+    auto sides = binary(fs, expr, Connective::Iff);
+    if (!sides) return std::nullopt;
+
+    FormulaStore::Probe probe(fs);
+    auto [left, right] = *sides;
+    auto l = build(left);
+    auto r = build(right);
+    if ((l && *l == right) || (r && *r == left)) return expr;
+
+    return std::nullopt;
+}
+
+// Second De Morgan One
+// From (φ ^ ψ) <-> ~(~φ v ~ψ) or vice versa
+Rule makeD_SDMO() {
+    return {
+        "D-SDMO",
+        1,
+        [](FormulaStore& fs, const std::vector<FormulaId>& premises, Conclusions& out) {
+            emit(out, matchEquivalence(fs, premises[0], [&](FormulaId a) { return rewriteTop(fs, a, Law::SDMO); }));
+        },
+        IffHead,
+        IffHead,
+        IffHead
     };
 }
 
@@ -457,39 +540,12 @@ Rule makeD_DMO() {
     return {
         "D-DMO",
         1,
-        [](const std::vector<std::string>& premises) -> std::optional<std::string> {
-            std::string expr = normalizeConnectives(trim(premises[0]));
-            size_t iffPos = expr.find("<->");
-            if (iffPos == std::string::npos) return std::nullopt;
-
-            std::string left = trim(expr.substr(0, iffPos));
-            std::string right = trim(expr.substr(iffPos + 3));
-
-            // Matcher: ~(A v B) <-> (~A ^ ~B)
-            auto isDeMorganDMO = [](const std::string& a, const std::string& b) -> bool {
-                // Check if a is ~(...v...)
-                if (a.rfind("~(", 0) != 0 || a.back() != ')') return false;
-                std::string innerA = a.substr(2, a.size() - 3);
-                size_t vPos = innerA.find("v");
-                if (vPos == std::string::npos) return false;
-                std::string left = trim(innerA.substr(0, vPos));
-                std::string right = trim(innerA.substr(vPos + 1));
-                if (left.rfind("~", 0) != 0 || right.rfind("~", 0) != 0) return false;
-
-                // Check if b is conjunction
-                size_t andPos = b.find("^");
-                if (andPos == std::string::npos) return false;
-                std::string b1 = trim(b.substr(0, andPos));
-                std::string b2 = trim(b.substr(andPos + 1));
-                return (b1 == left && b2 == right);
-            };
-
-            if (isDeMorganDMO(left, right) || isDeMorganDMO(right, left)) {
-                return expr;
-            }
-
-            return std::nullopt;
-        }
+        [](FormulaStore& fs, const std::vector<FormulaId>& premises, Conclusions& out) {
+            emit(out, matchEquivalence(fs, premises[0], [&](FormulaId a) { return rewriteTop(fs, a, Law::DMO); }));
+        },
+        IffHead,
+        IffHead,
+        IffHead
     };
 }
 
@@ -499,39 +555,12 @@ Rule makeD_DMT() {
     return {
         "D-DMT",
         1,
-        [](const std::vector<std::string>& premises) -> std::optional<std::string> {
-            std::string expr = normalizeConnectives(trim(premises[0]));
-            size_t iffPos = expr.find("<->");
-            if (iffPos == std::string::npos) return std::nullopt;
-
-            std::string left = trim(expr.substr(0, iffPos));
-            std::string right = trim(expr.substr(iffPos + 3));
-
-            // Matcher: ~(A ^ B) <-> (~A v ~B)
-            auto isDMT = [](const std::string& a, const std::string& b) -> bool {
-                // Left side must be ~(...) with ^ inside
-                if (a.rfind("~(", 0) != 0 || a.back() != ')') return false;
-                std::string inner = a.substr(2, a.size() - 3);
-                size_t andPos = inner.find("^");
-                if (andPos == std::string::npos) return false;
-                std::string leftConj = trim(inner.substr(0, andPos));
-                std::string rightConj = trim(inner.substr(andPos + 1));
-                if (leftConj.rfind("~", 0) != 0 || rightConj.rfind("~", 0) != 0) return false;
-
-                // Right side must be a disjunction of those same negated parts
-                size_t orPos = b.find("v");
-                if (orPos == std::string::npos) return false;
-                std::string b1 = trim(b.substr(0, orPos));
-                std::string b2 = trim(b.substr(orPos + 1));
-                return (b1 == leftConj && b2 == rightConj);
-            };
-
-            if (isDMT(left, right) || isDMT(right, left)) {
-                return expr;
-            }
-
-            return std::nullopt;
-        }
+        [](FormulaStore& fs, const std::vector<FormulaId>& premises, Conclusions& out) {
+            emit(out, matchEquivalence(fs, premises[0], [&](FormulaId a) { return rewriteTop(fs, a, Law::DMT); }));
+        },
+        IffHead,
+        IffHead,
+        IffHead
     };
 }
 
@@ -541,43 +570,12 @@ Rule makeD_SDMT() {
     return {
         "D-SDMT",
         1,
-        [](const std::vector<std::string>& premises) -> std::optional<std::string> {
-            std::string expr = normalizeConnectives(trim(premises[0]));
-            size_t iffPos = expr.find("<->");
-            if (iffPos == std::string::npos) return std::nullopt;
-
-            std::string left = trim(expr.substr(0, iffPos));
-            std::string right = trim(expr.substr(iffPos + 3));
-
-            // Matcher: (A v B) <-> ~(~A ^ ~B)
-            auto isSDMT = [](const std::string& a, const std::string& b) -> bool {
-                // First side must be (A v B)
-                size_t orPos = a.find("v");
-                if (a.front() != '(' || a.back() != ')' || orPos == std::string::npos)
-                    return false;
-                std::string leftOr = trim(a.substr(1, orPos - 1));
-                std::string rightOr = trim(a.substr(orPos + 1, a.size() - orPos - 2));
-
-                // Second side must be ~(~A ^ ~B)
-                if (b.rfind("~(", 0) != 0 || b.back() != ')') return false;
-                std::string inner = b.substr(2, b.size() - 3);
-                size_t andPos = inner.find("^");
-                if (andPos == std::string::npos) return false;
-                std::string leftConj = trim(inner.substr(0, andPos));
-                std::string rightConj = trim(inner.substr(andPos + 1));
-                if (leftConj.rfind("~", 0) != 0 || rightConj.rfind("~", 0) != 0) return false;
-
-                std::string negLeftOr = "~" + leftOr;
-                std::string negRightOr = "~" + rightOr;
-                return (leftConj == negLeftOr && rightConj == negRightOr);
-            };
-
-            if (isSDMT(left, right) || isSDMT(right, left)) {
-                return expr;
-            }
-
-            return std::nullopt;
-        }
+        [](FormulaStore& fs, const std::vector<FormulaId>& premises, Conclusions& out) {
+            emit(out, matchEquivalence(fs, premises[0], [&](FormulaId a) { return rewriteTop(fs, a, Law::SDMT); }));
+        },
+        IffHead,
+        IffHead,
+        IffHead
     };
 }
 
@@ -588,13 +586,13 @@ Rule makeD_PBC() {
     return {
         "D-PBC",
         3,
-        [](const std::vector<std::string>& premises) -> std::optional<std::string> {
-            std::string a = trim(premises[0]);
-            std::string b = trim(premises[1]);
-            std::string c = trim(premises[2]);
+        [](FormulaStore& fs, const std::vector<FormulaId>& premises, Conclusions& out) {
+            FormulaId a = premises[0];
+            FormulaId b = premises[1];
+            FormulaId c = premises[2];
 
             // Try all permutations of the premises to find the pattern
-            std::vector<std::string> perms[] = {
+            const FormulaId perms[][3] = {
                 {a, b, c},
                 {a, c, b},
                 {b, a, c},
@@ -604,51 +602,39 @@ Rule makeD_PBC() {
             };
 
             for (const auto& p : perms) {
-                auto imp1 = splitImplication(p[0]);
-                auto disj  = p[1];
-                auto imp2 = splitImplication(p[2]);
-
-                if (imp1 && imp2 &&
-                    normalizeConnectives(disj).find("v") != std::string::npos) {
-                    
-                    std::string phi1 = trim(imp1->first);
-                    std::string chi1 = trim(imp1->second);
-
-                    std::string phi2 = trim(imp2->first);
-                    std::string chi2 = trim(imp2->second);
+                auto imp1 = binary(fs, p[0], Connective::Implies);
+                FormulaId disj = p[1];
+                auto imp2 = binary(fs, p[2], Connective::Implies);
 
+                if (imp1 && imp2 && fs.is(disj, Connective::Or)) {
                     // Make sure both conditionals conclude the same thing
-                    if (chi1 != chi2)
+                    if (imp1->second != imp2->second)
                         continue;
 
-                    // Check that the disjunction contains both antecedents
-                    std::string disjNorm = normalizeConnectives(disj);
-                    if ((disjNorm == (phi1 + "v" + phi2)) || (disjNorm == (phi2 + "v" + phi1))) {
-                        return chi1;
-                    }
+                    // Check that the disjunction is exactly the two antecedents (modulo AC)
+                    FormulaStore::Probe probe(fs);
+                    if (fs.disjoin(imp1->first, imp2->first) == disj) emit(out, imp1->second);
                 }
             }
-
-            return std::nullopt;
-        }
+        },
+        OrHead | ImpliesHead,
+        OrHead | ImpliesHead,
+        AnyShape
     };
 }
 
+// Negated Conditional
+// ~(φ -> ψ) <-> (φ ^ ~ψ) or vice versa
 Rule makeD_NC() {
     return {
         "D-NC",
         1,
-        [](const std::vector<std::string>& premises) -> std::optional<std::string> {
-            std::string expr = trim(premises[0]);
-
-            const std::string form1 = "~(\u03c6->\u03c8)<->(\u03c6^~\u03c8)";
-            const std::string form2 = "(\u03c6^~\u03c8)<->~(\u03c6->\u03c8)";
-
-            if (expr == form1 || expr == form2)
-                return expr;
-
-            return std::nullopt;
-        }
+        [](FormulaStore& fs, const std::vector<FormulaId>& premises, Conclusions& out) {
+            emit(out, matchEquivalence(fs, premises[0], [&](FormulaId a) { return rewriteTop(fs, a, Law::NC); }));
+        },
+        IffHead,
+        IffHead,
+        IffHead
     };
 }
 
@@ -665,7 +651,6 @@ std::vector<Rule> getAllRules() {
         makeBC(),
         makeCB(),
 
-        /*
         makeD_HS(),
         makeD_MCC(),
         makeD_MCNA(),
@@ -680,6 +665,5 @@ std::vector<Rule> getAllRules() {
         makeD_SDMT(),
         makeD_PBC(),
         makeD_NC()
-        */
     };
 }
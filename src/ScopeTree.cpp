@@ -0,0 +1,81 @@
+#include "ScopeTree.h"
+#include <algorithm>
+
+ScopeTree::ScopeTree() {
+    scopes.push_back({-1, -1, 0, true});
+    stack.push_back(0);
+}
+
+void ScopeTree::open(int showLine) {
+    stack.push_back(static_cast<int>(first.scopes + scopes.size()));
+    scopes.push_back({stack[stack.size() - 2], showLine, lines.size(), true});
+}
+
+void ScopeTree::close() {
+    if (stack.size() == 1) return;
+
+    Scope& scope = scopes[stack.back() - first.scopes];
+    scope.open = false;
+    truncate(scope.mark);
+    stack.pop_back();
+}
+
+void ScopeTree::add(int line, Connective head) {
+    size_t index = line - first.indexed;
+    if (index >= scopeOf.size()) scopeOf.resize(index + 1, -1);
+    scopeOf[index] = stack.back();
+    lines.push_back(line);
+    headOf.push_back(head);
+    headCount[static_cast<int>(head)]++;
+}
+
+void ScopeTree::truncate(size_t size) {
+    for (size_t i = size; i < lines.size(); ++i) headCount[static_cast<int>(headOf[i])]--;
+    lines.resize(std::min(lines.size(), size));
+    headOf.resize(lines.size());
+}
+
+// Scopes open at the mark are still open (attempts never close a scope they
+// did not open), so only the tails added since need to go
+void ScopeTree::rollback(const Mark& mark) {
+    scopes.resize(std::min(scopes.size(), mark.scopes - first.scopes));
+    stack.resize(std::min(stack.size(), mark.open));
+    truncate(mark.lines);
+    scopeOf.resize(std::min(scopeOf.size(), mark.indexed - first.indexed));
+}
+
+bool ScopeTree::isAccessible(int line) const {
+    if (line < 0) return false;
+    if (static_cast<size_t>(line) < first.indexed) return base->isAccessible(line);
+    size_t index = line - first.indexed;
+    if (index >= scopeOf.size() || scopeOf[index] < 0) return false;
+    return scope(scopeOf[index]).open;
+}
+
+// The inherited scopes stay open in base and here alike
+void ScopeTree::extend(const ScopeTree& base) {
+    this->base = &base;
+    first = base.mark();
+    scopes.clear();
+    stack = base.stack;
+    lines = base.lines;
+    headOf = base.headOf;
+    headCount = base.headCount;
+    scopeOf.clear();
+}
+
+void ScopeTree::absorb(ScopeTree&& extension) {
+    scopes.insert(scopes.end(), extension.scopes.begin(), extension.scopes.end());
+    stack = std::move(extension.stack);
+    lines = std::move(extension.lines);
+    headOf = std::move(extension.headOf);
+    headCount = extension.headCount;
+    scopeOf.insert(scopeOf.end(), extension.scopeOf.begin(), extension.scopeOf.end());
+}
+
+ShapeMask ScopeTree::heads() const {
+    ShapeMask mask = 0;
+    for (size_t i = 0; i < headCount.size(); ++i)
+        if (headCount[i] > 0) mask |= ShapeMask{1} << i;
+    return mask;
+}
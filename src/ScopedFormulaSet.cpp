@@ -0,0 +1,56 @@
+#include "ScopedFormulaSet.h"
+#include <algorithm>
+
+bool ScopedFormulaSet::insert(FormulaId f, size_t line) {
+    if (held(f) || (base && base->contains(f))) return false;
+    if (static_cast<size_t>(f) >= lines.size()) lines.resize(static_cast<size_t>(f) + 1, NoLine);
+    lines[f] = line;
+    undo.push_back(f);
+    return true;
+}
+
+std::optional<size_t> ScopedFormulaSet::line(FormulaId f) const {
+    if (!held(f)) return base ? base->line(f) : std::nullopt;
+    return lines[f];
+}
+
+void ScopedFormulaSet::unset(size_t from) {
+    for (size_t i = from; i < undo.size(); ++i) lines[undo[i]] = NoLine;
+    undo.resize(std::min(undo.size(), from));
+}
+
+void ScopedFormulaSet::popScope() {
+    if (marks.empty()) return;
+
+    unset(marks.back() - inherited.insertions);
+    marks.pop_back();
+}
+
+void ScopedFormulaSet::rollback(const Mark& mark) {
+    unset(mark.insertions - inherited.insertions);
+    marks.resize(std::min(marks.size(), mark.scopes - inherited.scopes));
+}
+
+void ScopedFormulaSet::clear() {
+    base = nullptr;
+    inherited = {0, 0};
+    unset(0);
+    marks.clear();
+}
+
+void ScopedFormulaSet::extend(const ScopedFormulaSet& base) {
+    clear();
+    this->base = &base;
+    inherited = base.mark();
+}
+
+// The extension's marks already count our insertions and scopes
+void ScopedFormulaSet::absorb(ScopedFormulaSet&& extension) {
+    for (FormulaId f : extension.undo) {
+        if (static_cast<size_t>(f) >= lines.size()) lines.resize(static_cast<size_t>(f) + 1, NoLine);
+        lines[f] = extension.lines[f];
+        undo.push_back(f);
+    }
+    marks.insert(marks.end(), extension.marks.begin(), extension.marks.end());
+    extension.clear();
+}
@@ -0,0 +1,82 @@
+#include "SolveStream.h"
+#include <algorithm>
+
+SolveStream::SolveStream(ProofSolver& solver) : solver(solver) {
+    solver.setStopFlag(&stop);
+    solver.setLineObserver([this](const Statement& line) { publish({StreamEvent::Kind::Line, line}); });
+    solver.setRetractObserver([this](int from) { publish({StreamEvent::Kind::Retract, {}, from}); });
+}
+
+SolveStream::~SolveStream() {
+    drop();
+    solver.setLineObserver(nullptr);
+    solver.setRetractObserver(nullptr);
+    solver.setStopFlag(nullptr);
+}
+
+// Runs on the worker: publish the event, then park until resumed
+void SolveStream::publish(StreamEvent event) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (stop) return;
+
+    pending = std::move(event);
+    state = State::Idle;
+    handoff.notify_all();
+    handoff.wait(lock, [this] { return state == State::Running || stop; });
+}
+
+std::optional<StreamEvent> SolveStream::next() {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (state == State::Finished) return std::nullopt;
+
+    state = State::Running;
+    pending.reset();
+    if (!worker.joinable()) {
+        worker = std::thread([this] {
+            solver.solve();
+            std::lock_guard<std::mutex> done(mutex);
+            state = State::Finished;
+            handoff.notify_all();
+        });
+    } else {
+        handoff.notify_all();
+    }
+
+    handoff.wait(lock, [this] { return state != State::Running; });
+    return pending;
+}
+
+size_t SolveStream::resume(size_t budget, std::vector<Statement>& out) {
+    size_t applied = 0;
+    while (applied < budget) {
+        auto event = next();
+        if (!event) break;
+        if (event->kind == StreamEvent::Kind::Line) {
+            out.push_back(std::move(event->line));
+        } else {
+            auto withdrawn = std::find_if(out.begin(), out.end(),
+                                          [&](const Statement& line) { return line.lineNumber >= event->from; });
+            out.erase(withdrawn, out.end());
+        }
+        applied++;
+    }
+    return applied;
+}
+
+void SolveStream::drop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+        handoff.notify_all();
+    }
+    if (worker.joinable()) worker.join();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    state = State::Finished;
+    pending.reset();
+}
+
+bool SolveStream::finished() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return state == State::Finished;
+}
@@ -0,0 +1,121 @@
+#include "Term.h"
+
+TermId TermStore::intern(Term term) {
+    std::string key(1, static_cast<char>('0' + static_cast<int>(term.kind)));
+    key += term.name;
+    for (TermId arg : term.args) {
+        key += ',';
+        key += std::to_string(arg);
+    }
+
+    auto it = index.find(key);
+    if (it != index.end()) return it->second;
+
+    TermId id = static_cast<TermId>(terms.size());
+    terms.push_back(std::move(term));
+    index.emplace(std::move(key), id);
+    return id;
+}
+
+TermId TermStore::variable(std::string_view name) {
+    return intern({TermKind::Variable, std::string(name), {}});
+}
+
+TermId TermStore::constant(std::string_view name) {
+    return intern({TermKind::Constant, std::string(name), {}});
+}
+
+TermId TermStore::function(std::string_view name, std::vector<TermId> args) {
+    return intern({TermKind::Function, std::string(name), std::move(args)});
+}
+
+TermId TermStore::find(TermKind kind, const std::string& name) const {
+    std::string key(1, static_cast<char>('0' + static_cast<int>(kind)));
+    auto it = index.find(key + name);
+    return it == index.end() ? NoTerm : it->second;
+}
+
+bool TermStore::ground(TermId t) const {
+    const Term& term = terms[t];
+    if (term.kind == TermKind::Variable) return false;
+    for (TermId arg : term.args)
+        if (!ground(arg)) return false;
+    return true;
+}
+
+bool TermStore::occurs(TermId var, TermId t) const {
+    if (t == var) return true;
+    for (TermId arg : terms[t].args)
+        if (occurs(var, arg)) return true;
+    return false;
+}
+
+std::string TermStore::render(TermId t) const {
+    const Term& term = terms[t];
+    if (term.kind != TermKind::Function) return term.name;
+
+    std::string out = term.name + "(";
+    for (size_t i = 0; i < term.args.size(); ++i) {
+        if (i > 0) out += ",";
+        out += render(term.args[i]);
+    }
+    return out + ")";
+}
+
+TermId TermStore::substitute(TermId t, TermId var, TermId replacement) {
+    if (t == var) return replacement;
+    if (terms[t].kind != TermKind::Function) return t;
+
+    std::vector<TermId> args = terms[t].args;
+    bool changed = false;
+    for (TermId& arg : args) {
+        TermId next = substitute(arg, var, replacement);
+        changed = changed || next != arg;
+        arg = next;
+    }
+    return changed ? function(terms[t].name, std::move(args)) : t;
+}
+
+TermId TermStore::resolve(TermId t, const Substitution& s) const {
+    while (terms[t].kind == TermKind::Variable) {
+        auto it = s.find(t);
+        if (it == s.end()) break;
+        t = it->second;
+    }
+    return t;
+}
+
+bool TermStore::occursUnder(TermId var, TermId t, const Substitution& s) const {
+    t = resolve(t, s);
+    if (t == var) return true;
+    for (TermId arg : terms[t].args)
+        if (occursUnder(var, arg, s)) return true;
+    return false;
+}
+
+bool TermStore::unifyInto(TermId a, TermId b, Substitution& s) const {
+    a = resolve(a, s);
+    b = resolve(b, s);
+    if (a == b) return true;
+
+    if (terms[a].kind == TermKind::Variable) {
+        if (occursUnder(a, b, s)) return false;
+        s[a] = b;
+        return true;
+    }
+    if (terms[b].kind == TermKind::Variable) return unifyInto(b, a, s);
+
+    const Term& x = terms[a];
+    const Term& y = terms[b];
+    if (x.kind != y.kind || x.name != y.name || x.args.size() != y.args.size()) return false;
+    for (size_t i = 0; i < x.args.size(); ++i)
+        if (!unifyInto(x.args[i], y.args[i], s)) return false;
+    return true;
+}
+
+bool TermStore::unify(TermId a, TermId b, Substitution& s) const {
+    Substitution attempt = s;
+    if (!unifyInto(a, b, attempt)) return false;
+    s = std::move(attempt);
+    return true;
+}
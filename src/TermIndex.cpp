@@ -0,0 +1,111 @@
+#include "TermIndex.h"
+#include <algorithm>
+
+namespace {
+
+const std::string Wildcard = "*";
+
+} // namespace
+
+// Symbols carry their arity so a wildcard can skip a whole subterm
+std::string TermIndex::symbol(const Term& term) {
+    if (term.kind == TermKind::Variable) return Wildcard;
+    if (term.kind == TermKind::Constant) return term.name + "/0";
+    return term.name + "/" + std::to_string(term.args.size());
+}
+
+int TermIndex::arity(const std::string& symbol) {
+    return std::stoi(symbol.substr(symbol.rfind('/') + 1));
+}
+
+void TermIndex::flatten(TermId t, const TermStore& terms, std::vector<std::string>& out) const {
+    const Term& term = terms.get(t);
+    out.push_back(symbol(term));
+    if (term.kind == TermKind::Variable) return;
+    for (TermId arg : term.args) flatten(arg, terms, out);
+}
+
+void TermIndex::insert(FormulaId atom, const FormulaStore& store) {
+    if (!store.is(atom, Connective::Predicate) || inserted.count(atom)) return;
+
+    const Formula& node = store.get(atom);
+    std::vector<std::string> keys = {node.name + "/" + std::to_string(node.terms.size())};
+    for (TermId t : node.terms) {
+        if (!store.termStore().ground(t)) return;
+        flatten(t, store.termStore(), keys);
+    }
+
+    int current = 0;
+    for (const auto& key : keys) {
+        auto it = nodes[current].children.find(key);
+        if (it == nodes[current].children.end()) {
+            int next = static_cast<int>(nodes.size());
+            nodes[current].children.emplace(key, next);
+            nodes.emplace_back();
+            nodes[next].parent = current;
+            nodes[next].edge = key;
+            current = next;
+        } else {
+            current = it->second;
+        }
+    }
+    nodes[current].atoms.push_back(atom);
+    inserted.insert(atom);
+    order.emplace_back(atom, current);
+}
+
+// Atoms are appended to their node in insertion order, so the ones to drop
+// are at the back; new nodes hang off older ones by a single link each
+void TermIndex::rollback(const Mark& mark) {
+    while (order.size() > mark.atoms) {
+        auto [atom, node] = order.back();
+        order.pop_back();
+        inserted.erase(atom);
+        if (static_cast<size_t>(node) < mark.nodes) nodes[node].atoms.pop_back();
+    }
+    for (size_t n = nodes.size(); n-- > mark.nodes;) {
+        int parent = nodes[n].parent;
+        if (static_cast<size_t>(parent) < mark.nodes) nodes[parent].children.erase(nodes[n].edge);
+    }
+    nodes.resize(std::min(nodes.size(), mark.nodes));
+}
+
+// Nodes reached from node after skipping pending complete subterms
+void TermIndex::skip(int node, int pending, std::vector<int>& out) const {
+    if (pending == 0) {
+        out.push_back(node);
+        return;
+    }
+    for (const auto& [key, child] : nodes[node].children)
+        skip(child, pending - 1 + arity(key), out);
+}
+
+void TermIndex::retrieve(int node, const std::vector<std::string>& keys, size_t i,
+                         std::vector<FormulaId>& out) const {
+    if (i == keys.size()) {
+        out.insert(out.end(), nodes[node].atoms.begin(), nodes[node].atoms.end());
+        return;
+    }
+
+    if (keys[i] == Wildcard) {
+        std::vector<int> after;
+        skip(node, 1, after);
+        for (int next : after) retrieve(next, keys, i + 1, out);
+        return;
+    }
+
+    auto it = nodes[node].children.find(keys[i]);
+    if (it != nodes[node].children.end()) retrieve(it->second, keys, i + 1, out);
+}
+
+std::vector<FormulaId> TermIndex::candidates(FormulaId pattern, const FormulaStore& store) const {
+    std::vector<FormulaId> out;
+    if (!store.is(pattern, Connective::Predicate)) return out;
+
+    const Formula& node = store.get(pattern);
+    std::vector<std::string> keys = {node.name + "/" + std::to_string(node.terms.size())};
+    for (TermId t : node.terms) flatten(t, store.termStore(), keys);
+
+    retrieve(0, keys, 0, out);
+    return out;
+}
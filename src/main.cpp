@@ -1,20 +1,91 @@
 #include "ProofSolver.h"
+#include "ProofChecker.h"
+#include "BatchRunner.h"
+#include <fstream>
 #include <iostream>
 #include <string>
 
 int main(int argc, char* argv[]) {
     bool useBeautify = false;
+    bool useParallel = false;
+    bool usePortfolio = false;
+    std::string ruleStatsPath;
+    std::string batchPath;
+    std::string costModelPath;
+    std::shared_ptr<const LemmaLibrary> lemmas;
+    std::shared_ptr<const KnowledgeBase> knowledgeBase;
 
-    if (argc > 1 && std::string(argv[1]) == "--pretty") {
-        useBeautify = true;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--pretty") useBeautify = true;
+        else if (arg == "--parallel") useParallel = true;
+        else if (arg == "--portfolio") usePortfolio = true;
+        else if (arg == "--rule-stats" && i + 1 < argc) ruleStatsPath = argv[++i];
+        else if (arg == "--batch" && i + 1 < argc) batchPath = argv[++i];
+        else if (arg == "--cost-model" && i + 1 < argc) costModelPath = argv[++i];
+        else if (arg == "--lemmas" && i + 1 < argc) {
+            lemmas = LemmaLibrary::open(argv[++i]);
+            if (!lemmas) return 1;
+        }
+        else if (arg == "--compile-lemmas" && i + 2 < argc) {
+            // Check a lemma source file and write the binary library
+            bool ok = LemmaLibrary::compile(argv[i + 1], argv[i + 2]);
+            return ok ? 0 : 1;
+        }
+        else if (arg == "--kb" && i + 1 < argc) {
+            knowledgeBase = KnowledgeBase::open(argv[++i]);
+            if (!knowledgeBase) return 1;
+        }
+        else if (arg == "--compile-kb" && i + 2 < argc) {
+            // Parse a premise file and write the indexed knowledge base
+            bool ok = KnowledgeBase::compile(argv[i + 1], argv[i + 2]);
+            return ok ? 0 : 1;
+        }
+        else if (arg == "--check" && i + 1 < argc) {
+            // Verify a saved proof instead of solving
+            std::ifstream in(argv[++i]);
+            if (!in) {
+                std::cerr << "Cannot open " << argv[i] << "\n";
+                return 1;
+            }
+            ProofChecker checker(lemmas.get());
+            CheckResult result = checker.check(ProofChecker::parseProofText(in));
+            if (result.valid) {
+                std::cout << "VALID\n";
+                return 0;
+            }
+            std::cout << "INVALID at line " << result.line << ": " << result.message << "\n";
+            return 1;
+        }
+    }
+
+    if (!batchPath.empty()) {
+        // Solve every problem in the file, cheapest predicted first
+        CostModel model;
+        if (!costModelPath.empty()) model.load(costModelPath);
+        BatchRunner batch(model);
+        if (lemmas) batch.useLemmas(lemmas);
+        if (knowledgeBase) batch.useKnowledgeBase(knowledgeBase);
+        size_t failed = batch.addFile(batchPath);
+        batch.run();
+        if (!costModelPath.empty()) model.save(costModelPath);
+        return failed == 0 ? 0 : 1;
     }
 
     while (true) {
         ProofSolver solver;
         solver.enableBeautify(useBeautify);
+        solver.enableParallelSubproofs(useParallel);
+        solver.enablePortfolio(usePortfolio);
+        if (!ruleStatsPath.empty()) solver.loadRuleStats(ruleStatsPath);
+        if (lemmas) solver.useLemmas(lemmas);
+        if (knowledgeBase) solver.useKnowledgeBase(knowledgeBase);
         solver.readInput();
         solver.solve();
         solver.displayProof();
+        if (usePortfolio && !solver.winningStrategy().empty())
+            std::cout << "[PORTFOLIO] Proof found by " << solver.winningStrategy() << "\n";
+        if (!ruleStatsPath.empty()) solver.saveRuleStats(ruleStatsPath);
 
         std::cout << "\nEnter another proof, or press Ctrl+C to quit.\n\n";
     }
@@ -0,0 +1,242 @@
+#include "syllogism.h"
+#include "ProofSolver.h"
+#include "LemmaLibrary.h"
+#include "Utils.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+struct syl_solver {
+    std::string premises;
+    std::string conclusion;
+    bool hasInput = false;
+    size_t maxLines = 0;
+    unsigned timeLimitMs = 0;
+    bool portfolio = false;
+    std::shared_ptr<const LemmaLibrary> lemmas;
+    std::shared_ptr<const KnowledgeBase> knowledgeBase;
+
+    // Results of the last syl_solve()
+    std::vector<Statement> lines;
+    std::string proofText;
+    std::string strategy;
+};
+
+namespace {
+
+size_t copyOut(const std::string& text, char* buffer, size_t size) {
+    if (buffer && size > 0) {
+        size_t n = std::min(text.size(), size - 1);
+        std::memcpy(buffer, text.data(), n);
+        buffer[n] = '\0';
+    }
+    return text.size();
+}
+
+const Statement* lineAt(const syl_solver* solver, size_t index) {
+    if (!solver || index >= solver->lines.size()) return nullptr;
+    return &solver->lines[index];
+}
+
+bool parses(FormulaStore& store, const std::string& text) {
+    return store.parse(normalizeConnectives(trim(text))).has_value();
+}
+
+} // namespace
+
+extern "C" {
+
+unsigned syl_api_version(void) {
+    return SYL_API_VERSION;
+}
+
+syl_solver* syl_create(void) {
+    try {
+        return new syl_solver();
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void syl_destroy(syl_solver* solver) {
+    delete solver;
+}
+
+syl_status syl_set_input(syl_solver* solver, const char* premises, const char* conclusion) {
+    if (!solver || !premises || !conclusion) return SYL_INVALID_ARGUMENT;
+    try {
+        FormulaStore store;
+        for (const auto& item : splitPremiseList(premises))
+            if (!parses(store, item)) return SYL_INVALID_INPUT;
+        if (!parses(store, conclusion)) return SYL_INVALID_INPUT;
+
+        solver->premises = premises;
+        solver->conclusion = conclusion;
+        solver->hasInput = true;
+        return SYL_OK;
+    } catch (...) {
+        return SYL_ERROR;
+    }
+}
+
+syl_status syl_set_limits(syl_solver* solver, size_t max_lines, unsigned time_limit_ms) {
+    if (!solver) return SYL_INVALID_ARGUMENT;
+    solver->maxLines = max_lines;
+    solver->timeLimitMs = time_limit_ms;
+    return SYL_OK;
+}
+
+syl_status syl_set_lemmas(syl_solver* solver, const char* path) {
+    if (!solver) return SYL_INVALID_ARGUMENT;
+    try {
+        if (!path) {
+            solver->lemmas.reset();
+            return SYL_OK;
+        }
+        auto library = LemmaLibrary::open(path);
+        if (!library) return SYL_INVALID_INPUT;
+        solver->lemmas = std::move(library);
+        return SYL_OK;
+    } catch (...) {
+        return SYL_ERROR;
+    }
+}
+
+syl_status syl_set_knowledge_base(syl_solver* solver, const char* path) {
+    if (!solver) return SYL_INVALID_ARGUMENT;
+    try {
+        if (!path) {
+            solver->knowledgeBase.reset();
+            return SYL_OK;
+        }
+        auto kb = KnowledgeBase::open(path);
+        if (!kb) return SYL_INVALID_INPUT;
+        solver->knowledgeBase = std::move(kb);
+        return SYL_OK;
+    } catch (...) {
+        return SYL_ERROR;
+    }
+}
+
+syl_status syl_set_portfolio(syl_solver* solver, int enable) {
+    if (!solver) return SYL_INVALID_ARGUMENT;
+    solver->portfolio = enable != 0;
+    return SYL_OK;
+}
+
+syl_status syl_solve(syl_solver* solver) {
+    if (!solver || !solver->hasInput) return SYL_INVALID_ARGUMENT;
+    solver->lines.clear();
+    solver->proofText.clear();
+    solver->strategy.clear();
+
+    try {
+        ProofSolver engine;
+        engine.enableDiagnostics(false);
+        engine.enablePortfolio(solver->portfolio);
+        engine.setInput(solver->premises, solver->conclusion);
+        if (solver->lemmas) engine.useLemmas(solver->lemmas);
+        if (solver->knowledgeBase) engine.useKnowledgeBase(solver->knowledgeBase);
+
+        std::atomic<bool> stop{false};
+        std::atomic<bool> limited{false};
+        engine.setStopFlag(&stop);
+
+        // Enforced by the search itself, so portfolio forks keep to it too
+        if (solver->maxLines > 0) engine.setLineLimit(solver->maxLines);
+
+        // The time limit is enforced from a watchdog so that it also holds
+        // while a round is searching without appending lines
+        std::mutex mutex;
+        std::condition_variable done;
+        bool finished = false;
+        std::thread watchdog;
+        if (solver->timeLimitMs > 0) {
+            watchdog = std::thread([&, limit = std::chrono::milliseconds(solver->timeLimitMs)] {
+                std::unique_lock<std::mutex> lock(mutex);
+                if (!done.wait_for(lock, limit, [&] { return finished; })) {
+                    limited = true;
+                    stop = true;
+                }
+            });
+        }
+
+        engine.solve();
+
+        if (watchdog.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                finished = true;
+            }
+            done.notify_one();
+            watchdog.join();
+        }
+
+        solver->lines = engine.getProofLines();
+        std::ostringstream text;
+        engine.writeProof(text);
+        solver->proofText = text.str();
+        solver->strategy = engine.winningStrategy();
+
+        // Writing the proof out in binary steps can lengthen it past the limit
+        size_t kept = solver->lines.size();
+        if (solver->maxLines > 0 && kept > solver->maxLines) {
+            solver->lines.resize(solver->maxLines);
+            size_t end = 0; // the header line, then one text line per proof line
+            for (size_t i = 0; i <= solver->maxLines; ++i) end = solver->proofText.find('\n', end) + 1;
+            solver->proofText.resize(end);
+            return SYL_LIMIT_REACHED;
+        }
+
+        if (engine.wasConclusionDerived()) return SYL_PROVED;
+        return limited || engine.solveStats().lineCapped ? SYL_LIMIT_REACHED : SYL_NOT_PROVED;
+    } catch (...) {
+        return SYL_ERROR;
+    }
+}
+
+size_t syl_line_count(const syl_solver* solver) {
+    return solver ? solver->lines.size() : 0;
+}
+
+syl_status syl_get_line(const syl_solver* solver, size_t index, syl_line* out) {
+    const Statement* stmt = lineAt(solver, index);
+    if (!stmt || !out) return SYL_INVALID_ARGUMENT;
+    out->number = stmt->lineNumber;
+    out->indent = stmt->indentLevel;
+    out->reference_count = stmt->references.size();
+    return SYL_OK;
+}
+
+size_t syl_get_expression(const syl_solver* solver, size_t index, char* buffer, size_t size) {
+    const Statement* stmt = lineAt(solver, index);
+    return stmt ? copyOut(stmt->expression, buffer, size) : copyOut("", buffer, size);
+}
+
+size_t syl_get_rule(const syl_solver* solver, size_t index, char* buffer, size_t size) {
+    const Statement* stmt = lineAt(solver, index);
+    return stmt ? copyOut(stmt->justification, buffer, size) : copyOut("", buffer, size);
+}
+
+size_t syl_get_references(const syl_solver* solver, size_t index, int* buffer, size_t capacity) {
+    const Statement* stmt = lineAt(solver, index);
+    if (!stmt) return 0;
+    size_t n = std::min(capacity, stmt->references.size());
+    if (buffer) std::copy(stmt->references.begin(), stmt->references.begin() + n, buffer);
+    return stmt->references.size();
+}
+
+size_t syl_get_strategy(const syl_solver* solver, char* buffer, size_t size) {
+    return copyOut(solver ? solver->strategy : std::string(), buffer, size);
+}
+
+size_t syl_get_proof_text(const syl_solver* solver, char* buffer, size_t size) {
+    return copyOut(solver ? solver->proofText : std::string(), buffer, size);
+}
+
+} // extern "C"
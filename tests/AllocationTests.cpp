@@ -0,0 +1,134 @@
+#include "ProofSolver.h"
+#include "Rules.h"
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+// ANSI color codes
+#define GREEN   "\033[32m"
+#define RESET   "\033[0m"
+
+// Every heap allocation in this binary goes through the counter
+static size_t allocations = 0;
+
+void* operator new(size_t size) {
+    ++allocations;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+// Lines every rule has something to match against
+static const char* const Lines[] = {
+    "P", "Q", "~Q", "~~P", "P->Q", "Q->R", "~P->Q", "~Q->~P", "P^Q", "PvQ", "P<->Q",
+    "~(PvQ)<->(~P^~Q)", "~(P^Q)<->(~Pv~Q)", "(P^Q)<->~(~Pv~Q)", "~(P->Q)<->(P^~Q)", "~P->P"
+};
+
+// Applies every rule to every ordered premise tuple of the lines. A
+// application may allocate only for the formulas it adds to the store, so a
+// failed match, or one whose conclusions already exist, allocates nothing.
+static void checkRuleApplications() {
+    FormulaStore store;
+    store.reserve(1 << 16);
+    std::vector<FormulaId> lines;
+    for (const char* text : Lines) lines.push_back(*store.parse(text));
+
+    Conclusions out;
+    out.reserve(16);
+    std::vector<FormulaId> premises;
+    premises.reserve(Rule::MaxPremises);
+    size_t n = lines.size();
+
+    for (const Rule& rule : getAllRules()) {
+        size_t tuples = 1;
+        for (int k = 0; k < rule.numPremises; ++k) tuples *= n;
+
+        for (int pass = 0; pass < 2; ++pass) {
+            for (size_t t = 0; t < tuples; ++t) {
+                premises.clear();
+                for (size_t rest = t, k = 0; k < static_cast<size_t>(rule.numPremises); ++k, rest /= n)
+                    premises.push_back(lines[rest % n]);
+
+                out.clear();
+                size_t formulasBefore = store.size();
+                size_t before = allocations;
+                rule.apply(store, premises, out);
+                size_t used = allocations - before;
+                size_t added = store.size() - formulasBefore;
+
+                if (used > added || (pass == 1 && used > 0)) {
+                    std::cerr << rule.name << " allocated " << used << " times for " << added
+                              << " new formulas on pass " << pass << "\n";
+                    assert(false);
+                }
+            }
+        }
+        std::cout << GREEN << "Passed: " << rule.name << RESET << "\n";
+    }
+}
+
+// A forward proof runs many saturation rounds over hundreds of lines, so its
+// rule applications number in the millions, nearly all failed matches. After
+// the first round has sized the buffers, a round may allocate about once for
+// each line it adds and once for the formulas matching that line takes (a
+// conditional's negated consequent, say), plus the few buffers that double
+// once more: its failed matches allocate nothing, and a round adding no line
+// would allocate nothing either.
+static void checkSaturation() {
+    // The binary rule table the proof is written out with is built once, on
+    // first use, outside the count
+    ProofSolver warmUp;
+    warmUp.enableDiagnostics(false);
+    warmUp.setInput("A,A->B,B->~~C", "C");
+    warmUp.solve();
+
+    ProofSolver solver;
+    solver.enableDiagnostics(false);
+    solver.setInput("P->Q,Q->R,R->S,S->T,~T", "~P");
+
+    // Allocations, lines and premise tuples when each open round started;
+    // reserved, so the bookkeeping itself allocates nothing
+    struct Mark { size_t allocations, lines, combinations; };
+    std::vector<Mark> open;
+    open.reserve(64);
+    constexpr size_t Regrowth = 32;
+    size_t rounds = 0;
+    size_t measured = 0;
+    size_t mostlyFailed = 0;
+
+    solver.setRoundObserver([&](bool ended, size_t lines) {
+        if (!ended) {
+            open.push_back({allocations, lines, solver.solveStats().combinations});
+            return;
+        }
+        size_t used = allocations - open.back().allocations;
+        size_t added = lines - open.back().lines;
+        size_t tried = solver.solveStats().combinations - open.back().combinations;
+        open.pop_back();
+        if (!open.empty() || rounds++ == 0) return;
+
+        std::cout << "[ROUND] " << used << " allocations for " << added << " lines, "
+                  << tried << " premise tuples\n";
+        assert(added == 0 ? used == 0 : used <= 2 * added + Regrowth);
+        ++measured;
+        if (tried > 100 * added) ++mostlyFailed;
+    });
+    solver.solve();
+
+    assert(measured > 0 && mostlyFailed > 0);
+    std::cout << GREEN << "Passed: saturation allocates per derived line" << RESET << "\n";
+}
+
+int main() {
+    std::cout << "=== Rule Applications ===\n";
+    checkRuleApplications();
+
+    std::cout << "\n=== Saturation Rounds ===\n";
+    checkSaturation();
+
+    std::cout << "\nAll allocation tests passed.\n";
+    return 0;
+}
@@ -1,6 +1,19 @@
 #include "ProofSolver.h"
+#include "ProofChecker.h"
+#include "SolveStream.h"
+#include "EGraph.h"
+#include "EntailmentOracle.h"
+#include "ImplicationIndex.h"
 #include "Utils.h"
+#include "Rules.h"
+#include "BatchRunner.h"
+#include "ProblemCorpus.h"
+#include "syllogism.h"
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
 #include <sstream>
 #include <iostream>
 
@@ -9,10 +22,13 @@
 #define RED     "\033[31m"
 #define RESET   "\033[0m"
 
-void runTest(const std::string& premisesStr, const std::string& conclusion, const std::string& expectedLastLine) {
+void runTest(const std::string& premisesStr, const std::string& conclusion, const std::string& expectedLastLine,
+             bool parallel = false, std::shared_ptr<const LemmaLibrary> lemmas = nullptr) {
     std::cout << "[" << expectedLastLine.substr(expectedLastLine.find(':') + 1) << "] Testing: " << conclusion << "\n";
     ProofSolver solver;
     solver.enableBeautify(false);
+    solver.enableParallelSubproofs(parallel);
+    if (lemmas) solver.useLemmas(lemmas);
     solver.setInput(premisesStr, conclusion);
 
     solver.solve();
@@ -23,6 +39,11 @@ void runTest(const std::string& premisesStr, const std::string& conclusion, cons
     std::cout.rdbuf(oldCout);
 
     std::string proofOutput = out.str();
+    if (!solver.checkProof()) {
+        std::cerr << RED << "Proof failed independent check: " << conclusion << RESET << "\n";
+        std::cerr << RED << proofOutput << RESET << "\n";
+        assert(false);
+    }
     if (proofOutput.find(expectedLastLine) == std::string::npos) {
         std::cerr << RED << "Test failed for conclusion: " << conclusion << RESET << "\n";
         std::cerr << RED << "Expected to find line: " << expectedLastLine << RESET << "\n";
@@ -33,6 +54,22 @@ void runTest(const std::string& premisesStr, const std::string& conclusion, cons
     }
 }
 
+void runCheck(const std::string& label, const std::string& proofText, bool expectValid,
+              const LemmaLibrary* lemmas = nullptr) {
+    std::cout << "[CHECK] Testing: " << label << "\n";
+    std::stringstream in(proofText);
+    ProofChecker checker(lemmas);
+    CheckResult result = checker.check(ProofChecker::parseProofText(in));
+
+    if (result.valid != expectValid) {
+        std::cerr << RED << "Checker verdict wrong for: " << label << RESET << "\n";
+        std::cerr << RED << "Line " << result.line << ": " << result.message << RESET << "\n";
+        assert(false);
+    } else {
+        std::cout << GREEN << "Passed: " << label << RESET << "\n";
+    }
+}
+
 int main() {
     std::cout << "=== Basic Rules ===\n";
     std::cout << "[MP] "; runTest("P,P->Q", "Q", "Q    :MP 2 3");
@@ -46,6 +83,71 @@ int main() {
     std::cout << "[BC] "; runTest("P<->Q,Q->P", "P->Q", "P->Q    :BC 2 3");
     std::cout << "[CB] "; runTest("P->Q,Q->P", "P<->Q", "P<->Q    :CB 2 3");
 
+    std::cout << "\n=== AC Normalization ===\n";
+    std::cout << "[MTP] "; runTest("(PvQ)vR,~Q", "PvR", "PvQ    :MTP 2 13");
+    std::cout << "[ADJ] "; runTest("Q,P", "P^Q", "P^Q    :ADJ 2 3");
+
+    std::cout << "\n=== Binary Layouts ===\n";
+    std::cout << "[PR] "; runTest("(P^Q)^R", "P", "(P^Q)^R    :PR");
+    std::cout << "[PR] "; runTest("(P^Q)^R -> S,PvQvR,~P,~Q", "R", "(P^Q)^R -> S    :PR");
+    std::cout << "[PR] "; runTest("(P^Q)^R -> S,PvQvR,~P,~Q", "R", "PvQvR    :PR");
+    std::cout << "[S] "; runTest("(P^Q)^R", "P", "P^Q    :S 2");
+    std::cout << "[S] "; runTest("(P^Q)^R", "P", "P    :S 3");
+    std::cout << "[ADJ] "; runTest("P,Q,R", "(P^Q)^R", "(P^Q)^R    :ADJ 4 5");
+    std::cout << "[MTP] "; runTest("(PvQ)vR,~P", "QvR", "P    :MTP 9 14");
+    std::cout << "[MP] "; runTest("(P^Q)^R->S,P,Q,R", "S", "S    :MP 2 7");
+    {
+        // Regrouping cites a step already on a citable line instead of
+        // deriving it again: no layout is written twice where both are citable
+        const std::pair<const char*, const char*> problems[] = {
+            {"(P^Q)^R", "P^(Q^R)"}, {"(P^Q)^(R^S)", "(S^R)^(Q^P)"}, {"(P^Q)^R->S", "(P^(Q^R))->S"}
+        };
+        for (const auto& [premises, goal] : problems) {
+            ProofSolver solver;
+            solver.enableDiagnostics(false);
+            solver.setInput(premises, goal);
+            solver.solve();
+            assert(solver.wasConclusionDerived() && solver.checkProof());
+
+            // Expressions on the lines citable at each depth, by scope
+            std::vector<std::vector<std::string>> scopes(1);
+            for (const Statement& line : solver.getProofLines()) {
+                if (line.formula == NoFormula) continue;
+                size_t depth = static_cast<size_t>(line.indentLevel);
+                if (line.expression.rfind("Show: ", 0) == 0) {
+                    scopes.resize(depth + 2);
+                    scopes[depth + 1].clear();
+                    continue;
+                }
+                scopes.resize(depth + 1);
+                for (const auto& scope : scopes)
+                    assert(std::find(scope.begin(), scope.end(), line.expression) == scope.end());
+                scopes[depth].push_back(line.expression);
+            }
+        }
+        std::cout << GREEN << "Passed: no layout is derived twice in one scope" << RESET << "\n";
+    }
+
+    std::cout << "\n=== Indirect Derivation ===\n";
+    std::cout << "[ID] "; runTest("~(PvQ)->R,~R", "PvQ", "    :ID 3 6");
+    std::cout << "[ID] "; runTest("~R", "~(R^Q)", "~(R^Q)    :ID 2 7");
+
+    std::cout << "\n=== Split Goals ===\n";
+    std::cout << "[ADJ] "; runTest("Q", "Q^(Q->Q)", "Q^(Q->Q)    :ADJ 2 5");
+    std::cout << "[CB] "; runTest("S", "Q<->Q", "Q<->Q    :CB 5 5");
+    std::cout << "[ADJ] "; runTest("P->Q,Q->P,R", "(P<->Q)^R", "(P<->Q)^R    :ADJ 4 5");
+
+    std::cout << "\n=== Parallel Subproofs ===\n";
+    std::cout << "[CD] "; runTest("P->Q,Q->R,R->S", "P->S", "P->S    :CD", true);
+    std::cout << "[CD] "; runTest("Q->R", "P->(Q->R)", "P->(Q->R)    :CD", true);
+
+    std::cout << "\n=== Predicate Logic ===\n";
+    std::cout << "[UI] "; runTest("∀x(F(x)->G(x)),F(a)", "G(a)", "G(a)    :MP");
+    std::cout << "[EG] "; runTest("F(a)", "∃xF(x)", "∃xF(x)    :EG 2");
+    std::cout << "[UD] "; runTest("∀x(F(x)->G(x)),∀xF(x)", "∀xG(x)", "∀xG(x)    :UD");
+    std::cout << "[ED] "; runTest("∃xF(x),∀x(F(x)->G(x))", "∃xG(x)", "∃xG(x)    :EG");
+    std::cout << "[UI] "; runTest("∀x∀y(R(x,y)->R(y,x)),R(a,f(b))", "R(f(b),a)", "R(f(b),a)    :MP");
+
     std::cout << "\n=== Derived Rules ===\n";
     std::cout << "[D-HS] "; runTest("P->Q,Q->R", "P->R", "P->R    :D-HS 2 3");
     std::cout << "[D-MCC] "; runTest("Q", "X->Q", "X->Q    :D-MCC 2");
@@ -63,9 +165,724 @@ int main() {
     std::cout << "[D-SDMT] "; runTest("(PvQ)<->~(~P^~Q)", "(PvQ)<->~(~P^~Q)", "(PvQ)<->~(~P^~Q)    :D-SDMT 2");
     std::cout << "[D-NC] "; runTest("~(P->Q)<->(P^~Q)", "~(P->Q)<->(P^~Q)", "~(P->Q)<->(P^~Q)    :D-NC 2");
 
+    {
+        // One application yields every conclusion, the same on every call
+        FormulaStore fs;
+        std::unordered_map<std::string, Rule> byName;
+        for (auto& rule : getAllRules()) byName.emplace(rule.name, rule);
+        auto apply = [&](const char* name, std::vector<FormulaId> premises) {
+            Conclusions out;
+            byName.at(name).apply(fs, premises, out);
+            return out;
+        };
+        FormulaId p = *fs.parse("P"), q = *fs.parse("Q");
+        assert((apply("S", {*fs.parse("P^Q")}) == Conclusions{p, q}));
+        assert((apply("S", {*fs.parse("P^Q")}) == Conclusions{p, q}));
+        assert((apply("D-HS", {*fs.parse("P->Q"), *fs.parse("Q->P")}) == Conclusions{*fs.parse("Q->Q"), *fs.parse("P->P")}));
+        std::cout << GREEN << "Passed: rules emit all conclusions" << RESET << "\n";
+    }
+
+    std::cout << "\n=== Replacement of Equivalents ===\n";
+    std::cout << "[DNE] "; runTest("~(Pv~~Q)", "~P^~Q", "~P^~Q    :DNE 3");
+    std::cout << "[D-DMO] "; runTest("~(PvQ)->R,~P^~Q", "R", "~(PvQ)    :D-DMO 3");
+    std::cout << "[D-DMT] "; runTest("S->~(P^Q)", "S->(~Pv~Q)", "S->(~Pv~Q)    :D-DMT 2");
+    {
+        FormulaStore fs;
+        EGraph graph;
+        auto f = [&](const char* text) { return *fs.parse(text); };
+        assert(graph.equivalent(fs, f("~(Pv~~Q)"), f("~P^~Q")));
+        assert(graph.equivalent(fs, f("~(A->(BvC))"), f("A^~B^~C")));
+        assert(!graph.equivalent(fs, f("P->Q"), f("~PvQ")));
+
+        // A full graph stops growing; rebuilt, it reasons again
+        for (int i = 0; !graph.full(); ++i) graph.add(fs, f(("~(A" + std::to_string(i) + "vB)").c_str()));
+        FormulaId late = f("~(CvD)");
+        bool stale = graph.equivalent(fs, late, f("~C^~D"));
+        assert(!stale);
+        graph.clear();
+        bool rebuilt = graph.equivalent(fs, late, f("~C^~D"));
+        assert(rebuilt && graph.nodeCount() < 20);
+        std::cout << GREEN << "Passed: e-graph equivalence classes" << RESET << "\n";
+    }
+
+    std::cout << "\n=== Horn Clauses ===\n";
+    std::cout << "[MP] "; runTest("A^B^C,C->D", "D", "D    :MP 3 5");
+    std::cout << "[ADJ] "; runTest("A,B,(A^B)->(C^D^E),E->F,D->G", "F^G", "F^G    :ADJ 12 13");
+    {
+        // A long chain is decided by propagation, one MP line per link
+        std::string premises = "A0";
+        for (int i = 0; i < 2000; ++i) premises += ",A" + std::to_string(i) + "->A" + std::to_string(i + 1);
+        ProofSolver solver;
+        solver.enableDiagnostics(false);
+        solver.setInput(premises, "A2000");
+        solver.solve();
+        assert(solver.wasConclusionDerived() && solver.getProofLines().size() == 1 + 2001 + 2000);
+
+        ProofSolver unreachable;
+        unreachable.enableDiagnostics(false);
+        unreachable.setInput(premises + ",B->C", "C");
+        unreachable.solve();
+        assert(!unreachable.wasConclusionDerived() && unreachable.getProofLines().size() == 1 + 2002);
+        std::cout << GREEN << "Passed: Horn problems are decided without search" << RESET << "\n";
+    }
+
+    std::cout << "\n=== Rule Signatures ===\n";
+    {
+        // Whenever a rule fires, its premises and conclusions fit its signature
+        FormulaStore fs;
+        std::vector<FormulaId> lines;
+        for (const char* text : {"P", "~Q", "~~P", "P->Q", "~Q->~P", "~P->P", "P^Q", "PvQ", "P<->Q",
+                                 "Q->P", "P->R", "Q->R", "~(PvQ)<->(~P^~Q)", "~(P->Q)<->(P^~Q)"})
+            lines.push_back(*fs.parse(text));
+
+        Conclusions out;
+        std::vector<FormulaId> premises;
+        size_t n = lines.size();
+        for (const Rule& rule : getAllRules()) {
+            size_t tuples = 1;
+            for (int k = 0; k < rule.numPremises; ++k) tuples *= n;
+            for (size_t t = 0; t < tuples; ++t) {
+                premises.clear();
+                for (size_t rest = t, k = 0; k < static_cast<size_t>(rule.numPremises); ++k, rest /= n)
+                    premises.push_back(lines[rest % n]);
+                out.clear();
+                rule.apply(fs, premises, out);
+                if (out.empty()) continue;
+
+                ShapeMask heads = 0;
+                for (FormulaId p : premises) heads |= shapeBit(fs.get(p).op);
+                assert((heads & rule.needs) == rule.needs && (heads & ~rule.accepts) == 0);
+                for (FormulaId c : out) assert(rule.yields & shapeBit(fs.get(c).op));
+            }
+        }
+        std::cout << GREEN << "Passed: rule signatures cover every firing" << RESET << "\n";
+    }
+    {
+        // No line is a biconditional, so BC and the equivalence recognizers never run
+        ProofSolver solver;
+        solver.enableDiagnostics(false);
+        solver.setInput("P->Q,P->R", "P->(Q^R)");
+        solver.solve();
+        assert(solver.wasConclusionDerived() && solver.solveStats().rulesSkipped > 0);
+        std::cout << GREEN << "Passed: rules without matching lines are skipped" << RESET << "\n";
+    }
+
+    std::cout << "\n=== Implication Index ===\n";
+    {
+        // Hits inside and across the 16- and 4-wide blocks and in the scalar tail
+        FormulaStore fs;
+        ImplicationIndex index;
+        FormulaId a = *fs.parse("A");
+        std::vector<size_t> expected = {0, 3, 15, 16, 31, 47, 50, 52};
+        for (int i = 0; i < 53; ++i) {
+            bool hit = std::find(expected.begin(), expected.end(), static_cast<size_t>(i)) != expected.end();
+            FormulaId other = *fs.parse("B" + std::to_string(i));
+            index.add(fs, hit ? fs.implies(a, other) : fs.implies(other, a));
+        }
+        std::vector<size_t> antecedents, consequents;
+        index.withAntecedent(a, antecedents);
+        index.withConsequent(a, consequents);
+        assert(antecedents == expected && consequents.size() == 53 - expected.size());
+        std::cout << GREEN << "Passed: implication sweeps find every match" << RESET << "\n";
+
+        // Lines keep their positions; truncating drops the implications past the cut
+        index.add(fs, a);
+        std::vector<size_t> facts;
+        index.withFact(a, index.lines(), facts);
+        assert(facts == std::vector<size_t>{53});
+        index.truncate(16);
+        assert(index.lines() == 16 && index.size() == 16 && index.firstAt(15) == 15);
+        std::cout << GREEN << "Passed: the index follows the accessible lines" << RESET << "\n";
+    }
+    std::cout << "[MT] "; runTest("P->(Q->R),P,~R", "~Q", "~Q    :MT 4 7");
+
+    std::cout << "\n=== Entailment Oracle ===\n";
+    {
+        FormulaStore fs;
+        auto f = [&](const char* text) { return *fs.parse(text); };
+        EntailmentOracle oracle;
+        oracle.reset(3);
+        assert(oracle.entails(fs, {f("P->Q"), f("Q->R")}, f("P->R")) == true);
+        assert(oracle.entails(fs, {f("P->Q"), f("Q->R")}, f("R->P")) == false);
+        assert(oracle.entails(fs, {f("PvQ"), f("~P")}, f("Q")) == true);
+        assert(oracle.entails(fs, {f("P<->Q"), f("~Q")}, f("~P^~(P^Q)")) == true);
+        assert(oracle.entails(fs, {f("P"), f("~P")}, f("S")) == true);
+        assert(oracle.entails(fs, {}, f("Pv~P")) == true);
+        assert(!oracle.entails(fs, {f("∀x F(x)")}, f("F(a)")));
+
+        // Six sentence letters fill a 64-row table; a seventh gets no variable
+        oracle.reset(6);
+        assert(oracle.entails(fs, {f("A^B^C^D^E^G")}, f("A")) == true);
+        assert(!oracle.entails(fs, {f("H")}, f("H")));
+
+        // Past one word: 2^10 rows
+        oracle.reset(10);
+        assert(oracle.entails(fs, {f("A->B"), f("B->C"), f("C->D"), f("D->E"), f("E->G"), f("G->H"), f("H->I"),
+                                   f("I->J"), f("J->K")}, f("A->K")) == true);
+        assert(oracle.entails(fs, {f("A->B"), f("B->C"), f("C->D"), f("D->E"), f("E->G"), f("G->H"), f("H->I"),
+                                   f("I->J"), f("J->K")}, f("K->A")) == false);
+        std::cout << GREEN << "Passed: truth-table entailment" << RESET << "\n";
+    }
+    {
+        // Standing premises across scopes: truncating back into a scope
+        // keeps what its enclosing scopes conjoined
+        FormulaStore fs;
+        auto f = [&](const char* text) { return *fs.parse(text); };
+        EntailmentOracle oracle;
+        oracle.reset(4);
+        oracle.addPremise(f("P->Q"));
+        oracle.addPremise(f("Q->R"));
+        assert(oracle.entailed(fs, f("P->R")) == true && oracle.entailed(fs, f("P")) == false);
+
+        oracle.openScope();
+        oracle.addPremise(f("P"));
+        oracle.addPremise(f("Q"));
+        assert(oracle.entailed(fs, f("R")) == true);
+        oracle.truncatePremises(3);
+        assert(oracle.entailed(fs, f("R")) == true && oracle.entailed(fs, f("S")) == false);
+        oracle.truncatePremises(2);
+        assert(oracle.entailed(fs, f("R")) == false && oracle.entailed(fs, f("P->R")) == true);
+
+        oracle.openScope();
+        oracle.addPremise(f("~R"));
+        assert(oracle.entailed(fs, f("~P")) == true);
+        oracle.addPremise(f("∀x F(x)"));
+        assert(!oracle.entailed(fs, f("~P")));
+        oracle.truncatePremises(3);
+        oracle.reset(4);
+        assert(oracle.entailed(fs, f("~P")) == true && oracle.premiseCount() == 3);
+        std::cout << GREEN << "Passed: standing premises follow the scopes" << RESET << "\n";
+    }
+    {
+        // A non-theorem is ruled out before any subproof is opened
+        ProofSolver solver;
+        solver.enableDiagnostics(false);
+        solver.setInput("P->Q,Q->R", "R->P");
+        solver.solve();
+        assert(!solver.wasConclusionDerived() && solver.getProofLines().size() == 3);
+        assert(solver.solveStats().targetsPruned == 1 && solver.solveStats().combinations == 0);
+        std::cout << GREEN << "Passed: conclusions that do not follow are pruned" << RESET << "\n";
+    }
+
+    std::cout << "\n=== Search Budgets ===\n";
+    {
+        // ADJ, DNI and ADD fire on every tuple; the line cap holds within a
+        // round instead of being checked after it
+        ProofSolver solver;
+        solver.enableDiagnostics(false);
+        size_t longest = 0;
+        solver.setLineObserver([&](const Statement& line) {
+            longest = std::max(longest, static_cast<size_t>(line.lineNumber));
+        });
+        solver.setInput("~(RvQ)", "~R");
+        solver.solve();
+        assert(longest <= 5001 && solver.solveStats().combinations < 1000000);
+        std::cout << GREEN << "Passed: rounds stop at the line cap" << RESET << "\n";
+    }
+    {
+        // Rounds cut short by the growth budget resume after the cut rule,
+        // so MTP still runs behind the rules that fire on every tuple
+        ProofSolver solver;
+        solver.enableDiagnostics(false);
+        solver.setInput("PvQvRvS,~P,~S", "QvR");
+        solver.solve();
+        assert(solver.wasConclusionDerived());
+        std::cout << GREEN << "Passed: cut rounds do not starve later rules" << RESET << "\n";
+    }
+
     std::cout << "\n=== Composite Proof ===\n";
     std::cout << "[D-PBC] "; runTest("P->R,PvQ,Q->R", "R", "R    :D-PBC 2 3 4");
 
+    std::cout << "\n=== Proof Checker ===\n";
+    runCheck("valid CD", "1. Show: P->R\n2.  P->Q    :PR\n3.  Q->R    :PR\n   4.  Show: P->R\n"
+                         "   5.  P    :AS\n   6.  Q    :MP 2 5\n   7.  R    :MP 3 6\n8.  P->R    :CD 7\n", true);
+    runCheck("wrong rule", "1. Show: Q\n2.  P->Q    :PR\n3.  Q    :MT 2\n", false);
+    runCheck("cites closed subproof", "1. Show: Q\n2.  P->Q    :PR\n   3.  Show: P->Q\n   4.  P    :AS\n"
+                                      "   5.  Q    :MP 2 4\n6.  P->Q    :CD 5\n7.  Q    :MP 2 4\n", false);
+    runCheck("goal left open", "1. Show: R\n2.  P    :PR\n", false);
+    runCheck("UD on an ED constant", "1. Show: ∀xF(x)\n2.  ∃xF(x)    :PR\n   3.  Show: ∀xF(x)\n"
+                                     "   4.  F(a)    :ED 2\n5.  ∀xF(x)    :UD 4\n", false);
+    runCheck("replacement inside a conditional", "1. Show: S->(~Pv~Q)\n2.  S->~(P^Q)    :PR\n"
+                                                 "3.  S->(~Pv~Q)    :D-DMT 2\n", true);
+    runCheck("replacement by the wrong law", "1. Show: S->(~P^~Q)\n2.  S->~(P^Q)    :PR\n"
+                                             "3.  S->(~P^~Q)    :D-DMT 2\n", false);
+    runCheck("DNI removing a negation", "1. Show: P^Q\n2.  ~~P^Q    :PR\n3.  P^Q    :DNI 2\n", false);
+    runCheck("ED reusing a constant", "1. Show: F(a)\n2.  ∃xF(x)    :PR\n3.  F(a)    :ED 2\n", false);
+    runCheck("S through two conjunctions", "1. Show: P\n2.  (P^Q)^R    :PR\n3.  P    :S 2\n", false);
+    runCheck("MTP on a regrouped disjunction", "1. Show: PvR\n2.  Pv(QvR)    :PR\n3.  ~Q    :PR\n"
+                                              "4.  PvR    :MTP 2 3\n", false);
+
+    std::cout << "\n=== Subproof Scopes ===\n";
+    {
+        ScopedFormulaSet set;
+        set.insert(1, 0);
+        set.pushScope();
+        assert(!set.insert(1, 5) && set.insert(2, 6));
+        set.pushScope();
+        set.insert(3, 7);
+        set.popScope();
+        assert(set.contains(2) && !set.contains(3));
+        set.popScope();
+        assert(set.contains(1) && !set.contains(2) && *set.line(1) == 0);
+        std::cout << GREEN << "Passed: scope push/pop" << RESET << "\n";
+    }
+    {
+        ScopeTree tree;
+        tree.add(1, Connective::Atom);
+        tree.open(2);
+        tree.add(3, Connective::Atom);
+        tree.close();
+        tree.add(5, Connective::Atom);
+        assert((tree.accessible() == std::vector<int>{1, 5}) && !tree.isAccessible(3));
+        std::cout << GREEN << "Passed: closed subproof lines leave the view" << RESET << "\n";
+    }
+    {
+        ScopeTree tree;
+        tree.add(0, Connective::Implies);
+        auto mark = tree.mark();
+        tree.open(1);
+        tree.add(2, Connective::Iff);
+        assert(tree.covers(shapeBit(Connective::Iff) | shapeBit(Connective::Implies)));
+        tree.close();
+        assert(tree.heads() == shapeBit(Connective::Implies));
+        tree.add(3, Connective::Or);
+        tree.rollback(mark);
+        assert(!tree.covers(shapeBit(Connective::Or)) && tree.covers(shapeBit(Connective::Implies)));
+        std::cout << GREEN << "Passed: line heads follow the accessible lines" << RESET << "\n";
+    }
+    {
+        ScopedFormulaSet set;
+        ScopeTree tree;
+        set.insert(1, 0);
+        tree.add(0, Connective::Atom);
+        auto setMark = set.mark();
+        auto treeMark = tree.mark();
+        set.pushScope();
+        tree.open(1);
+        set.insert(2, 2);
+        tree.add(2, Connective::Atom);
+        set.rollback(setMark);
+        tree.rollback(treeMark);
+        assert(set.contains(1) && !set.contains(2) && tree.depth() == 0);
+        assert((tree.accessible() == std::vector<int>{0}) && !tree.isAccessible(2));
+        std::cout << GREEN << "Passed: abandoned scopes roll back" << RESET << "\n";
+    }
+    {
+        // Stop the search as soon as a subproof is entered; the attempt it
+        // abandons leaves nothing behind
+        ProofSolver solver;
+        solver.enableDiagnostics(false);
+        solver.setInput("P->Q,Q->R,R->S", "P->S");
+        std::atomic<bool> stop{false};
+        solver.setStopFlag(&stop);
+        solver.setLineObserver([&](const Statement& line) { stop = stop || line.justification == "AS"; });
+        solver.solve();
+
+        auto lines = solver.getProofLines();
+        assert(!solver.wasConclusionDerived() && lines.size() == 4);
+        for (const auto& line : lines) assert(line.indentLevel == 0 && line.justification != "AS");
+        std::cout << GREEN << "Passed: failed subproof attempts are rolled back" << RESET << "\n";
+    }
+
+    std::cout << "\n=== Streaming Solve ===\n";
+    {
+        ProofSolver solver;
+        solver.setInput("P->Q,Q->R,R->S", "P->S");
+        std::vector<Statement> lines;
+        {
+            SolveStream stream(solver);
+            size_t applied = stream.resume(2, lines);
+            assert(applied == 2 && lines[0].expression == "Show: P->S");
+            stream.resume(SIZE_MAX, lines);
+            assert(stream.finished());
+        }
+        assert(lines.back().expression == "P->S" && lines.back().justification == "CD");
+        assert(solver.checkProof());
+        std::cout << GREEN << "Passed: lines streamed across pauses" << RESET << "\n";
+    }
+    {
+        // Rolled-back attempts and the final binary rewrite are retracted,
+        // so the streamed lines end up as the proof
+        ProofSolver solver;
+        solver.enableDiagnostics(false);
+        solver.setInput("PvQvR,~P,~R", "Q");
+        SolveStream stream(solver);
+        std::vector<Statement> lines;
+        size_t retractions = 0;
+        while (auto event = stream.next()) {
+            if (event->kind == StreamEvent::Kind::Line) {
+                assert(event->line.lineNumber == static_cast<int>(lines.size()) + 1);
+                lines.push_back(event->line);
+            } else {
+                assert(event->from >= 1 && event->from <= static_cast<int>(lines.size()));
+                lines.resize(static_cast<size_t>(event->from - 1));
+                retractions++;
+            }
+        }
+        auto proof = solver.getProofLines();
+        assert(solver.wasConclusionDerived() && retractions > 0 && lines.size() == proof.size());
+        for (size_t i = 0; i < proof.size(); ++i)
+            assert(lines[i].expression == proof[i].expression && lines[i].references == proof[i].references);
+        std::cout << GREEN << "Passed: withdrawn lines are retracted (" << retractions << " times)" << RESET << "\n";
+    }
+    {
+        ProofSolver solver;
+        solver.setInput("~(PvQ)->R,~R", "PvQ");
+        SolveStream stream(solver);
+        std::vector<Statement> lines;
+        size_t applied = stream.resume(3, lines);
+        stream.drop();
+        auto after = stream.next();
+        assert(applied == 3 && stream.finished() && !after);
+        std::cout << GREEN << "Passed: search dropped mid-way" << RESET << "\n";
+    }
+
+    std::cout << "\n=== Portfolio ===\n";
+    {
+        ProofSolver solver;
+        solver.enableDiagnostics(false);
+        solver.enablePortfolio(true);
+        solver.setInput("~(PvQ)->R,~R", "PvQ");
+        std::vector<Statement> reported;
+        solver.setLineObserver([&](const Statement& line) { reported.push_back(line); });
+        solver.solve();
+        assert(solver.wasConclusionDerived() && solver.checkProof());
+        assert(!solver.winningStrategy().empty() && reported.size() == solver.getProofLines().size());
+        std::cout << GREEN << "Passed: first configuration to finish wins (" << solver.winningStrategy() << ")"
+                  << RESET << "\n";
+    }
+    {
+        // Every configuration runs, however few the cores, and none wins
+        ProofSolver solver;
+        solver.enableDiagnostics(false);
+        solver.enablePortfolio(true);
+        solver.setInput("P->Q,R", "Q");
+        solver.solve();
+        assert(!solver.wasConclusionDerived() && solver.winningStrategy().empty());
+        std::cout << GREEN << "Passed: configurations queue until all have failed" << RESET << "\n";
+    }
+
+    std::cout << "\n=== Lemma Library ===\n";
+    bool compiled = LemmaLibrary::compile(LEMMA_SOURCE, "standard.lemlib");
+    auto lemmas = LemmaLibrary::open("standard.lemlib");
+    assert(compiled && lemmas && lemmas->size() == 4 && lemmas->find("L-CPO"));
+    std::cout << "[L-HS3] "; runTest("P->Q,Q->R,R->S", "P->S", "P->S    :L-HS3 2 3 4", false, lemmas);
+    std::cout << "[L-ABS] "; runTest("A->B,A->~B", "~A", "~A    :L-ABS 2 3", false, lemmas);
+    std::cout << "[L-EXP] "; runTest("(B^A)->C", "A->(B->C)", "A->(B->C)    :L-EXP 2", false, lemmas);
+    std::cout << "[L-EXP grouped] ";
+    runTest("(B^A^D)->C", "A->((B^D)->C)", "A->((B^D)->C)    :L-EXP 2", false, lemmas);
+    runCheck("lemma citation", "1. Show: ~Q->~P\n2.  P->Q    :PR\n3.  ~Q->~P    :L-CPO 2\n", true, lemmas.get());
+    runCheck("lemma over grouped operands",
+             "1. Show: (A^B)->(D->C)\n2.  (A^B^D)->C    :PR\n3.  (A^B)->(D->C)    :L-EXP 2\n", true, lemmas.get());
+    runCheck("lemma misapplied", "1. Show: ~P->~Q\n2.  P->Q    :PR\n3.  ~P->~Q    :L-CPO 2\n", false, lemmas.get());
+
+    std::cout << "\n=== Knowledge Base ===\n";
+    {
+        std::ofstream source("facts.kb.txt");
+        source << "# chain needed by the query, buried among unrelated facts\n";
+        for (int i = 0; i < 500; ++i) source << "X" << i << "->Y" << i << "\n";
+        source << "A->B\nB->C\n\nA->B\n";
+        for (int i = 0; i < 500; ++i) source << "F" << i << "(a)^G" << i << "(b)\n";
+        source.close();
+
+        bool built = KnowledgeBase::compile("facts.kb.txt", "facts.kb");
+        auto kb = KnowledgeBase::open("facts.kb");
+        assert(built && kb && kb->size() == 1002);
+
+        ProofSolver solver;
+        solver.enableDiagnostics(false);
+        solver.useKnowledgeBase(kb);
+        solver.setInput("A", "C");
+        solver.solve();
+        size_t imported = 0;
+        for (const auto& line : solver.getProofLines()) imported += line.justification == "PR";
+        assert(solver.wasConclusionDerived() && solver.checkProof() && imported == 3);
+        std::cout << GREEN << "Passed: only premises sharing symbols are imported" << RESET << "\n";
+
+        // A's closure is wide; the one premise the proof needs comes last
+        std::ofstream wide("wide.kb.txt");
+        for (int i = 0; i < 100; ++i) wide << "A->Z" << i << "\n";
+        wide << "A->M\nM->B\n";
+        wide.close();
+        bool wideBuilt = KnowledgeBase::compile("wide.kb.txt", "wide.kb");
+        auto wideKb = KnowledgeBase::open("wide.kb");
+        assert(wideBuilt && wideKb);
+
+        ProofSolver full;
+        full.enableDiagnostics(false);
+        full.useKnowledgeBase(wideKb);
+        full.setInput("A", "B");
+        full.solve();
+        size_t cited = 0;
+        for (const auto& line : full.getProofLines()) cited += line.justification == "PR";
+        assert(full.wasConclusionDerived() && full.checkProof() && cited == 3);
+
+        ProofSolver capped;
+        capped.enableDiagnostics(false);
+        capped.useKnowledgeBase(wideKb, 1);
+        capped.setInput("A", "B");
+        capped.solve();
+        assert(!capped.wasConclusionDerived() && capped.solveStats().targetsPruned == 0);
+        std::cout << GREEN << "Passed: the full closure is imported and only cited premises kept" << RESET << "\n";
+
+        // A closure past the line cap: dead-end premises rank last and the
+        // import stays well under the cap, leaving the search its budget
+        std::ofstream huge("huge.kb.txt");
+        for (int i = 0; i < 6000; ++i) huge << "A->Z" << i << "\n";
+        huge << "A->(BvC)\nB->D\nC->D\n";
+        huge.close();
+        bool hugeBuilt = KnowledgeBase::compile("huge.kb.txt", "huge.kb");
+        auto hugeKb = KnowledgeBase::open("huge.kb");
+        assert(hugeBuilt && hugeKb && hugeKb->size() == 6003);
+
+        ProofSolver large;
+        large.enableDiagnostics(false);
+        large.useKnowledgeBase(hugeKb);
+        large.setInput("A", "D");
+        large.solve();
+        assert(large.wasConclusionDerived() && large.checkProof() && !large.solveStats().lineCapped);
+        std::cout << GREEN << "Passed: a knowledge base past the line cap imports its relevant premises" << RESET
+                  << "\n";
+
+        std::ofstream bad("bad.kb.txt");
+        bad << "P->Q\nP->(Q\n";
+        bad.close();
+        bool badBuilt = KnowledgeBase::compile("bad.kb.txt", "bad.kb");
+        auto notCompiled = KnowledgeBase::open("facts.kb.txt");
+        assert(!badBuilt && !notCompiled);
+        std::cout << GREEN << "Passed: malformed sources and files are rejected" << RESET << "\n";
+
+        // Records that pass open()'s bounds checks but not their kind's
+        // shape: the header holds uint32 fields from byte 8, and a formula
+        // record is op, name, nameLength, operands, operandCount, terms, termCount
+        std::ofstream pair("pair.kb.txt");
+        pair << "P->Q\n";
+        pair.close();
+        bool pairBuilt = KnowledgeBase::compile("pair.kb.txt", "pair.kb");
+        assert(pairBuilt);
+        auto corrupt = [](auto patch) {
+            std::ifstream in("pair.kb", std::ios::binary);
+            std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+            auto word = [&](size_t at) -> uint32_t& { return *reinterpret_cast<uint32_t*>(bytes.data() + at); };
+            uint32_t formulas = word(12), formulasAt = word(16), poolAt = word(48);
+            for (uint32_t id = 0; id < formulas; ++id)
+                if (word(formulasAt + id * 28) == static_cast<uint32_t>(Connective::Implies))
+                    patch(id, [&](int field) -> uint32_t& { return word(formulasAt + id * 28 + field * 4); },
+                          [&](uint32_t index) -> uint32_t& { return word(poolAt + index * 4); });
+            std::ofstream out("corrupt.kb", std::ios::binary);
+            out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+            out.close();
+            return KnowledgeBase::open("corrupt.kb");
+        };
+        auto noOperands = corrupt([](uint32_t, auto field, auto) { field(4) = 0; });
+        auto cyclic = corrupt([](uint32_t id, auto field, auto pool) { pool(field(3)) = id; });
+        auto nowhere = corrupt([](uint32_t, auto field, auto) { field(3) = 0xFFFFFFF0u; });
+        FormulaStore scratch;
+        assert(noOperands && cyclic && nowhere);
+        assert(noOperands->import(0, scratch) == NoFormula && cyclic->import(0, scratch) == NoFormula &&
+               nowhere->import(0, scratch) == NoFormula);
+
+        ProofSolver guarded;
+        guarded.enableDiagnostics(false);
+        guarded.useKnowledgeBase(cyclic);
+        guarded.setInput("P", "Q");
+        guarded.solve();
+        assert(!guarded.wasConclusionDerived());
+        std::cout << GREEN << "Passed: corrupt records import as nothing" << RESET << "\n";
+    }
+
+    std::cout << "\n=== Cost Model ===\n";
+    {
+        FormulaStore store;
+        auto features = [&](std::vector<std::string> premises, const std::string& goal) {
+            std::vector<FormulaId> ids;
+            for (const auto& p : premises) ids.push_back(*store.parse(p));
+            return extractFeatures(store, ids, *store.parse(goal));
+        };
+        ProblemFeatures chain = features({"P->Q", "Q->R", "R->S"}, "P->S");
+        ProblemFeatures cases = features({"P->R", "PvQ", "Q->R"}, "R");
+        ProblemFeatures mp = features({"P", "P->Q"}, "Q");
+        assert(chain.premises == 3 && chain.atoms == 4 && chain.implications == 4);
+        assert(chain.implicationDepth == 1 && chain.conditionalGoal && !chain.threePremiseRules);
+        assert(cases.threePremiseRules && cases.junctions == 1 && !cases.conditionalGoal);
+        assert(features({"P->(Q->R)"}, "Q->(P->R)").implicationDepth == 2);
+        std::cout << GREEN << "Passed: static features" << RESET << "\n";
+
+        CostModel model;
+        assert(model.predictMs(chain) > model.predictMs(mp));
+        double before = model.predictMs(mp);
+        for (int i = 0; i < 8; ++i) model.observe(mp, 500.0);
+        assert(model.samples() == 8 && model.predictMs(mp) > 4 * before);
+
+        CostModel reloaded;
+        bool saved = model.save("costs.model");
+        bool loaded = reloaded.load("costs.model");
+        assert(saved && loaded && reloaded.samples() == 8);
+        assert(std::abs(reloaded.predictMs(mp) - model.predictMs(mp)) < 1e-6);
+        std::cout << GREEN << "Passed: observed solves recalibrate the model" << RESET << "\n";
+
+        // chain has at least as much of every feature as mp, so no samples
+        // can make it look cheaper
+        CostModel skewed;
+        for (int i = 0; i < 8; ++i) {
+            skewed.observe(mp, 500.0);
+            skewed.observe(chain, 0.0);
+        }
+        assert(skewed.predictMs(chain) >= skewed.predictMs(mp));
+        std::cout << GREEN << "Passed: weights stay non-negative" << RESET << "\n";
+
+        CostModel fresh;
+        BatchOptions options;
+        options.rejectOverMs = (fresh.predictMs(chain) + fresh.predictMs(cases)) / 2;
+        BatchRunner batch(fresh, options);
+        std::istringstream jobs("# queued problems\nP->Q,Q->R,R->S |- P->S\nP->R,PvQ,Q->R ⊢ R\nP->(Q |- Q\n\nP,P->Q |- Q\n");
+        size_t unparsedJobs = batch.addAll(jobs);
+        assert(unparsedJobs == 1);
+
+        std::vector<size_t> rejected;
+        std::vector<BatchJob> order = batch.schedule(&rejected);
+        assert(rejected == std::vector<size_t>{1});
+        assert(order.size() == 2 && order[0].index == 5 && order[1].index == 2);
+        assert(order[0].budgetMs >= options.minBudgetMs && order[1].budgetMs <= options.maxBudgetMs);
+
+        std::vector<BatchResult> results = batch.run(false);
+        assert(results.size() == 3 && results[0].outcome == JobOutcome::Rejected);
+        assert(results[1].outcome == JobOutcome::Proved && results[2].outcome == JobOutcome::Proved);
+        assert(fresh.samples() == 2);
+        std::cout << GREEN << "Passed: batch runs shortest-first and rejects predicted blow-ups" << RESET << "\n";
+
+        // C follows from A only through the knowledge base's premises
+        BatchRunner withKb(fresh);
+        withKb.useKnowledgeBase(KnowledgeBase::open("facts.kb"));
+        std::istringstream kbJobs("A |- C\n");
+        size_t unparsed = withKb.addAll(kbJobs);
+        std::vector<BatchResult> kbResults = withKb.run(false);
+        assert(unparsed == 0 && kbResults.size() == 1 && kbResults[0].outcome == JobOutcome::Proved);
+        std::cout << GREEN << "Passed: batch jobs import from the knowledge base" << RESET << "\n";
+    }
+
+    std::cout << "\n=== Problem Corpus ===\n";
+    {
+        FormulaStore store;
+        assert(store.parse("P => (Q | R)") == store.parse("P->(QvR)"));
+        assert(store.parse("not P and Q <=> P \\/ Q") == store.parse("~P^Q<->PvQ"));
+        assert(store.parse("P & (Q /\\ R)") == store.parse("P^Q^R"));
+        assert(store.is(*store.parse("oracle"), Connective::Atom) && !store.parse("P or"));
+        std::cout << GREEN << "Passed: connective spellings parse without normalizing" << RESET << "\n";
+
+        std::ofstream source("corpus.txt");
+        source << "# text and JSONL records\n"
+               << "P, P->Q |- Q\n"
+               << "\n"
+               << "  F(a,b), G(a) ; ∃xG(x)\n"
+               << "{\"id\": 3, \"premises\": [\"A\", \"A->B\"], \"meta\": {\"k\": [1, 2]}, \"conclusion\": \"B\"}\n"
+               << "{\"premises\": \"\\u2200x(F(x)->G(x)), F(c)\", \"conclusion\": \"G(c)\"}\n"
+               << "no separator here\n"
+               << "|- P->(Q\n"
+               << "P|Q, ~P ⊢ Q";
+        source.close();
+
+        ProblemCorpus corpus("corpus.txt");
+        std::vector<size_t> lines;
+        std::vector<std::string> seen;
+        size_t malformed = corpus.forEach([&](const CorpusRecord& record) {
+            lines.push_back(record.line);
+            std::string text;
+            for (auto p : record.premises) text += std::string(p) + ",";
+            seen.push_back(text + "|" + std::string(record.conclusion));
+        });
+        assert(corpus.valid() && malformed == 1 && corpus.lineCount() == 9);
+        assert((lines == std::vector<size_t>{2, 4, 5, 6, 8, 9}));
+        assert(seen[1] == "F(a,b),G(a),|∃xG(x)" && seen[2] == "A,A->B,|B");
+        assert(seen[3] == "∀x(F(x)->G(x)),F(c),|G(c)" && seen[4] == "|P->(Q" && seen[5] == "P|Q,~P,|Q");
+
+        size_t parsed = 0;
+        size_t failed = corpus.parseAll(store, [&](const CorpusRecord&, const std::vector<FormulaId>& premises, FormulaId goal) {
+            assert(!premises.empty() && goal != NoFormula);
+            parsed++;
+        });
+        assert(parsed == 5 && failed == 2 && !ProblemCorpus("missing.txt").valid());
+        std::cout << GREEN << "Passed: text and JSONL records split in place" << RESET << "\n";
+
+        // A file's trailing comment, malformed and blank lines still count,
+        // so a problem added after it is numbered past them
+        std::ofstream("tail.txt") << "P |- P\n# done\nno separator\n\n";
+        CostModel model;
+        BatchRunner batch(model);
+        size_t bad = batch.addFile("tail.txt");
+        bool added = batch.add("Q |- Q");
+        std::vector<size_t> indices;
+        for (const BatchJob& job : batch.schedule()) indices.push_back(job.index);
+        std::sort(indices.begin(), indices.end());
+        assert(bad == 1 && added && (indices == std::vector<size_t>{0, 4}));
+        std::cout << GREEN << "Passed: batch indices continue past a file's last line" << RESET << "\n";
+    }
+
+    std::cout << "\n=== C API ===\n";
+    {
+        // Fixtures of its own, so the block runs without the sections above
+        std::filesystem::path dir = std::filesystem::temp_directory_path() / "syllogism-capi-test";
+        std::filesystem::create_directories(dir);
+        std::string lemmaPath = (dir / "standard.lemlib").string();
+        std::string kbSource = (dir / "facts.kb.txt").string();
+        std::string kbPath = (dir / "facts.kb").string();
+        std::ofstream(kbSource) << "A->B\nB->C\n";
+        bool lemmasBuilt = LemmaLibrary::compile(LEMMA_SOURCE, lemmaPath);
+        bool kbBuilt = KnowledgeBase::compile(kbSource, kbPath);
+        assert(lemmasBuilt && kbBuilt);
+
+        syl_solver* solver = syl_create();
+        assert(syl_api_version() == SYL_API_VERSION);
+        syl_status unparsed = syl_set_input(solver, "P->(Q", "Q");
+        syl_status input = syl_set_input(solver, "P->Q,P", "Q");
+        syl_status solved = syl_solve(solver);
+        assert(unparsed == SYL_INVALID_INPUT && input == SYL_OK && solved == SYL_PROVED);
+
+        size_t last = syl_line_count(solver) - 1;
+        char text[4];
+        int refs[1];
+        syl_line line;
+        syl_status read = syl_get_line(solver, last, &line);
+        assert(read == SYL_OK && line.reference_count == 2);
+        size_t expression = syl_get_expression(solver, last, text, sizeof text);
+        assert(expression == 1 && std::string(text) == "Q");
+        size_t rule = syl_get_rule(solver, last, text, 2);
+        assert(rule == 2 && std::string(text) == "M");
+        size_t cited = syl_get_references(solver, last, refs, 1);
+        assert(cited == 2 && refs[0] == 2);
+        assert(syl_get_proof_text(solver, nullptr, 0) > 0);
+        assert(syl_get_line(solver, last + 1, &line) == SYL_INVALID_ARGUMENT);
+
+        input = syl_set_input(solver, "P->Q,Q->R,R->S", "P->S");
+        syl_status limits = syl_set_limits(solver, 3, 0);
+        solved = syl_solve(solver);
+        assert(input == SYL_OK && limits == SYL_OK && solved == SYL_LIMIT_REACHED);
+
+        syl_status lemmas = syl_set_lemmas(solver, lemmaPath.c_str());
+        limits = syl_set_limits(solver, 0, 10000);
+        solved = syl_solve(solver);
+        assert(lemmas == SYL_OK && limits == SYL_OK && solved == SYL_PROVED);
+
+        input = syl_set_input(solver, "A", "C");
+        syl_status kb = syl_set_knowledge_base(solver, kbPath.c_str());
+        solved = syl_solve(solver);
+        syl_status cleared = syl_set_knowledge_base(solver, nullptr);
+        assert(input == SYL_OK && kb == SYL_OK && solved == SYL_PROVED && cleared == SYL_OK);
+
+        // Portfolio forks report no lines while they search, yet keep to the limit
+        input = syl_set_input(solver, "P->Q,Q->R,R->S", "P->S");
+        lemmas = syl_set_lemmas(solver, nullptr);
+        syl_status portfolio = syl_set_portfolio(solver, 1);
+        limits = syl_set_limits(solver, 3, 0);
+        solved = syl_solve(solver);
+        assert(input == SYL_OK && lemmas == SYL_OK && portfolio == SYL_OK && limits == SYL_OK);
+        assert(solved == SYL_LIMIT_REACHED && syl_line_count(solver) <= 3);
+        syl_destroy(solver);
+
+        std::filesystem::remove_all(dir);
+        std::cout << GREEN << "Passed: solve and read back through the C API" << RESET << "\n";
+    }
+
     std::cout << "\nAll tests passed.\n";
     return 0;
 }
@@ -0,0 +1,332 @@
+// Searches for inputs that make solve() expensive: random and mutated
+// propositional problems are solved under a time limit, any whose cost
+// crosses the threshold is minimized, and the worst cases are appended to a
+// corpus that SyllogismSolver --batch can replay.
+//
+// Only problems whose conclusion follows (by truth table) are kept unless
+// --include-invalid is given: a non-theorem exhausts the search by design.
+//
+//   SolverFuzzer [--seed N] [--iterations N] [--time-limit-ms N]
+//                [--threshold-ms N] [--max-lines N] [--max-combinations N]
+//                [--atoms N] [--include-invalid] [--out FILE]
+#include "EntailmentOracle.h"
+#include "ProofSolver.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Options {
+    unsigned seed = 1;
+    size_t iterations = 200;
+    unsigned timeLimitMs = 2000;    // per solve; reaching it counts as over threshold
+    double thresholdMs = 500.0;
+    size_t maxLines = 2000;
+    size_t maxCombinations = 5000000;
+    int atoms = 4;
+    bool includeInvalid = false;
+    std::string out = "bench/pathological.txt";
+};
+
+struct Problem {
+    std::vector<FormulaId> premises;
+    FormulaId goal = NoFormula;
+};
+
+struct Cost {
+    double ms = 0.0;
+    size_t lines = 0;
+    ProofSolver::SolveStats stats;
+    bool limited = false; // stopped at the time limit
+    bool proved = false;
+};
+
+class Fuzzer {
+public:
+    explicit Fuzzer(const Options& options) : options(options), random(options.seed) { oracle.reset(options.atoms); }
+
+    int run();
+
+private:
+    // Problem text in the corpus format
+    std::string premisesText(const Problem& p) const {
+        std::string text;
+        for (FormulaId f : p.premises) text += (text.empty() ? "" : ", ") + store.render(f);
+        return text;
+    }
+    std::string text(const Problem& p) const { return premisesText(p) + " |- " + store.render(p.goal); }
+
+    bool pathological(const Cost& c) const {
+        return c.limited || c.stats.aborted || c.ms >= options.thresholdMs || c.lines >= options.maxLines ||
+               c.stats.combinations >= options.maxCombinations;
+    }
+
+    // Orders costs for keeping the worst: caps hit first, then work done
+    static bool worse(const Cost& a, const Cost& b) {
+        if (a.limited != b.limited) return a.limited;
+        if (a.stats.aborted != b.stats.aborted) return a.stats.aborted;
+        return a.stats.combinations > b.stats.combinations;
+    }
+
+    bool entailed(const Problem& p) { return oracle.entails(store, p.premises, p.goal).value_or(true); }
+    bool interesting(const Problem& p, Cost& cost) {
+        if (!options.includeInvalid && !entailed(p)) return false;
+        cost = measure(p);
+        return pathological(cost);
+    }
+    Cost measure(const Problem& p);
+    FormulaId randomFormula(int depth);
+    Problem randomProblem();
+    Problem mutate(const Problem& p);
+    Problem minimize(Problem p);
+    void subformulas(FormulaId f, std::vector<FormulaId>& out) const;
+    FormulaId replace(FormulaId f, FormulaId from, FormulaId to);
+    void save(const std::vector<std::pair<Problem, Cost>>& found);
+
+    Options options;
+    std::mt19937 random;
+    FormulaStore store;
+    EntailmentOracle oracle;
+};
+
+// Solves with the search's error output silenced, stopping it at the time limit
+Cost Fuzzer::measure(const Problem& p) {
+    ProofSolver solver;
+    solver.enableDiagnostics(false);
+    solver.setInput(premisesText(p), store.render(p.goal));
+
+    std::atomic<bool> stop{false};
+    solver.setStopFlag(&stop);
+    std::mutex mutex;
+    std::condition_variable done;
+    bool finished = false;
+    std::thread watchdog([&, limit = std::chrono::milliseconds(options.timeLimitMs)] {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (!done.wait_for(lock, limit, [&] { return finished; })) stop = true;
+    });
+
+    std::ostringstream discard;
+    std::streambuf* errors = std::cerr.rdbuf(discard.rdbuf());
+    auto start = std::chrono::steady_clock::now();
+    solver.solve();
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    std::cerr.rdbuf(errors);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        finished = true;
+    }
+    done.notify_one();
+    watchdog.join();
+
+    Cost cost;
+    cost.ms = elapsed.count();
+    cost.lines = solver.getProofLines().size();
+    cost.stats = solver.solveStats();
+    cost.proved = solver.wasConclusionDerived();
+    cost.limited = !cost.proved && stop.load();
+    return cost;
+}
+
+FormulaId Fuzzer::randomFormula(int depth) {
+    std::uniform_int_distribution<int> atom(0, options.atoms - 1);
+    if (depth == 0 || random() % 3 == 0) return store.atom(std::string(1, static_cast<char>('P' + atom(random))));
+
+    switch (random() % 5) {
+        case 0: return store.negate(randomFormula(depth - 1));
+        case 1: return store.conjoin(randomFormula(depth - 1), randomFormula(depth - 1));
+        case 2: return store.disjoin(randomFormula(depth - 1), randomFormula(depth - 1));
+        case 3: return store.implies(randomFormula(depth - 1), randomFormula(depth - 1));
+        default: return store.iff(randomFormula(depth - 1), randomFormula(depth - 1));
+    }
+}
+
+Problem Fuzzer::randomProblem() {
+    Problem p;
+    size_t count = 1 + random() % 4;
+    for (size_t i = 0; i < count; ++i) p.premises.push_back(randomFormula(3));
+    p.goal = randomFormula(2);
+    return p;
+}
+
+void Fuzzer::subformulas(FormulaId f, std::vector<FormulaId>& out) const {
+    out.push_back(f);
+    for (FormulaId operand : store.get(f).operands) subformulas(operand, out);
+}
+
+// f with every occurrence of from replaced by to
+FormulaId Fuzzer::replace(FormulaId f, FormulaId from, FormulaId to) {
+    if (f == from) return to;
+
+    // Copied: building the replacements may grow the store under a reference
+    std::vector<FormulaId> ops = store.get(f).operands;
+    if (ops.empty()) return f;
+    for (FormulaId& operand : ops) operand = replace(operand, from, to);
+    switch (store.get(f).op) {
+        case Connective::Not: return store.negate(ops[0]);
+        case Connective::And: return store.conjoin(ops);
+        case Connective::Or: return store.disjoin(ops);
+        case Connective::Implies: return store.implies(ops[0], ops[1]);
+        case Connective::Iff: return store.iff(ops[0], ops[1]);
+        default: return f;
+    }
+}
+
+Problem Fuzzer::mutate(const Problem& p) {
+    Problem m = p;
+    std::vector<FormulaId>& premises = m.premises;
+    switch (random() % 5) {
+        case 0: // add a premise
+            premises.push_back(randomFormula(3));
+            break;
+        case 1: // drop a premise
+            if (premises.size() > 1) premises.erase(premises.begin() + random() % premises.size());
+            break;
+        case 2: // new conclusion
+            m.goal = randomFormula(2);
+            break;
+        default: { // replace a subformula of a premise or the goal
+            size_t i = random() % (premises.size() + 1);
+            FormulaId& target = i == premises.size() ? m.goal : premises[i];
+            std::vector<FormulaId> subs;
+            subformulas(target, subs);
+            target = replace(target, subs[random() % subs.size()], randomFormula(2));
+            break;
+        }
+    }
+    return m;
+}
+
+// Greedy shrinking while the problem stays pathological: drop premises,
+// then replace subformulas by one of their operands, until nothing helps
+Problem Fuzzer::minimize(Problem p) {
+    bool shrunk = true;
+    while (shrunk) {
+        shrunk = false;
+        for (size_t i = 0; i < p.premises.size() && p.premises.size() > 1;) {
+            Problem candidate = p;
+            candidate.premises.erase(candidate.premises.begin() + i);
+            Cost cost;
+            if (interesting(candidate, cost)) {
+                p = candidate;
+                shrunk = true;
+            } else {
+                ++i;
+            }
+        }
+
+        for (size_t i = 0; i <= p.premises.size() && !shrunk; ++i) {
+            FormulaId& target = i == p.premises.size() ? p.goal : p.premises[i];
+            std::vector<FormulaId> subs;
+            subformulas(target, subs);
+            for (FormulaId sub : subs) {
+                for (FormulaId operand : store.get(sub).operands) {
+                    Problem candidate = p;
+                    FormulaId& slot = i == p.premises.size() ? candidate.goal : candidate.premises[i];
+                    FormulaId before = slot;
+                    slot = replace(slot, sub, operand);
+                    if (slot == before) continue; // e.g. Q^Q with Q for itself: no smaller
+                    Cost cost;
+                    if (interesting(candidate, cost)) {
+                        p = candidate;
+                        shrunk = true;
+                        break;
+                    }
+                }
+                if (shrunk) break;
+            }
+        }
+    }
+    return p;
+}
+
+// Appends the cases not already in the corpus, each after a cost comment
+void Fuzzer::save(const std::vector<std::pair<Problem, Cost>>& found) {
+    std::set<std::string> known;
+    {
+        std::ifstream in(options.out);
+        std::string line;
+        while (std::getline(in, line))
+            if (!line.empty() && line[0] != '#') known.insert(line);
+    }
+
+    std::ofstream out(options.out, std::ios::app);
+    if (!out) {
+        std::cerr << "[FUZZ] Cannot write " << options.out << "\n";
+        return;
+    }
+    size_t added = 0;
+    for (const auto& [problem, cost] : found) {
+        std::string line = text(problem);
+        if (!known.insert(line).second) continue;
+        out << "# seed " << options.seed << ": " << static_cast<long>(cost.ms) << " ms, " << cost.lines << " lines, "
+            << cost.stats.combinations << " combinations, CD depth " << cost.stats.maxCdDepth
+            << (cost.limited ? ", time limit" : "") << (cost.stats.aborted ? ", aborted" : "") << "\n"
+            << line << "\n";
+        added++;
+    }
+    std::cout << "[FUZZ] " << added << " new worst cases written to " << options.out << "\n";
+}
+
+int Fuzzer::run() {
+    std::vector<std::pair<Problem, Cost>> pool; // the most expensive inputs so far, mutation parents
+    std::vector<std::pair<Problem, Cost>> found;
+    std::set<std::string> seen;
+
+    for (size_t i = 0; i < options.iterations; ++i) {
+        Problem p = pool.empty() || random() % 2 ? randomProblem() : mutate(pool[random() % pool.size()].first);
+        if (!seen.insert(text(p)).second) continue;
+        if (!options.includeInvalid && !entailed(p)) continue;
+
+        Cost cost = measure(p);
+        pool.emplace_back(p, cost);
+        std::sort(pool.begin(), pool.end(), [](const auto& a, const auto& b) { return worse(a.second, b.second); });
+        if (pool.size() > 16) pool.pop_back();
+
+        if (!pathological(cost)) continue;
+        Problem small = minimize(p);
+        Cost smallCost = measure(small);
+        std::cout << "[FUZZ] #" << i << " " << text(small) << "    (" << static_cast<long>(smallCost.ms) << " ms, "
+                  << smallCost.stats.combinations << " combinations)" << std::endl;
+        found.emplace_back(small, smallCost);
+    }
+
+    std::sort(found.begin(), found.end(), [](const auto& a, const auto& b) { return worse(a.second, b.second); });
+    save(found);
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool value = i + 1 < argc;
+        if (arg == "--seed" && value) options.seed = static_cast<unsigned>(std::stoul(argv[++i]));
+        else if (arg == "--iterations" && value) options.iterations = std::stoul(argv[++i]);
+        else if (arg == "--time-limit-ms" && value) options.timeLimitMs = static_cast<unsigned>(std::stoul(argv[++i]));
+        else if (arg == "--threshold-ms" && value) options.thresholdMs = std::stod(argv[++i]);
+        else if (arg == "--max-lines" && value) options.maxLines = std::stoul(argv[++i]);
+        else if (arg == "--max-combinations" && value) options.maxCombinations = std::stoul(argv[++i]);
+        else if (arg == "--atoms" && value) options.atoms = std::clamp(std::stoi(argv[++i]), 1, 10);
+        else if (arg == "--include-invalid") options.includeInvalid = true;
+        else if (arg == "--out" && value) options.out = argv[++i];
+        else {
+            std::cerr << "Unknown option " << arg << "\n";
+            return 1;
+        }
+    }
+    return Fuzzer(options).run();
+}